@@ -13,6 +13,7 @@ typedef struct No {
     Segmento* segmento;
     struct No* esq;
     struct No* dir;
+    int altura;    // folhas têm altura 1
 } No;
 
 // ESTRUTURA DA ARVORE
@@ -34,6 +35,7 @@ static No* criar_no(Segmento* s) {
     no->segmento = s;
     no->esq = NULL;
     no->dir = NULL;
+    no->altura = 1;
     
     return no;
 }
@@ -55,19 +57,81 @@ static No* encontrar_minimo(No* no) {
     return no;
 }
 
-// COMPARAR_SEGMENTOS_POR_DISTANCIA
-static int comparar_segmentos_por_distancia(Segmento* s1, Segmento* s2, Ponto* origem) {
-    double dist1 = segmento_distancia_ponto(s1, origem);
-    double dist2 = segmento_distancia_ponto(s2, origem);
+// ALTURA
+static int altura(No* no) {
+    return no ? no->altura : 0;
+}
+
+// ATUALIZAR_ALTURA
+static void atualizar_altura(No* no) {
+    int e = altura(no->esq), d = altura(no->dir);
+    no->altura = 1 + (e > d ? e : d);
+}
+
+// ROTACIONAR_DIREITA
+// o filho esquerdo sobe para o lugar do nó; retorna o nó que ficou no lugar
+static No* rotacionar_direita(No* no) {
+    No* sobe = no->esq;
+    no->esq = sobe->dir;
+    sobe->dir = no;
+    
+    atualizar_altura(no);
+    atualizar_altura(sobe);
+    return sobe;
+}
+
+// ROTACIONAR_ESQUERDA
+static No* rotacionar_esquerda(No* no) {
+    No* sobe = no->dir;
+    no->dir = sobe->esq;
+    sobe->esq = no;
+    
+    atualizar_altura(no);
+    atualizar_altura(sobe);
+    return sobe;
+}
+
+// BALANCEAR
+// se um filho ficou mais de um nível mais alto que o outro, rotaciona (duas vezes
+// quando o neto mais alto está do lado de dentro); retorna o nó que ficou no lugar
+static No* balancear(No* no) {
+    atualizar_altura(no);
+    int diferenca = altura(no->esq) - altura(no->dir);
     
-    if (fabs(dist1 - dist2) < EPSILON) {
-        return segmento_get_id(s1) - segmento_get_id(s2);
+    if (diferenca > 1) {
+        if (altura(no->esq->esq) < altura(no->esq->dir)) no->esq = rotacionar_esquerda(no->esq);
+        return rotacionar_direita(no);
     }
+    if (diferenca < -1) {
+        if (altura(no->dir->dir) < altura(no->dir->esq)) no->dir = rotacionar_direita(no->dir);
+        return rotacionar_esquerda(no);
+    }
+    
+    return no;
+}
+
+// COMPARAR_CHAVES
+// ordem total (distância, id, início): é a mesma usada na inserção, na remoção e na
+// construção em lote, então qualquer árvore montada por elas é consistente. os
+// pedaços de um anteparo dividido têm o mesmo id e se distinguem pelo início
+static int comparar_chaves(double dist1, int id1, Ponto* ini1, double dist2, int id2, Ponto* ini2) {
+    if (dist1 < dist2) return -1;
+    if (dist1 > dist2) return 1;
+    if (id1 != id2) return (id1 > id2) - (id1 < id2);
     
-    return (dist1 < dist2) ? -1 : 1; 
+    if (get_x(ini1) != get_x(ini2)) return (get_x(ini1) > get_x(ini2)) ? 1 : -1;
+    return (get_y(ini1) > get_y(ini2)) - (get_y(ini1) < get_y(ini2));
+}
+
+// COMPARAR_SEGMENTOS_POR_DISTANCIA
+static int comparar_segmentos_por_distancia(Segmento* s1, Segmento* s2, Ponto* origem) {
+    return comparar_chaves(segmento_distancia_ponto(s1, origem), segmento_get_id(s1), segmento_get_inicio(s1),
+                           segmento_distancia_ponto(s2, origem), segmento_get_id(s2), segmento_get_inicio(s2));
 }
 
 // INSERIR_NO
+// inserção de AVL: rebalanceia na volta, então a altura fica em O(log n) durante
+// toda a varredura, não só logo depois da construção em lote
 static No* inserir_no(No* raiz, Segmento* s, Ponto* ponto_ref) {
     if (raiz == NULL) {
         return criar_no(s);
@@ -81,19 +145,16 @@ static No* inserir_no(No* raiz, Segmento* s, Ponto* ponto_ref) {
         raiz->dir = inserir_no(raiz->dir, s, ponto_ref);
     }
     
-    return raiz;
+    return balancear(raiz);
 }
 
 // REMOVER_NO
 static No* remover_no(No* raiz, Segmento* s, Ponto* ponto_ref) {
     if (raiz == NULL) return NULL;
     
-    int id_busca = segmento_get_id(s);
-    int id_raiz = segmento_get_id(raiz->segmento);
-    
     int comparacao = comparar_segmentos_por_distancia(s, raiz->segmento, ponto_ref);
     
-    if (id_busca == id_raiz) {
+    if (raiz->segmento == s) {
         
         if (raiz->esq == NULL) {
             No* temp = raiz->dir;
@@ -119,34 +180,78 @@ static No* remover_no(No* raiz, Segmento* s, Ponto* ponto_ref) {
         }
     }
     
-    return raiz;
+    return balancear(raiz);
 }
 
 // --------------
 // FUNCOES BUSCA
 // --------------
 
-// BUSCAR_MAIS_PROXIMO_REC
-static void buscar_mais_proximo_rec(No* raiz, Ponto* origem, double angulo_raio, Segmento** resultado, double* menor_dist_int) {
+// MARCAS DOS GRUPOS
+// os segmentos que entram e os que saem no grupo consultado ficam marcados
+// durante a descida, para cada nó ser conferido em tempo constante
+#define MARCA_ENTRA 1
+#define MARCA_SAI 2
+
+// BUSCA_RAIO
+// estado de uma descida que procura, ao mesmo tempo, o segmento mais próximo
+// antes de um grupo de eventos (ignorando os que entram) e depois dele
+// (ignorando os que saem)
+typedef struct {
+    Ponto origem;
+    double dx, dy;
+    Segmento* antes;
+    double dist_antes;
+    Segmento* depois;
+    double dist_depois;
+} BuscaRaio;
+
+// BUSCAR_MAIS_PROXIMOS_REC
+// a distância mínima do segmento à origem é a chave da árvore e um limite
+// inferior para a distância do raio até ele. cota é a chave do antecessor do
+// nó na ordem (nenhum segmento da subárvore fica mais perto): a subárvore
+// inteira, esquerda inclusive, é pulada quando ela já passa das duas melhores
+// distâncias, e a descida para depois do primeiro acerto
+static void buscar_mais_proximos_rec(No* raiz, BuscaRaio* b, double cota) {
     if (raiz == NULL) return;
+    if (cota > fmax(b->dist_antes, b->dist_depois) + EPSILON) return;
     
-    Ponto* p_int = segmento_intersecao_raio(raiz->segmento, origem, angulo_raio);
+    double chave = segmento_distancia_ponto(raiz->segmento, &b->origem);
+    buscar_mais_proximos_rec(raiz->esq, b, cota);
     
-    if (p_int) {
-        double dist_int = distancia_pontos(origem, p_int);
-
-        if (dist_int < *menor_dist_int) {
-            *menor_dist_int = dist_int;
-            *resultado = raiz->segmento;
+    if (chave > fmax(b->dist_antes, b->dist_depois) + EPSILON) return;
+    
+    Ponto p_int;
+    
+    if (segmento_intersecao_raio_v(raiz->segmento, b->origem, b->dx, b->dy, &p_int)) {
+        double vx = p_int.x - b->origem.x;
+        double vy = p_int.y - b->origem.y;
+        
+        // só conta o que está à frente da origem
+        if (vx * b->dx + vy * b->dy >= 0.0) {
+            double dist_int = distancia_pontos_v(b->origem, p_int);
+            int marca = segmento_get_marca(raiz->segmento);
+            
+            if (dist_int < b->dist_antes && !(marca & MARCA_ENTRA)) {
+                b->dist_antes = dist_int;
+                b->antes = raiz->segmento;
+            }
+            if (dist_int < b->dist_depois && !(marca & MARCA_SAI)) {
+                b->dist_depois = dist_int;
+                b->depois = raiz->segmento;
+            }
         }
-        destruir_ponto(p_int);
     }
+    
+    buscar_mais_proximos_rec(raiz->dir, b, chave);
+}
 
-    if (segmento_distancia_ponto(raiz->segmento, origem) <= *menor_dist_int + EPSILON) {
-        buscar_mais_proximo_rec(raiz->esq, origem, angulo_raio, resultado, menor_dist_int);
+// MARCAR_GRUPO
+static void marcar_grupo(Segmento** v, int n, int marca, bool ligar) {
+    for (int i = 0; i < n; i++) {
+        int atual = segmento_get_marca(v[i]);
+        segmento_set_marca(v[i], ligar ? (atual | marca) : (atual & ~marca));
     }
-    
-    buscar_mais_proximo_rec(raiz->dir, origem, angulo_raio, resultado, menor_dist_int);
 }
 
 // BUSCAR_ID_REC
@@ -164,17 +269,41 @@ static Segmento* buscar_id_rec(No* raiz, int id) {
 }
 
 // SEGMENTO_MAIS_PROXIMO 
-Segmento* segmento_mais_proximo(Arvore* arv, double angulo_raio) {
-    if (arv == NULL) return NULL;
-    
+Segmento* segmento_mais_proximo(Arvore* arv, double dx, double dy) {
     Segmento* mais_proximo = NULL;
-    double menor_dist = 1e18; 
-
-    buscar_mais_proximo_rec(arv->raiz, arv->ponto_ref, angulo_raio, &mais_proximo, &menor_dist);
+    
+    segmentos_mais_proximos(arv, dx, dy, NULL, 0, NULL, 0, NULL, NULL, &mais_proximo, NULL);
     
     return mais_proximo;
 }
 
+// SEGMENTOS_MAIS_PROXIMOS
+void segmentos_mais_proximos(Arvore* arv, double dx, double dy,
+                             Segmento** entram, int n_entram, Segmento** saem, int n_saem,
+                             Segmento** antes, double* dist_antes, Segmento** depois, double* dist_depois) {
+    BuscaRaio b;
+    b.dx = dx;
+    b.dy = dy;
+    b.antes = NULL;
+    b.dist_antes = 1e18;
+    b.depois = NULL;
+    b.dist_depois = 1e18;
+    
+    if (arv != NULL && arv->ponto_ref != NULL) {
+        b.origem = *arv->ponto_ref;
+        marcar_grupo(entram, n_entram, MARCA_ENTRA, true);
+        marcar_grupo(saem, n_saem, MARCA_SAI, true);
+        buscar_mais_proximos_rec(arv->raiz, &b, 0.0);
+        marcar_grupo(entram, n_entram, MARCA_ENTRA, false);
+        marcar_grupo(saem, n_saem, MARCA_SAI, false);
+    }
+    
+    if (antes) *antes = b.antes;
+    if (dist_antes) *dist_antes = b.dist_antes;
+    if (depois) *depois = b.depois;
+    if (dist_depois) *dist_depois = b.dist_depois;
+}
+
 // BUSCA_SEGMENTO_ID
 Segmento* busca_segmento_id(Arvore* arv, int id) {
     if (arv == NULL) return NULL;
@@ -198,6 +327,75 @@ Arvore* criar_arvore(Ponto* ponto_referencia) {
     return arv;
 }
 
+// CHAVE_SEGMENTO
+// segmento acompanhado da sua chave, para ordenar uma vez só antes da construção
+typedef struct {
+    double distancia;
+    int id;
+    Ponto* inicio;
+    Segmento* segmento;
+} ChaveSegmento;
+
+// COMPARAR_CHAVES_QSORT
+static int comparar_chaves_qsort(const void* a, const void* b) {
+    const ChaveSegmento* c1 = (const ChaveSegmento*) a;
+    const ChaveSegmento* c2 = (const ChaveSegmento*) b;
+    
+    return comparar_chaves(c1->distancia, c1->id, c1->inicio, c2->distancia, c2->id, c2->inicio);
+}
+
+// CONSTRUIR_NO_BALANCEADO
+// o elemento do meio vira a raiz e cada metade vira uma subárvore
+static No* construir_no_balanceado(ChaveSegmento* chaves, int ini, int fim, bool* erro) {
+    if (ini > fim) return NULL;
+    
+    int meio = ini + (fim - ini) / 2;
+    No* no = criar_no(chaves[meio].segmento);
+    if (no == NULL) {
+        *erro = true;
+        return NULL;
+    }
+    
+    no->esq = construir_no_balanceado(chaves, ini, meio - 1, erro);
+    no->dir = construir_no_balanceado(chaves, meio + 1, fim, erro);
+    atualizar_altura(no);
+    
+    return no;
+}
+
+// CRIAR_ARVORE_COM_SEGMENTOS
+Arvore* criar_arvore_com_segmentos(Ponto* ponto_referencia, Segmento** segmentos, int n) {
+    Arvore* arv = criar_arvore(ponto_referencia);
+    if (arv == NULL || n <= 0 || segmentos == NULL) return arv;
+    
+    ChaveSegmento* chaves = (ChaveSegmento*) malloc(n * sizeof(ChaveSegmento));
+    if (chaves == NULL) {
+        destruir_arvore(arv);
+        return NULL;
+    }
+    
+    for (int i = 0; i < n; i++) {
+        chaves[i].distancia = segmento_distancia_ponto(segmentos[i], ponto_referencia);
+        chaves[i].id = segmento_get_id(segmentos[i]);
+        chaves[i].inicio = segmento_get_inicio(segmentos[i]);
+        chaves[i].segmento = segmentos[i];
+    }
+    
+    qsort(chaves, n, sizeof(ChaveSegmento), comparar_chaves_qsort);
+    
+    bool erro = false;
+    arv->raiz = construir_no_balanceado(chaves, 0, n - 1, &erro);
+    arv->tamanho = n;
+    free(chaves);
+    
+    if (erro) {
+        destruir_arvore(arv);
+        return NULL;
+    }
+    
+    return arv;
+}
+
 // DESTRUIR_ARVORE
 void destruir_arvore(Arvore* arv) {
     if (arv == NULL) return;
@@ -22,11 +22,23 @@ typedef struct Arvore Arvore;
 // --------------
 
 /* -> segmento_mais_proximo
-    FUNÇÃO: retorna o segmento mais próximo de um ponto
-    RECEBE: a árvore e o ponto
+    FUNÇÃO: retorna o segmento mais próximo da origem na direção de um raio
+    RECEBE: a árvore e a direção (dx, dy) do raio
     RETORNA: segmento mais próximo
  */
-Segmento* segmento_mais_proximo(Arvore* arv, double angulo_raio); 
+Segmento* segmento_mais_proximo(Arvore* arv, double dx, double dy); 
+
+/* -> segmentos_mais_proximos
+    FUNÇÃO: numa única descida, encontra o segmento mais próximo da origem na direção
+    de um raio antes e depois de um grupo de eventos; a árvore já deve conter os
+    segmentos que entram e ainda conter os que saem
+    RECEBE: a árvore, a direção (dx, dy) do raio, os segmentos que entram e os que saem
+    no grupo e onde guardar cada resultado (qualquer saída pode ser NULL)
+    RETORNA: o segmento e a distância até ele antes e depois do grupo (NULL e 1e18 se não houver)
+ */
+void segmentos_mais_proximos(Arvore* arv, double dx, double dy,
+                             Segmento** entram, int n_entram, Segmento** saem, int n_saem,
+                             Segmento** antes, double* dist_antes, Segmento** depois, double* dist_depois);
 
 /* -> busca_segmento_id
     FUNÇÃO: busca um segmento na árvore pelo ID
@@ -46,6 +58,15 @@ Segmento* busca_segmento_id(Arvore* arv, int id);
 */
 Arvore* criar_arvore(Ponto* ponto_referencia);
 
+/* -> criar_arvore_com_segmentos
+    FUNÇÃO: cria uma árvore já contendo os segmentos dados: ordena-os uma vez
+    (O(n log n)) e monta a árvore balanceada direto do vetor ordenado, sem as n
+    inserções. as inserções e remoções seguintes mantêm o balanceamento (AVL)
+    RECEBE: ponto de referência para ordenação, vetor de segmentos e o tamanho
+    RETORNA: árvore criada ou NULL em caso de erro
+*/
+Arvore* criar_arvore_com_segmentos(Ponto* ponto_referencia, Segmento** segmentos, int n);
+
 /* -> destruir_arvore
     FUNÇÃO: destrói a árvore (não destrói os segmentos, apenas a estrutura)
     RECEBE: a árvore
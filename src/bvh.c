@@ -0,0 +1,470 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "bvh.h"
+#include "geometria.h"
+#include "segmento.h"
+#include "lista.h"
+
+#define NULO -1
+#define EPSILON 1e-9
+#define FOLGA_CAIXA 1e-6   // as caixas de segmentos horizontais e verticais têm espessura zero
+
+// ESTRUTURA DE UM NÓ
+// folhas guardam um segmento e não têm filhos; nós internos guardam a união
+// das caixas dos dois filhos
+typedef struct {
+    double min_x, min_y, max_x, max_y;
+    int pai;       // nos nós livres, aponta o próximo livre
+    int esq, dir;
+    int altura;    // folhas têm altura 0
+    Segmento* segmento;
+} NoBvh;
+
+// ESTRUTURA DA BVH
+struct Bvh {
+    NoBvh* nos;
+    int cap_nos;
+    int raiz;
+    int livre;
+    int n_segmentos;
+};
+
+// ESTADO DE UMA CONSULTA DE RAIO
+typedef struct {
+    Ponto origem;
+    double dx, dy;
+    double inv_dx, inv_dy;  // inversos da direção (infinitos quando ela é nula)
+    double comprimento;    // |(dx, dy)|, converte o parâmetro do raio em distância
+    FiltroBvh ignorar;
+    void* contexto;
+    Segmento* melhor;
+    double dist_melhor;
+} ConsultaRaio;
+
+// ===================
+// FUNÇÕES AUXILIARES
+// ===================
+
+// ALOCAR_NO
+static int alocar_no(Bvh* b) {
+    if (b->livre == NULO) {
+        int nova_cap = b->cap_nos ? b->cap_nos * 2 : 64;
+        NoBvh* novo = (NoBvh*) realloc(b->nos, nova_cap * sizeof(NoBvh));
+        if (novo == NULL) return NULO;
+
+        for (int i = b->cap_nos; i < nova_cap; i++) {
+            novo[i].pai = (i + 1 < nova_cap) ? i + 1 : NULO;
+        }
+        b->nos = novo;
+        b->livre = b->cap_nos;
+        b->cap_nos = nova_cap;
+    }
+
+    int i = b->livre;
+    b->livre = b->nos[i].pai;
+
+    b->nos[i].pai = NULO;
+    b->nos[i].esq = NULO;
+    b->nos[i].dir = NULO;
+    b->nos[i].altura = 0;
+    b->nos[i].segmento = NULL;
+    return i;
+}
+
+// LIBERAR_NO
+static void liberar_no(Bvh* b, int i) {
+    b->nos[i].segmento = NULL;
+    b->nos[i].pai = b->livre;
+    b->livre = i;
+}
+
+// PERIMETRO_UNIAO
+// semiperímetro da caixa que envolve os nós a e b (custo usado na descida)
+static double perimetro_uniao(NoBvh* a, NoBvh* b) {
+    return fmax(a->max_x, b->max_x) - fmin(a->min_x, b->min_x) +
+           fmax(a->max_y, b->max_y) - fmin(a->min_y, b->min_y);
+}
+
+// PERIMETRO
+static double perimetro(NoBvh* a) {
+    return (a->max_x - a->min_x) + (a->max_y - a->min_y);
+}
+
+// CAIXA_CONTEM
+static bool caixa_contem(NoBvh* a, NoBvh* b) {
+    return a->min_x <= b->min_x && a->min_y <= b->min_y &&
+           a->max_x >= b->max_x && a->max_y >= b->max_y;
+}
+
+// AJUSTAR_NO
+// refaz a caixa e a altura de um nó interno a partir dos filhos
+static void ajustar_no(Bvh* b, int i) {
+    NoBvh* no = &b->nos[i];
+    NoBvh* e = &b->nos[no->esq];
+    NoBvh* d = &b->nos[no->dir];
+
+    no->min_x = fmin(e->min_x, d->min_x);
+    no->min_y = fmin(e->min_y, d->min_y);
+    no->max_x = fmax(e->max_x, d->max_x);
+    no->max_y = fmax(e->max_y, d->max_y);
+    no->altura = 1 + (e->altura > d->altura ? e->altura : d->altura);
+}
+
+// SUBSTITUIR_FILHO
+static void substituir_filho(Bvh* b, int pai, int antigo, int novo) {
+    if (pai == NULO) b->raiz = novo;
+    else if (b->nos[pai].esq == antigo) b->nos[pai].esq = novo;
+    else b->nos[pai].dir = novo;
+}
+
+// ROTACIONAR
+// se um filho de a é mais de um nível mais alto que o outro, ele sobe para o
+// lugar de a, que fica com o neto mais baixo; retorna o nó que ficou no lugar
+static int rotacionar(Bvh* b, int a) {
+    NoBvh* no_a = &b->nos[a];
+    if (no_a->segmento != NULL || no_a->altura < 2) return a;
+
+    int baixo = no_a->esq, alto = no_a->dir;
+    int diferenca = b->nos[alto].altura - b->nos[baixo].altura;
+
+    if (diferenca >= -1 && diferenca <= 1) return a;
+    if (diferenca < 0) {
+        baixo = no_a->dir;
+        alto = no_a->esq;
+    }
+
+    // o neto mais alto continua no nó que sobe; o outro desce para a
+    int f = b->nos[alto].esq, g = b->nos[alto].dir;
+    int fica = (b->nos[f].altura >= b->nos[g].altura) ? f : g;
+    int desce = (fica == f) ? g : f;
+
+    substituir_filho(b, no_a->pai, a, alto);
+    b->nos[alto].pai = no_a->pai;
+
+    b->nos[alto].esq = a;
+    b->nos[alto].dir = fica;
+    no_a->pai = alto;
+
+    no_a->esq = baixo;
+    no_a->dir = desce;
+    b->nos[desce].pai = a;
+
+    ajustar_no(b, a);
+    ajustar_no(b, alto);
+    return alto;
+}
+
+// AJUSTAR_ANCESTRAIS
+// refaz as caixas do nó i até a raiz, rotacionando onde a árvore desequilibrou
+static void ajustar_ancestrais(Bvh* b, int i) {
+    while (i != NULO) {
+        ajustar_no(b, i);
+        i = rotacionar(b, i);
+        i = b->nos[i].pai;
+    }
+}
+
+// ESCOLHER_IRMAO
+// desce escolhendo o filho em que a folha nova aumenta menos os perímetros;
+// para quando ficar ao lado do nó atual sai mais barato que descer
+static int escolher_irmao(Bvh* b, int folha) {
+    int i = b->raiz;
+    NoBvh* f = &b->nos[folha];
+
+    while (b->nos[i].segmento == NULL) {
+        NoBvh* no = &b->nos[i];
+        double uniao = perimetro_uniao(no, f);
+        double custo_aqui = 2.0 * uniao;
+        double heranca = 2.0 * (uniao - perimetro(no));
+
+        double custo[2];
+        int filhos[2] = { no->esq, no->dir };
+
+        for (int k = 0; k < 2; k++) {
+            NoBvh* filho = &b->nos[filhos[k]];
+            custo[k] = perimetro_uniao(filho, f) + heranca;
+            if (filho->segmento == NULL) custo[k] -= perimetro(filho);
+        }
+
+        if (custo_aqui < custo[0] && custo_aqui < custo[1]) break;
+        i = (custo[0] <= custo[1]) ? filhos[0] : filhos[1];
+    }
+
+    return i;
+}
+
+// BUSCAR_FOLHA
+static int buscar_folha(Bvh* b, int i, NoBvh* caixa, Segmento* s) {
+    if (i == NULO || !caixa_contem(&b->nos[i], caixa)) return NULO;
+
+    if (b->nos[i].segmento != NULL) {
+        return (b->nos[i].segmento == s) ? i : NULO;
+    }
+
+    int achado = buscar_folha(b, b->nos[i].esq, caixa, s);
+    if (achado != NULO) return achado;
+
+    return buscar_folha(b, b->nos[i].dir, caixa, s);
+}
+
+// ENTRADA_NA_CAIXA
+// parâmetro t >= 0 em que o raio entra na caixa (com folga), ou -1 se não entra
+// antes de t_limite
+static double entrada_na_caixa(NoBvh* no, ConsultaRaio* c, double t_limite) {
+    double t_min = 0.0, t_max = t_limite;
+
+    if (c->dx == 0.0) {
+        if (c->origem.x < no->min_x - FOLGA_CAIXA || c->origem.x > no->max_x + FOLGA_CAIXA) return -1.0;
+    }
+    else {
+        double t1 = (no->min_x - FOLGA_CAIXA - c->origem.x) * c->inv_dx;
+        double t2 = (no->max_x + FOLGA_CAIXA - c->origem.x) * c->inv_dx;
+        if (t1 > t2) { double aux = t1; t1 = t2; t2 = aux; }
+        if (t1 > t_min) t_min = t1;
+        if (t2 < t_max) t_max = t2;
+        if (t_min > t_max) return -1.0;
+    }
+
+    if (c->dy == 0.0) {
+        if (c->origem.y < no->min_y - FOLGA_CAIXA || c->origem.y > no->max_y + FOLGA_CAIXA) return -1.0;
+    }
+    else {
+        double t1 = (no->min_y - FOLGA_CAIXA - c->origem.y) * c->inv_dy;
+        double t2 = (no->max_y + FOLGA_CAIXA - c->origem.y) * c->inv_dy;
+        if (t1 > t2) { double aux = t1; t1 = t2; t2 = aux; }
+        if (t1 > t_min) t_min = t1;
+        if (t2 < t_max) t_max = t2;
+        if (t_min > t_max) return -1.0;
+    }
+
+    return t_min;
+}
+
+// TESTAR_FOLHA
+static void testar_folha(Segmento* s, ConsultaRaio* c) {
+    if (!segmento_intersecta_raio(s, &c->origem, c->dx, c->dy)) return;
+
+    Ponto p_int;
+    if (!segmento_intersecao_raio_v(s, c->origem, c->dx, c->dy, &p_int)) return;
+
+    // só conta o que está à frente da origem
+    double vx = p_int.x - c->origem.x;
+    double vy = p_int.y - c->origem.y;
+    if (vx * c->dx + vy * c->dy < 0.0) return;
+
+    double dist = distancia_pontos_v(c->origem, p_int);
+    if (dist >= c->dist_melhor) return;
+    if (c->ignorar && c->ignorar(s, c->contexto)) return;
+
+    c->dist_melhor = dist;
+    c->melhor = s;
+}
+
+// LIMITE_RAIO
+// maior parâmetro do raio que ainda pode melhorar o ponto achado
+static double limite_raio(ConsultaRaio* c) {
+    return (c->dist_melhor + EPSILON) / c->comprimento;
+}
+
+// CONSULTAR_REC
+static int consultar_rec(Bvh* b, int i, double min_x, double min_y, double max_x, double max_y, Lista* saida) {
+    NoBvh* no = &b->nos[i];
+    if (no->min_x > max_x || no->max_x < min_x || no->min_y > max_y || no->max_y < min_y) return 0;
+
+    if (no->segmento != NULL) {
+        inserir_fim_lista(saida, no->segmento);
+        return 1;
+    }
+
+    return consultar_rec(b, no->esq, min_x, min_y, max_x, max_y, saida) +
+           consultar_rec(b, no->dir, min_x, min_y, max_x, max_y, saida);
+}
+
+// RAIO_REC
+// visita primeiro o filho em que o raio entra antes; uma caixa que começa além
+// do melhor ponto já achado não pode ter nada mais perto
+static void raio_rec(Bvh* b, int i, ConsultaRaio* c) {
+    NoBvh* no = &b->nos[i];
+
+    if (no->segmento != NULL) {
+        testar_folha(no->segmento, c);
+        return;
+    }
+
+    double limite = limite_raio(c);
+    double t_esq = entrada_na_caixa(&b->nos[no->esq], c, limite);
+    double t_dir = entrada_na_caixa(&b->nos[no->dir], c, limite);
+
+    int primeiro = no->esq, segundo = no->dir;
+    double t_primeiro = t_esq, t_segundo = t_dir;
+
+    if (t_dir >= 0.0 && (t_esq < 0.0 || t_dir < t_esq)) {
+        primeiro = no->dir;
+        segundo = no->esq;
+        t_primeiro = t_dir;
+        t_segundo = t_esq;
+    }
+
+    if (t_primeiro >= 0.0) raio_rec(b, primeiro, c);
+
+    // o primeiro filho pode ter encurtado o raio
+    if (t_segundo >= 0.0 && t_segundo <= limite_raio(c)) raio_rec(b, segundo, c);
+}
+
+// --------------------------------
+// FUNÇÕES DE CRIAÇÃO E DESTRUIÇÃO
+// --------------------------------
+
+// CRIAR_BVH
+Bvh* criar_bvh(void) {
+    Bvh* b = (Bvh*) malloc(sizeof(Bvh));
+    if (b == NULL) return NULL;
+
+    b->nos = NULL;
+    b->cap_nos = 0;
+    b->raiz = NULO;
+    b->livre = NULO;
+    b->n_segmentos = 0;
+
+    return b;
+}
+
+// DESTRUIR_BVH
+void destruir_bvh(Bvh* b) {
+    if (b == NULL) return;
+
+    free(b->nos);
+    free(b);
+}
+
+// ---------------------------
+// ALTERAR BVHS EXISTENTES
+// ---------------------------
+
+// BVH_INSERIR
+bool bvh_inserir(Bvh* b, Segmento* s) {
+    if (b == NULL || s == NULL) return false;
+
+    int folha = alocar_no(b);
+    if (folha == NULO) return false;
+
+    NoBvh* f = &b->nos[folha];
+    f->segmento = s;
+    segmento_get_bbox(s, &f->min_x, &f->min_y, &f->max_x, &f->max_y);
+    b->n_segmentos++;
+
+    if (b->raiz == NULO) {
+        b->raiz = folha;
+        return true;
+    }
+
+    // o pai novo é alocado antes de guardar ponteiros (alocar pode mover o vetor)
+    int pai = alocar_no(b);
+    if (pai == NULO) {
+        liberar_no(b, folha);
+        b->n_segmentos--;
+        return false;
+    }
+
+    int irmao = escolher_irmao(b, folha);
+    int avo = b->nos[irmao].pai;
+
+    b->nos[pai].pai = avo;
+    b->nos[pai].esq = irmao;
+    b->nos[pai].dir = folha;
+    b->nos[irmao].pai = pai;
+    b->nos[folha].pai = pai;
+
+    if (avo == NULO) {
+        b->raiz = pai;
+    }
+    else if (b->nos[avo].esq == irmao) {
+        b->nos[avo].esq = pai;
+    }
+    else {
+        b->nos[avo].dir = pai;
+    }
+
+    ajustar_ancestrais(b, pai);
+    return true;
+}
+
+// BVH_REMOVER
+bool bvh_remover(Bvh* b, Segmento* s) {
+    if (b == NULL || s == NULL) return false;
+
+    NoBvh caixa;
+    segmento_get_bbox(s, &caixa.min_x, &caixa.min_y, &caixa.max_x, &caixa.max_y);
+
+    int folha = buscar_folha(b, b->raiz, &caixa, s);
+    if (folha == NULO) return false;
+
+    int pai = b->nos[folha].pai;
+    liberar_no(b, folha);
+    b->n_segmentos--;
+
+    if (pai == NULO) {
+        b->raiz = NULO;
+        return true;
+    }
+
+    // o irmão sobe para o lugar do pai
+    int irmao = (b->nos[pai].esq == folha) ? b->nos[pai].dir : b->nos[pai].esq;
+    int avo = b->nos[pai].pai;
+
+    b->nos[irmao].pai = avo;
+    liberar_no(b, pai);
+
+    if (avo == NULO) {
+        b->raiz = irmao;
+        return true;
+    }
+
+    if (b->nos[avo].esq == pai) b->nos[avo].esq = irmao;
+    else b->nos[avo].dir = irmao;
+
+    ajustar_ancestrais(b, avo);
+    return true;
+}
+
+// --------------
+// FUNÇÕES BUSCA
+// --------------
+
+// BVH_TAMANHO
+int bvh_tamanho(Bvh* b) {
+    return b ? b->n_segmentos : 0;
+}
+
+// BVH_CONSULTAR
+int bvh_consultar(Bvh* b, double min_x, double min_y, double max_x, double max_y, Lista* saida) {
+    if (b == NULL || saida == NULL || b->raiz == NULO) return 0;
+
+    return consultar_rec(b, b->raiz, min_x, min_y, max_x, max_y, saida);
+}
+
+// BVH_RAIO_MAIS_PROXIMO
+Segmento* bvh_raio_mais_proximo(Bvh* b, Ponto origem, double dx, double dy,
+                                FiltroBvh ignorar, void* contexto, double* distancia) {
+    ConsultaRaio c;
+    c.origem = origem;
+    c.dx = dx;
+    c.dy = dy;
+    c.inv_dx = 1.0 / dx;
+    c.inv_dy = 1.0 / dy;
+    c.comprimento = sqrt(dx * dx + dy * dy);
+    c.ignorar = ignorar;
+    c.contexto = contexto;
+    c.melhor = NULL;
+    c.dist_melhor = 1e18;
+
+    if (b != NULL && b->raiz != NULO && c.comprimento > 0.0 &&
+        entrada_na_caixa(&b->nos[b->raiz], &c, INFINITY) >= 0.0) {
+        raio_rec(b, b->raiz, &c);
+    }
+
+    if (distancia) *distancia = c.dist_melhor;
+    return c.melhor;
+}
@@ -0,0 +1,92 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <stdbool.h>
+
+#include "geometria.h"
+#include "segmento.h"
+#include "lista.h"
+
+// ===============================================
+// BVH DOS ANTEPAROS
+// ----------------------------------------------
+// hierarquia de caixas envolventes sobre os
+// segmentos, montada aos poucos (cada inserção
+// desce até o vizinho que menos aumenta o
+// perímetro das caixas, e rotações mantêm a
+// altura equilibrada). responde qual é o
+// primeiro segmento atingido por um raio sem
+// olhar os que estão longe dele.
+// ===============================================
+
+// ESTRUTURA DA BVH
+typedef struct Bvh Bvh;
+
+// FILTRO DE SEGMENTOS (verdadeiro = o raio atravessa o segmento)
+typedef bool (*FiltroBvh)(Segmento* s, void* contexto);
+
+// --------------------------------
+// FUNÇÕES DE CRIAÇÃO E DESTRUIÇÃO
+// --------------------------------
+
+/* -> criar_bvh
+    FUNÇÃO: cria uma BVH vazia
+    RETORNA: ponteiro para a BVH
+*/
+Bvh* criar_bvh(void);
+
+/* -> destruir_bvh
+    FUNÇÃO: destrói a BVH (não destrói os segmentos, apenas a estrutura)
+    RECEBE: a BVH
+*/
+void destruir_bvh(Bvh* b);
+
+// ---------------------------
+// ALTERAR BVHS EXISTENTES
+// ---------------------------
+
+/* -> bvh_inserir
+    FUNÇÃO: acrescenta um segmento à hierarquia
+    RECEBE: a BVH e o segmento
+    RETORNA: verdadeiro se o segmento foi inserido
+*/
+bool bvh_inserir(Bvh* b, Segmento* s);
+
+/* -> bvh_remover
+    FUNÇÃO: retira um segmento da hierarquia
+    RECEBE: a BVH e o segmento
+    RETORNA: verdadeiro se o segmento foi encontrado e removido
+*/
+bool bvh_remover(Bvh* b, Segmento* s);
+
+// --------------
+// FUNÇÕES BUSCA
+// --------------
+
+/* -> bvh_tamanho
+    FUNÇÃO: conta os segmentos guardados
+    RECEBE: a BVH
+    RETORNA: a quantidade de segmentos
+*/
+int bvh_tamanho(Bvh* b);
+
+/* -> bvh_consultar
+    FUNÇÃO: encontra os segmentos cuja caixa envolvente toca uma região
+    RECEBE: a BVH, a região (min_x, min_y, max_x, max_y) e a lista de saída
+    RETORNA: quantidade de segmentos inseridos na lista (na ordem da árvore)
+*/
+int bvh_consultar(Bvh* b, double min_x, double min_y, double max_x, double max_y, Lista* saida);
+
+/* -> bvh_raio_mais_proximo
+    FUNÇÃO: encontra o primeiro segmento atingido por um raio
+    RECEBE:
+    - a BVH
+    - a origem e a direção (dx, dy) do raio, que não precisa ser unitária
+    - um filtro com os segmentos que o raio atravessa (ou NULL) e seu contexto
+    - onde guardar a distância da origem até o ponto atingido (ou NULL)
+    RETORNA: o segmento atingido, ou NULL se o raio não atinge nenhum
+*/
+Segmento* bvh_raio_mais_proximo(Bvh* b, Ponto origem, double dx, double dy,
+                                FiltroBvh ignorar, void* contexto, double* distancia);
+
+#endif
@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "cache_visibilidade.h"
+#include "poligono.h"
+
+// ENTRADA DO CACHE
+typedef struct {
+    double x, y;
+    double raio;
+    double direcao, abertura; // setor (abertura 0 = volta inteira)
+    unsigned int versao;
+    unsigned long ultimo_uso; // 0 = posição livre
+    Poligono* poligono;
+} EntradaCache;
+
+// ESTRUTURA DO CACHE
+struct CacheVisibilidade {
+    EntradaCache* entradas;
+    int capacidade;
+    unsigned long relogio;
+};
+
+// --------------------------------
+// FUNÇÕES DE CRIAÇÃO E DESTRUIÇÃO
+// --------------------------------
+
+// CRIAR_CACHE_VISIBILIDADE
+CacheVisibilidade* criar_cache_visibilidade(int capacidade) {
+    if (capacidade <= 0) return NULL;
+    
+    CacheVisibilidade* c = (CacheVisibilidade*) malloc(sizeof(CacheVisibilidade));
+    if (c == NULL) return NULL;
+    
+    c->entradas = (EntradaCache*) calloc(capacidade, sizeof(EntradaCache));
+    if (c->entradas == NULL) {
+        free(c);
+        return NULL;
+    }
+    
+    c->capacidade = capacidade;
+    c->relogio = 0;
+    return c;
+}
+
+// DESTRUIR_CACHE_VISIBILIDADE
+void destruir_cache_visibilidade(CacheVisibilidade* c) {
+    if (c == NULL) return;
+    
+    for (int i = 0; i < c->capacidade; i++) {
+        if (c->entradas[i].ultimo_uso != 0) destruir_poligono(c->entradas[i].poligono);
+    }
+    
+    free(c->entradas);
+    free(c);
+}
+
+// --------------
+// FUNÇÕES BUSCA
+// --------------
+
+// CACHE_VISIBILIDADE_BUSCAR
+Poligono* cache_visibilidade_buscar(CacheVisibilidade* c, double x, double y, double raio, double direcao, double abertura, unsigned int versao) {
+    if (c == NULL) return NULL;
+    
+    for (int i = 0; i < c->capacidade; i++) {
+        EntradaCache* e = &c->entradas[i];
+        
+        if (e->ultimo_uso != 0 && e->versao == versao && e->x == x && e->y == y && e->raio == raio &&
+            e->direcao == direcao && e->abertura == abertura) {
+            e->ultimo_uso = ++c->relogio;
+            return e->poligono;
+        }
+    }
+    
+    return NULL;
+}
+
+// ---------------------------
+// ALTERAR CACHES EXISTENTES
+// ---------------------------
+
+// CACHE_VISIBILIDADE_GUARDAR
+bool cache_visibilidade_guardar(CacheVisibilidade* c, double x, double y, double raio, double direcao, double abertura, unsigned int versao, Poligono* poligono) {
+    if (c == NULL || poligono == NULL) return false;
+    
+    // uma posição livre ou, na falta dela, a usada há mais tempo; as de versões
+    // antigas nunca mais são encontradas e acabam saindo por aqui
+    EntradaCache* alvo = &c->entradas[0];
+    for (int i = 0; i < c->capacidade; i++) {
+        EntradaCache* e = &c->entradas[i];
+        if (e->ultimo_uso < alvo->ultimo_uso) alvo = e;
+    }
+    
+    if (alvo->ultimo_uso != 0) destruir_poligono(alvo->poligono);
+    
+    alvo->x = x;
+    alvo->y = y;
+    alvo->raio = raio;
+    alvo->direcao = direcao;
+    alvo->abertura = abertura;
+    alvo->versao = versao;
+    alvo->ultimo_uso = ++c->relogio;
+    alvo->poligono = poligono;
+    return true;
+}
@@ -0,0 +1,65 @@
+#ifndef CACHE_VISIBILIDADE_H
+#define CACHE_VISIBILIDADE_H
+
+#include <stdbool.h>
+
+#include "poligono.h"
+
+// ===============================================
+// CACHE DE VISIBILIDADE
+// ----------------------------------------------
+// guarda os últimos polígonos de visibilidade
+// calculados, pela origem exata, pelo alcance da
+// bomba (raio e setor) e pela versão do conjunto
+// de anteparos. bombas repetidas no mesmo ponto,
+// sem anteparos novos no meio, reaproveitam o
+// polígono em vez de refazer a varredura. quando
+// fica cheio, descarta o menos usado recentemente.
+// ===============================================
+
+// ESTRUTURA DO CACHE
+typedef struct CacheVisibilidade CacheVisibilidade;
+
+// --------------------------------
+// FUNÇÕES DE CRIAÇÃO E DESTRUIÇÃO
+// --------------------------------
+
+/* -> criar_cache_visibilidade
+    FUNÇÃO: cria um cache vazio
+    RECEBE: quantos polígonos ele guarda
+    RETORNA: ponteiro para o cache
+*/
+CacheVisibilidade* criar_cache_visibilidade(int capacidade);
+
+/* -> destruir_cache_visibilidade
+    FUNÇÃO: destrói o cache e os polígonos guardados nele (array de coordenadas)
+    RECEBE: o cache
+*/
+void destruir_cache_visibilidade(CacheVisibilidade* c);
+
+// --------------
+// FUNÇÕES BUSCA
+// --------------
+
+/* -> cache_visibilidade_buscar
+    FUNÇÃO: procura o polígono de uma origem e alcance para uma versão dos anteparos
+    RECEBE: o cache, a origem (x, y), o raio (0 = sem limite), a direção e a
+    abertura do setor (abertura 0 = volta inteira) e a versão
+    RETORNA: o polígono (que continua sendo do cache) ou NULL se não estiver guardado
+*/
+Poligono* cache_visibilidade_buscar(CacheVisibilidade* c, double x, double y, double raio, double direcao, double abertura, unsigned int versao);
+
+// ---------------------------
+// ALTERAR CACHES EXISTENTES
+// ---------------------------
+
+/* -> cache_visibilidade_guardar
+    FUNÇÃO: guarda um polígono; o cache passa a ser dono dele e destrói o
+    menos usado se estiver cheio
+    RECEBE: o cache, a origem (x, y), o raio, a direção e a abertura do setor, a
+    versão dos anteparos e o polígono
+    RETORNA: verdadeiro se o polígono foi guardado
+*/
+bool cache_visibilidade_guardar(CacheVisibilidade* c, double x, double y, double raio, double direcao, double abertura, unsigned int versao, Poligono* poligono);
+
+#endif
@@ -0,0 +1,429 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "checkpoint.h"
+#include "formas.h"
+#include "segmento.h"
+#include "geometria.h"
+#include "lista.h"
+
+#define MAGICA_CHECKPOINT "TEDCKPT"
+#define VERSAO_CHECKPOINT 3
+#define TAM_COR 20
+
+// TIPOS DE REGISTRO
+enum {
+    REG_DESTRUICAO = 1,
+    REG_PINTURA,
+    REG_CLONE,
+    REG_SEGMENTO,
+    REG_MARCO
+};
+
+// CABEÇALHO DO DIÁRIO
+typedef struct {
+    char magica[8];
+    uint32_t versao;
+    uint32_t reservado;
+    int64_t tamanho_qry;
+    int64_t mtime_qry;
+} CabecalhoCheckpoint;
+
+// REGISTROS (cada um é precedido de um byte com o tipo)
+typedef struct { int32_t id; } RegDestruicao;
+typedef struct { int32_t id; char cor[TAM_COR]; } RegPintura;
+typedef struct { int32_t id_original; int32_t id_clone; double dx, dy; } RegClone;
+typedef struct { int32_t id; char cor[TAM_COR]; int32_t grupo; int32_t lado; double x1, y1, x2, y2; } RegSegmento;
+typedef struct { int64_t offset_qry; int64_t offset_txt; int32_t id_segmento; int32_t id_clone; uint32_t n_registros; uint32_t reservado; } RegMarco;
+
+// ESTRUTURA DO CHECKPOINT
+struct Checkpoint {
+    FILE* arquivo;
+    CabecalhoCheckpoint cabecalho;
+    bool pode_retomar;
+
+    // alterações ainda não gravadas
+    unsigned char* pendente;
+    size_t tamanho_pendente;
+    size_t cap_pendente;
+    uint32_t n_pendentes;
+};
+
+// TABELA DE IDS (usada ao reaplicar o diário)
+typedef struct {
+    int id;
+    Elemento* elem;
+    bool usado;
+} EntradaId;
+
+typedef struct {
+    EntradaId* v;
+    int cap;
+    int n;
+} TabelaIds;
+
+// ===================
+// FUNÇÕES AUXILIARES
+// ===================
+
+// TAMANHO_REGISTRO
+static size_t tamanho_registro(int tipo) {
+    switch (tipo) {
+        case REG_DESTRUICAO: return sizeof(RegDestruicao);
+        case REG_PINTURA: return sizeof(RegPintura);
+        case REG_CLONE: return sizeof(RegClone);
+        case REG_SEGMENTO: return sizeof(RegSegmento);
+        case REG_MARCO: return sizeof(RegMarco);
+    }
+    return 0;
+}
+
+// ACRESCENTAR_REGISTRO
+static void acrescentar_registro(Checkpoint* ck, unsigned char tipo, const void* dados) {
+    size_t tam = tamanho_registro(tipo);
+
+    if (ck->tamanho_pendente + 1 + tam > ck->cap_pendente) {
+        size_t nova_cap = ck->cap_pendente ? ck->cap_pendente * 2 : 4096;
+        while (nova_cap < ck->tamanho_pendente + 1 + tam) nova_cap *= 2;
+        unsigned char* novo = (unsigned char*) realloc(ck->pendente, nova_cap);
+        if (novo == NULL) return;
+        ck->pendente = novo;
+        ck->cap_pendente = nova_cap;
+    }
+
+    ck->pendente[ck->tamanho_pendente++] = tipo;
+    memcpy(ck->pendente + ck->tamanho_pendente, dados, tam);
+    ck->tamanho_pendente += tam;
+}
+
+// COPIAR_COR
+static void copiar_cor(char* destino, const char* cor) {
+    memset(destino, 0, TAM_COR);
+    if (cor) memcpy(destino, cor, strnlen(cor, TAM_COR - 1));
+}
+
+// ESTADO_QRY (tamanho e data de modificação do .qry)
+static int estado_qry(char* caminho_qry, CabecalhoCheckpoint* cab) {
+    struct stat st;
+    if (stat(caminho_qry, &st) != 0) return -1;
+
+    cab->tamanho_qry = (int64_t) st.st_size;
+    cab->mtime_qry = (int64_t) st.st_mtime;
+    return 0;
+}
+
+// LER_REGISTRO
+static bool ler_registro(FILE* arquivo, int* tipo, void* dados) {
+    int c = fgetc(arquivo);
+    if (c == EOF) return false;
+
+    size_t tam = tamanho_registro(c);
+    if (tam == 0 || fread(dados, tam, 1, arquivo) != 1) return false;
+
+    *tipo = c;
+    return true;
+}
+
+// TABELA_POSICAO
+static EntradaId* tabela_posicao(TabelaIds* t, int id) {
+    unsigned int h = ((unsigned int) id * 2654435761u) & (t->cap - 1);
+    while (t->v[h].usado && t->v[h].id != id) h = (h + 1) & (t->cap - 1);
+    return &t->v[h];
+}
+
+// TABELA_INSERIR
+static void tabela_inserir(TabelaIds* t, int id, Elemento* elem) {
+    if ((t->n + 1) * 2 > t->cap) {
+        EntradaId* antigas = t->v;
+        int cap_antiga = t->cap;
+
+        t->cap = cap_antiga ? cap_antiga * 2 : 256;
+        t->v = (EntradaId*) calloc(t->cap, sizeof(EntradaId));
+        t->n = 0;
+
+        for (int i = 0; i < cap_antiga; i++) {
+            if (antigas[i].usado) {
+                *tabela_posicao(t, antigas[i].id) = antigas[i];
+                t->n++;
+            }
+        }
+        free(antigas);
+    }
+
+    EntradaId* e = tabela_posicao(t, id);
+    if (!e->usado) {
+        e->usado = true;
+        e->id = id;
+        e->elem = elem;
+        t->n++;
+    }
+    else if (e->elem == NULL) {
+        e->elem = elem;
+    }
+}
+
+// TABELA_BUSCAR
+static Elemento* tabela_buscar(TabelaIds* t, int id) {
+    if (t->cap == 0) return NULL;
+    EntradaId* e = tabela_posicao(t, id);
+    return e->usado ? e->elem : NULL;
+}
+
+// APLICAR_REGISTRO
+static void aplicar_registro(int tipo, const void* dados, Lista* formas, Lista* segmentos, TabelaIds* ids) {
+    if (tipo == REG_DESTRUICAO) {
+        const RegDestruicao* r = (const RegDestruicao*) dados;
+        Elemento* elem = tabela_buscar(ids, r->id);
+        if (elem) {
+            Forma* f = (Forma*) remover_posicao_lista(formas, elem);
+            destruir_forma(f);
+            tabela_posicao(ids, r->id)->elem = NULL;
+        }
+    }
+    else if (tipo == REG_PINTURA) {
+        const RegPintura* r = (const RegPintura*) dados;
+        Elemento* elem = tabela_buscar(ids, r->id);
+        if (elem) {
+            Forma* f = (Forma*) get_elemento(formas, elem);
+            forma_set_cor_borda(f, r->cor);
+            forma_set_cor_preenchimento(f, r->cor);
+        }
+    }
+    else if (tipo == REG_CLONE) {
+        const RegClone* r = (const RegClone*) dados;
+        Elemento* elem = tabela_buscar(ids, r->id_original);
+        if (elem) {
+            Forma* clone = forma_clonar((Forma*) get_elemento(formas, elem), r->id_clone);
+            if (clone) {
+                forma_mover(clone, r->dx, r->dy);
+                inserir_fim_lista(formas, clone);
+                tabela_inserir(ids, r->id_clone, get_ultimo_elemento(formas));
+            }
+        }
+    }
+    else if (tipo == REG_SEGMENTO) {
+        const RegSegmento* r = (const RegSegmento*) dados;
+        char cor[TAM_COR];
+        copiar_cor(cor, r->cor);
+
+        Segmento* s = criar_segmento(r->id, criar_ponto(r->x1, r->y1), criar_ponto(r->x2, r->y2), cor);
+        if (s) {
+            segmento_set_grupo(s, r->grupo, r->lado);
+            inserir_fim_lista(segmentos, s);
+        }
+    }
+}
+
+// --------------------------------
+// FUNÇÕES DE CRIAÇÃO E DESTRUIÇÃO
+// --------------------------------
+
+// ABRIR_CHECKPOINT
+Checkpoint* abrir_checkpoint(char* caminho, char* caminho_qry, bool retomar) {
+    if (caminho == NULL || caminho_qry == NULL) return NULL;
+
+    Checkpoint* ck = (Checkpoint*) calloc(1, sizeof(Checkpoint));
+    if (ck == NULL) return NULL;
+
+    memcpy(ck->cabecalho.magica, MAGICA_CHECKPOINT, sizeof(MAGICA_CHECKPOINT));
+    ck->cabecalho.versao = VERSAO_CHECKPOINT;
+
+    if (estado_qry(caminho_qry, &ck->cabecalho) != 0) {
+        free(ck);
+        return NULL;
+    }
+
+    if (retomar) {
+        ck->arquivo = fopen(caminho, "r+b");
+
+        CabecalhoCheckpoint lido;
+        if (ck->arquivo != NULL && fread(&lido, sizeof(lido), 1, ck->arquivo) == 1 &&
+            memcmp(&lido, &ck->cabecalho, sizeof(lido)) == 0) {
+            ck->pode_retomar = true;
+            return ck;
+        }
+
+        fprintf(stderr, "checkpoint ausente ou de outro .qry, recomeçando do início: %s\n", caminho);
+        if (ck->arquivo) fclose(ck->arquivo);
+    }
+
+    ck->arquivo = fopen(caminho, "wb");
+    if (ck->arquivo == NULL || fwrite(&ck->cabecalho, sizeof(ck->cabecalho), 1, ck->arquivo) != 1) {
+        fprintf(stderr, "erro ao criar checkpoint: %s\n", caminho);
+        if (ck->arquivo) fclose(ck->arquivo);
+        free(ck);
+        return NULL;
+    }
+    fflush(ck->arquivo);
+
+    return ck;
+}
+
+// FECHAR_CHECKPOINT
+void fechar_checkpoint(Checkpoint* ck) {
+    if (ck == NULL) return;
+
+    fclose(ck->arquivo);
+    free(ck->pendente);
+    free(ck);
+}
+
+// ----------------------
+// RETOMAR UMA EXECUÇÃO
+// ----------------------
+
+// CHECKPOINT_RESTAURAR
+int checkpoint_restaurar(Checkpoint* ck, Lista* formas, Lista* segmentos, long* offset_qry, long* offset_txt, int* id_segmento, int* id_clone) {
+    if (ck == NULL || !ck->pode_retomar) return 0;
+
+    long inicio = (long) sizeof(CabecalhoCheckpoint);
+    long fim_valido = inicio;
+    int marcos = 0;
+    RegMarco ultimo = {0, 0, 0, 0, 0, 0};
+
+    union {
+        RegDestruicao d; RegPintura p; RegClone c; RegSegmento s; RegMarco m;
+    } dados;
+    int tipo;
+
+    // 1ª passada: acha o fim do último marco completo
+    fseek(ck->arquivo, inicio, SEEK_SET);
+    while (ler_registro(ck->arquivo, &tipo, &dados)) {
+        if (tipo == REG_MARCO) {
+            fim_valido = ftell(ck->arquivo);
+            ultimo = dados.m;
+            marcos++;
+        }
+    }
+
+    if (marcos > 0) {
+        // 2ª passada: reaplica tudo até esse marco
+        TabelaIds ids = {NULL, 0, 0};
+
+        Elemento* elem = get_primeiro_elemento(formas);
+        while (elem != NULL) {
+            tabela_inserir(&ids, forma_get_id((Forma*) get_elemento(formas, elem)), elem);
+            elem = get_proximo_elemento(elem);
+        }
+
+        fseek(ck->arquivo, inicio, SEEK_SET);
+        while (ftell(ck->arquivo) < fim_valido && ler_registro(ck->arquivo, &tipo, &dados)) {
+            aplicar_registro(tipo, &dados, formas, segmentos, &ids);
+        }
+        free(ids.v);
+
+        *offset_qry = (long) ultimo.offset_qry;
+        *offset_txt = (long) ultimo.offset_txt;
+        *id_segmento = ultimo.id_segmento;
+        *id_clone = ultimo.id_clone;
+    }
+
+    // descarta o que ficou depois do último marco e continua gravando dali
+    fflush(ck->arquivo);
+    if (ftruncate(fileno(ck->arquivo), (off_t) fim_valido) != 0) {
+        fprintf(stderr, "aviso: não foi possível truncar o checkpoint\n");
+    }
+    fseek(ck->arquivo, fim_valido, SEEK_SET);
+
+    return marcos;
+}
+
+// ----------------------
+// REGISTRAR ALTERAÇÕES
+// ----------------------
+
+// CHECKPOINT_REGISTRAR_DESTRUICAO
+void checkpoint_registrar_destruicao(Checkpoint* ck, int id) {
+    if (ck == NULL) return;
+
+    RegDestruicao r = { id };
+    acrescentar_registro(ck, REG_DESTRUICAO, &r);
+    ck->n_pendentes++;
+}
+
+// CHECKPOINT_REGISTRAR_PINTURA
+void checkpoint_registrar_pintura(Checkpoint* ck, int id, const char* cor) {
+    if (ck == NULL) return;
+
+    RegPintura r;
+    r.id = id;
+    copiar_cor(r.cor, cor);
+    acrescentar_registro(ck, REG_PINTURA, &r);
+    ck->n_pendentes++;
+}
+
+// CHECKPOINT_REGISTRAR_CLONE
+void checkpoint_registrar_clone(Checkpoint* ck, int id_original, int id_clone, double dx, double dy) {
+    if (ck == NULL) return;
+
+    RegClone r = { id_original, id_clone, dx, dy };
+    acrescentar_registro(ck, REG_CLONE, &r);
+    ck->n_pendentes++;
+}
+
+// CHECKPOINT_REGISTRAR_SEGMENTO
+void checkpoint_registrar_segmento(Checkpoint* ck, Segmento* s) {
+    if (ck == NULL || s == NULL) return;
+
+    Ponto* ini = segmento_get_inicio(s);
+    Ponto* fim = segmento_get_fim(s);
+
+    RegSegmento r;
+    r.id = segmento_get_id(s);
+    copiar_cor(r.cor, segmento_get_cor(s));
+    r.grupo = segmento_get_grupo(s);
+    r.lado = segmento_get_lado(s);
+    r.x1 = get_x(ini);
+    r.y1 = get_y(ini);
+    r.x2 = get_x(fim);
+    r.y2 = get_y(fim);
+    acrescentar_registro(ck, REG_SEGMENTO, &r);
+    ck->n_pendentes++;
+}
+
+// CHECKPOINT_MARCAR
+void checkpoint_marcar(Checkpoint* ck, long offset_qry, long offset_txt, int id_segmento, int id_clone) {
+    if (ck == NULL) return;
+
+    RegMarco m;
+    memset(&m, 0, sizeof(m));
+    m.offset_qry = offset_qry;
+    m.offset_txt = offset_txt;
+    m.id_segmento = id_segmento;
+    m.id_clone = id_clone;
+    m.n_registros = ck->n_pendentes;
+    acrescentar_registro(ck, REG_MARCO, &m);
+
+    if (fwrite(ck->pendente, 1, ck->tamanho_pendente, ck->arquivo) != ck->tamanho_pendente) {
+        fprintf(stderr, "erro ao gravar checkpoint\n");
+    }
+    fflush(ck->arquivo);
+
+    ck->tamanho_pendente = 0;
+    ck->n_pendentes = 0;
+}
+
+// ----------------------
+// RELATÓRIO
+// ----------------------
+
+// CHECKPOINT_CORTAR_RELATORIO
+bool checkpoint_cortar_relatorio(FILE* txt, long tamanho) {
+    if (txt == NULL) return false;
+
+    fflush(txt);
+    if (ftruncate(fileno(txt), (off_t) tamanho) != 0) {
+        fprintf(stderr, "aviso: não foi possível cortar o relatório\n");
+        return false;
+    }
+    fseek(txt, tamanho, SEEK_SET);
+
+    return true;
+}
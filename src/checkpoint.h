@@ -0,0 +1,108 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "lista.h"
+#include "formas.h"
+#include "segmento.h"
+
+// ===============================================
+// CHECKPOINT
+// ----------------------------------------------
+// diário binário das alterações feitas por um
+// .qry (destruição, pintura, clonagem e novos
+// anteparos). as alterações ficam guardadas até
+// o próximo marco, quando são gravadas de uma vez
+// junto com a posição no .qry, o tamanho do
+// relatório e os contadores de id. só o que mudou
+// desde o último marco é escrito; para retomar,
+// o diário é reaplicado sobre as formas do .geo
+// até o último marco e o relatório é cortado no
+// tamanho que tinha ali.
+// ===============================================
+
+// ESTRUTURA DO CHECKPOINT
+typedef struct Checkpoint Checkpoint;
+
+// --------------------------------
+// FUNÇÕES DE CRIAÇÃO E DESTRUIÇÃO
+// --------------------------------
+
+/* -> abrir_checkpoint
+    FUNÇÃO: abre o diário de checkpoints de um .qry
+    RECEBE: caminho do diário, caminho do .qry e se a execução vai ser retomada
+    (sem retomar, o diário é recriado do zero)
+    RETORNA: ponteiro para o checkpoint ou NULL em caso de erro
+ */
+Checkpoint* abrir_checkpoint(char* caminho, char* caminho_qry, bool retomar);
+
+/* -> fechar_checkpoint
+    FUNÇÃO: fecha o diário (alterações sem marco são descartadas)
+    RECEBE: o checkpoint
+ */
+void fechar_checkpoint(Checkpoint* ck);
+
+// ----------------------
+// RETOMAR UMA EXECUÇÃO
+// ----------------------
+
+/* -> checkpoint_restaurar
+    FUNÇÃO: reaplica o diário até o último marco completo
+    RECEBE: o checkpoint, a lista de formas (já carregada do .geo), a lista
+    de anteparos e onde devolver a posição no .qry, o tamanho do relatório e
+    os contadores de id
+    RETORNA: quantidade de marcos reaplicados (0 se não havia nenhum)
+ */
+int checkpoint_restaurar(Checkpoint* ck, Lista* formas, Lista* segmentos, long* offset_qry, long* offset_txt, int* id_segmento, int* id_clone);
+
+// ----------------------
+// REGISTRAR ALTERAÇÕES
+// ----------------------
+
+/* -> checkpoint_registrar_destruicao
+    FUNÇÃO: registra que uma forma foi destruída
+    RECEBE: o checkpoint e o id da forma
+ */
+void checkpoint_registrar_destruicao(Checkpoint* ck, int id);
+
+/* -> checkpoint_registrar_pintura
+    FUNÇÃO: registra que uma forma foi pintada
+    RECEBE: o checkpoint, o id da forma e a nova cor
+ */
+void checkpoint_registrar_pintura(Checkpoint* ck, int id, const char* cor);
+
+/* -> checkpoint_registrar_clone
+    FUNÇÃO: registra que uma forma foi clonada
+    RECEBE: o checkpoint, o id original, o id do clone e o deslocamento
+ */
+void checkpoint_registrar_clone(Checkpoint* ck, int id_original, int id_clone, double dx, double dy);
+
+/* -> checkpoint_registrar_segmento
+    FUNÇÃO: registra um novo anteparo
+    RECEBE: o checkpoint e o segmento
+ */
+void checkpoint_registrar_segmento(Checkpoint* ck, Segmento* s);
+
+/* -> checkpoint_marcar
+    FUNÇÃO: grava as alterações pendentes e um marco de retomada
+    RECEBE: o checkpoint, a posição no .qry logo após o último comando
+    processado, o tamanho do relatório até ali (já gravado no disco) e os
+    próximos ids de segmento e de clone
+ */
+void checkpoint_marcar(Checkpoint* ck, long offset_qry, long offset_txt, int id_segmento, int id_clone);
+
+// ----------------------
+// RELATÓRIO
+// ----------------------
+
+/* -> checkpoint_cortar_relatorio
+    FUNÇÃO: descarta o que o relatório ganhou depois do último marco, para que
+    a execução retomada não repita linhas, e continua escrevendo dali
+    RECEBE: o relatório (aberto para escrita) e o tamanho guardado no marco
+    RETORNA: verdadeiro se o relatório foi cortado
+ */
+bool checkpoint_cortar_relatorio(FILE* txt, long tamanho);
+
+#endif
@@ -1,13 +1,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h> 
+#include <stdint.h>
 #include <math.h>
 
 #include "formas.h"
 
-#define MAX_COR_LEN 8
-#define MAX_TEXTO_LEN 50
 #define MAX_ANCORA_LEN 10 
+#define TAM_LINHA_CACHE 64
+#define FORMAS_POR_BLOCO 256
+#define SEM_TEXTO UINT32_MAX
 
 #ifndef M_PI
     #define M_PI 3.14159265358979323846
@@ -30,43 +32,220 @@ static char* duplicar_string(const char* s) {
 }
 
 // DEFINIÇÃO DA STRUCT FORMA
+// ----------------------------------------------
+// só o que as varreduras das bombas leem: cabe
+// em 64 bytes e vem de blocos alinhados, então
+// cada forma ocupa exatamente uma linha de cache.
+// conteúdo e âncora dos textos ficam na tabela
+// de textos, fora do registro.
+// v[]: círculo (x, y, raio), retângulo (x, y, largura, altura),
+//      linha (x1, y1, x2, y2), texto (x, y)
+// ----------------------------------------------
 struct forma {
+    double v[4];
+    float caixa[4];           // min_x, min_y, max_x, max_y (arredondada para fora)
     int id;
+    IdCor cor_borda;
+    IdCor cor_preenchimento;
+    uint32_t texto;           // índice na tabela de textos (SEM_TEXTO se não for texto)
     char tipo;
-    double dx;
-    double dy;
+};
 
-    union {
-    // RETANGULO
-    struct {double x, y, largura, altura; } r;
+// falha na compilação se o registro deixar de caber numa linha de cache
+typedef char forma_cabe_na_linha[(sizeof(struct forma) <= TAM_LINHA_CACHE) ? 1 : -1];
+
+// DADOS FRIOS DE UM TEXTO
+typedef struct {
+    char* conteudo;
+    size_t comprimento;
+    char ancora[MAX_ANCORA_LEN];
+    uint32_t proximo_livre;
+} DadosTexto;
+
+// -------------------------------------
+// ALOCAÇÃO DOS REGISTROS E DOS TEXTOS
+// -------------------------------------
+
+// blocos de registros alinhados e lista de registros livres
+static void** blocos = NULL;
+static int n_blocos = 0;
+static Forma* formas_livres = NULL;
+static int formas_vivas = 0;
+
+// tabela de textos (os índices livres formam uma lista)
+static DadosTexto* textos = NULL;
+static uint32_t n_textos = 0;
+static uint32_t cap_textos = 0;
+static uint32_t texto_livre = SEM_TEXTO;
+
+// LIBERAR_ARMAZENAMENTO (chamada quando a última forma é destruída)
+static void liberar_armazenamento(void) {
+    for (int i = 0; i < n_blocos; i++) free(blocos[i]);
+    free(blocos);
+    blocos = NULL;
+    n_blocos = 0;
+    formas_livres = NULL;
+
+    free(textos);
+    textos = NULL;
+    n_textos = cap_textos = 0;
+    texto_livre = SEM_TEXTO;
+}
+
+// NOVO_BLOCO
+static bool novo_bloco(void) {
+    void** novos = (void**) realloc(blocos, (n_blocos + 1) * sizeof(void*));
+    if (novos == NULL) return false;
+    blocos = novos;
+
+    char* memoria = (char*) malloc(FORMAS_POR_BLOCO * sizeof(Forma) + TAM_LINHA_CACHE);
+    if (memoria == NULL) return false;
+    blocos[n_blocos++] = memoria;
+
+    // alinha o começo do bloco a uma linha de cache
+    uintptr_t endereco = (uintptr_t) memoria;
+    Forma* registros = (Forma*) (memoria + (TAM_LINHA_CACHE - endereco % TAM_LINHA_CACHE) % TAM_LINHA_CACHE);
+
+    for (int i = FORMAS_POR_BLOCO - 1; i >= 0; i--) {
+        *(Forma**) &registros[i] = formas_livres;
+        formas_livres = &registros[i];
+    }
+    return true;
+}
 
-    // CIRCULO
-    struct {double x, y, raio; } c;
+// ALOCAR_FORMA
+static Forma* alocar_forma(int id, char tipo) {
+    if (formas_livres == NULL && !novo_bloco()) return NULL;
 
-    // LINHA
-    struct {double x1, y1, x2, y2; } l;
+    Forma* f = formas_livres;
+    formas_livres = *(Forma**) f;
+    formas_vivas++;
 
-    // TEXTO
-    struct {char ancora_tipo[MAX_ANCORA_LEN]; double x, y; char* texto_ptr; } t;
-    } dados;
+    memset(f, 0, sizeof(Forma));
+    f->id = id;
+    f->tipo = tipo;
+    f->texto = SEM_TEXTO;
+    return f;
+}
 
-    char cor_borda[MAX_COR_LEN];
-    char cor_preenchimento[MAX_COR_LEN];
-    int esmagada;
-};
+// LIBERAR_REGISTRO
+static void liberar_registro(Forma* f) {
+    *(Forma**) f = formas_livres;
+    formas_livres = f;
+
+    if (--formas_vivas == 0) liberar_armazenamento();
+}
+
+// NOVO_TEXTO
+static uint32_t novo_texto(const char* conteudo, const char* ancora) {
+    uint32_t i;
+
+    // conteudo e ancora podem apontar para dentro da própria tabela (clonagem),
+    // então são copiados antes que o realloc possa movê-la
+    char copia_ancora[MAX_ANCORA_LEN];
+    strncpy(copia_ancora, ancora, MAX_ANCORA_LEN - 1);
+    copia_ancora[MAX_ANCORA_LEN - 1] = '\0';
+    char* copia_conteudo = duplicar_string(conteudo ? conteudo : "");
+
+    if (texto_livre != SEM_TEXTO) {
+        i = texto_livre;
+        texto_livre = textos[i].proximo_livre;
+    } 
+    else {
+        if (n_textos == cap_textos) {
+            uint32_t nova_cap = cap_textos ? cap_textos * 2 : 64;
+            DadosTexto* novo = (DadosTexto*) realloc(textos, nova_cap * sizeof(DadosTexto));
+            if (novo == NULL) {
+                free(copia_conteudo);
+                return SEM_TEXTO;
+            }
+            textos = novo;
+            cap_textos = nova_cap;
+        }
+        i = n_textos++;
+    }
 
-// INICIALIZAR_FORMA_COMUM
-static void inicializar_forma_comum(Forma* f, const char* cor_borda, const char* cor_preenchimento) {
-    f->dx = 0.0;
-    f->dy = 0.0;
+    DadosTexto* t = &textos[i];
+    t->conteudo = copia_conteudo;
+    t->comprimento = t->conteudo ? strlen(t->conteudo) : 0;
+    memcpy(t->ancora, copia_ancora, MAX_ANCORA_LEN);
+    t->proximo_livre = SEM_TEXTO;
+    return i;
+}
+
+// LIBERAR_TEXTO
+static void liberar_texto(uint32_t i) {
+    if (i == SEM_TEXTO) return;
+
+    free(textos[i].conteudo);
+    textos[i].conteudo = NULL;
+    textos[i].proximo_livre = texto_livre;
+    texto_livre = i;
+}
+
+// ---------------------------
+// RETÂNGULO ENVOLVENTE
+// ---------------------------
+
+// CAIXA_DO_TEXTO
+static void caixa_do_texto(double x, double y, const DadosTexto* t, double* min_x, double* min_y, double* largura, double* altura) {
+    *altura = 10.0; 
     
-    strncpy(f->cor_borda, cor_borda, MAX_COR_LEN - 1); 
-    f->cor_borda[MAX_COR_LEN - 1] = '\0'; 
+    double largura_caractere_media = 6.0; 
+    *largura = largura_caractere_media * t->comprimento;
+
+    *min_x = x; 
+    *min_y = y - *altura; 
+
+    char ancora = t->ancora[0];
+    
+    if (ancora == 'm') {
+        *min_x = *min_x - (*largura / 2.0);
+    } else if (ancora == 'e' || ancora == 'f') {
+        *min_x = *min_x - *largura;
+    }
+}
 
-    strncpy(f->cor_preenchimento, cor_preenchimento, MAX_COR_LEN - 1);
-    f->cor_preenchimento[MAX_COR_LEN - 1] = '\0';
+// ATUALIZAR_CAIXA
+// a caixa fica em float; os cantos são arredondados para fora para nunca
+// ficar menor do que a forma
+static void atualizar_caixa(Forma* f) {
+    double min_x = 0, min_y = 0, max_x = 0, max_y = 0;
 
-    f->esmagada = 0;
+    switch (f->tipo) {
+        case 'c':
+            min_x = f->v[0] - f->v[2]; max_x = f->v[0] + f->v[2];
+            min_y = f->v[1] - f->v[2]; max_y = f->v[1] + f->v[2];
+            break;
+        case 'r':
+            min_x = fmin(f->v[0], f->v[0] + f->v[2]); max_x = fmax(f->v[0], f->v[0] + f->v[2]);
+            min_y = fmin(f->v[1], f->v[1] + f->v[3]); max_y = fmax(f->v[1], f->v[1] + f->v[3]);
+            break;
+        case 'l':
+            min_x = fmin(f->v[0], f->v[2]); max_x = fmax(f->v[0], f->v[2]);
+            min_y = fmin(f->v[1], f->v[3]); max_y = fmax(f->v[1], f->v[3]);
+            break;
+        case 't': {
+            double w, h;
+            if (f->texto == SEM_TEXTO) break;
+            caixa_do_texto(f->v[0], f->v[1], &textos[f->texto], &min_x, &min_y, &w, &h);
+            max_x = min_x + w;
+            max_y = min_y + h;
+            break;
+        }
+    }
+
+    f->caixa[0] = (float) min_x; if (f->caixa[0] > min_x) f->caixa[0] = nextafterf(f->caixa[0], -INFINITY);
+    f->caixa[1] = (float) min_y; if (f->caixa[1] > min_y) f->caixa[1] = nextafterf(f->caixa[1], -INFINITY);
+    f->caixa[2] = (float) max_x; if (f->caixa[2] < max_x) f->caixa[2] = nextafterf(f->caixa[2], INFINITY);
+    f->caixa[3] = (float) max_y; if (f->caixa[3] < max_y) f->caixa[3] = nextafterf(f->caixa[3], INFINITY);
+}
+
+// INICIALIZAR_FORMA_COMUM
+static void inicializar_forma_comum(Forma* f, const char* cor_borda, const char* cor_preenchimento) {
+    f->cor_borda = paleta_internar(cor_borda);
+    f->cor_preenchimento = paleta_internar(cor_preenchimento);
+    atualizar_caixa(f);
 }
 
 // =================================
@@ -75,15 +254,13 @@ static void inicializar_forma_comum(Forma* f, const char* cor_borda, const char*
 
 // CRIAR_RETÂNGULO
 Forma* criar_retangulo(int id, double x, double y, double largura, double altura, const char* cor_borda, const char* cor_preenchimento) {
-    Forma* f = (Forma*) malloc(sizeof(Forma));
+    Forma* f = alocar_forma(id, 'r');
     if (f == NULL) return NULL; 
 
-    f->id = id;
-    f->tipo = 'r';
-    f->dados.r.x = x;
-    f->dados.r.y = y;
-    f->dados.r.largura = largura;
-    f->dados.r.altura = altura;
+    f->v[0] = x;
+    f->v[1] = y;
+    f->v[2] = largura;
+    f->v[3] = altura;
     
     inicializar_forma_comum(f, cor_borda, cor_preenchimento);
     return f;
@@ -92,14 +269,12 @@ Forma* criar_retangulo(int id, double x, double y, double largura, double altura
 
 // CRIAR_CÍRCULO
 Forma* criar_circulo(int id, double x, double y, double raio, const char* cor_borda, const char* cor_preenchimento) {
-    Forma* f = (Forma*) malloc(sizeof(Forma));
+    Forma* f = alocar_forma(id, 'c');
     if (f == NULL) return NULL; 
 
-    f->id = id;
-    f->tipo = 'c';
-    f->dados.c.x = x;
-    f->dados.c.y = y;
-    f->dados.c.raio = raio;
+    f->v[0] = x;
+    f->v[1] = y;
+    f->v[2] = raio;
 
     inicializar_forma_comum(f, cor_borda, cor_preenchimento);
     return f;
@@ -108,16 +283,13 @@ Forma* criar_circulo(int id, double x, double y, double raio, const char* cor_bo
 // CRIAR_LINHA
 Forma* criar_linha(int id, double x1, double y1, double x2, double y2, const char* cor) { 
     
-    Forma* f = (Forma*) malloc(sizeof(Forma));
+    Forma* f = alocar_forma(id, 'l');
     if (f == NULL) return NULL;
 
-    f->id = id;
-    f->tipo = 'l';
-    
-    f->dados.l.x1 = x1;
-    f->dados.l.y1 = y1;
-    f->dados.l.x2 = x2;
-    f->dados.l.y2 = y2;
+    f->v[0] = x1;
+    f->v[1] = y1;
+    f->v[2] = x2;
+    f->v[3] = y2;
     
     inicializar_forma_comum(f, cor, "#FFFFFF"); 
     return f;
@@ -127,19 +299,17 @@ Forma* criar_linha(int id, double x1, double y1, double x2, double y2, const cha
 Forma* criar_texto(int id, double x, double y, const char* texto_conteudo, const char* ancora,
                    const char* cor_borda, const char* cor_preenchimento) {
     
-    Forma* f = (Forma*) malloc(sizeof(Forma));
+    Forma* f = alocar_forma(id, 't');
     if (f == NULL) return NULL;
 
-    f->id = id;
-    f->tipo = 't'; 
-    
-    f->dados.t.x = x;
-    f->dados.t.y = y;
-
-    f->dados.t.texto_ptr = duplicar_string(texto_conteudo); 
+    f->v[0] = x;
+    f->v[1] = y;
 
-    strncpy(f->dados.t.ancora_tipo, ancora, MAX_ANCORA_LEN - 1); 
-    f->dados.t.ancora_tipo[MAX_ANCORA_LEN - 1] = '\0';
+    f->texto = novo_texto(texto_conteudo, ancora);
+    if (f->texto == SEM_TEXTO) {
+        liberar_registro(f);
+        return NULL;
+    }
 
     inicializar_forma_comum(f, cor_borda, cor_preenchimento);
     return f;
@@ -158,53 +328,34 @@ char forma_get_tipo(Forma* forma) { return forma->tipo; }
 // FORMA_GET_X 
 double forma_get_x(Forma* f) {
     if (f == NULL) return 0;
-    switch (f->tipo) {
-        case 'c': return f->dados.c.x;
-        case 'r': return f->dados.r.x;
-        case 't': return f->dados.t.x; 
-        case 'l': return f->dados.l.x1; 
-    }
-    return 0;
+    return f->v[0];
 }
 
 // FORMA_GET_Y 
 double forma_get_y(Forma* f) {
     if (f == NULL) return 0;
-    switch (f->tipo) {
-        case 'c': return f->dados.c.y;
-        case 'r': return f->dados.r.y;
-        case 't': return f->dados.t.y; 
-        case 'l': return f->dados.l.y1; 
-    }
-    return 0;
+    return f->v[1];
 }
 
 // FORMA_GET_POSICAO
 void forma_get_posicao(Forma* f, double* x, double* y) {
     if (f == NULL) { *x = 0; *y = 0; return; }
     
-    switch (f->tipo) {
-        case 'c': *x = f->dados.c.x; *y = f->dados.c.y; break;
-        case 'r': *x = f->dados.r.x; *y = f->dados.r.y; break;
-        case 'l': *x = f->dados.l.x1; *y = f->dados.l.y1; break;
-        case 't': *x = f->dados.t.x; *y = f->dados.t.y; break;
-        default: *x = 0; *y = 0;
-    }
+    *x = f->v[0];
+    *y = f->v[1];
 }
 
-// FORMA_GET_VETOR
-void forma_get_vetor(Forma* f, double* dx, double* dy) {
-    if (f) { *dx = f->dx; *dy = f->dy; } else { *dx = 0; *dy = 0; }
-}
-
-// FORMA_GET_ESMAGADA
-int forma_get_esmagada(Forma* f) { return f ? f->esmagada : 0; }
-
 // FORMA_GET_COR_BORDA
-const char* forma_get_cor_borda(Forma* f) { return f->cor_borda; }
+const char* forma_get_cor_borda(Forma* f) { return paleta_cor(f->cor_borda); }
 
 // FORMA_GET_COR_PREENCHIMENTO
-const char* forma_get_cor_preenchimento(Forma* f) { return f->cor_preenchimento; }
+const char* forma_get_cor_preenchimento(Forma* f) { return paleta_cor(f->cor_preenchimento); }
+
+// FORMA_GET_ID_COR_BORDA
+IdCor forma_get_id_cor_borda(Forma* f) { return f->cor_borda; }
+
+// FORMA_GET_ID_COR_PREENCHIMENTO
+IdCor forma_get_id_cor_preenchimento(Forma* f) { return f->cor_preenchimento; }
 
 // GET_COR_GANHADORA
 const char* get_cor_ganhadora(Forma* f_I, char* temp_complementar_buffer) {
@@ -219,85 +370,85 @@ const char* get_cor_ganhadora(Forma* f_I, char* temp_complementar_buffer) {
 // FORMA_GET_R (para circulo)
 double forma_get_r(Forma* f) { 
     if (f == NULL || f->tipo != 'c') return 0;
-    return f->dados.c.raio;
+    return f->v[2];
 }
 
 // FORMA_GET_W (para retangulo)
 double forma_get_w(Forma* f) {
     if (f == NULL || f->tipo != 'r') return 0;
-    return f->dados.r.largura;
+    return f->v[2];
 }
 
 // FORMA_GET_H (para retangulo)
 double forma_get_h(Forma* f) {
     if (f == NULL || f->tipo != 'r') return 0;
-    return f->dados.r.altura;
+    return f->v[3];
 }
 
 // FORMA_GET_X1 (para linha)
 double forma_get_x1(Forma* f) {
     if (f == NULL || f->tipo != 'l') return 0;
-    return f->dados.l.x1;
+    return f->v[0];
 }
 
 // FORMA_GET_Y1 (para linha)
 double forma_get_y1(Forma* f) {
     if (f == NULL || f->tipo != 'l') return 0;
-    return f->dados.l.y1;
+    return f->v[1];
 }
 
 // FORMA_GET_X2 (para linha)
 double forma_get_x2(Forma* f) {
     if (f == NULL || f->tipo != 'l') return 0;
-    return f->dados.l.x2;
+    return f->v[2];
 }
 
 // FORMA_GET_Y2 (para linha)
 double forma_get_y2(Forma* f) {
     if (f == NULL || f->tipo != 'l') return 0;
-    return f->dados.l.y2;
+    return f->v[3];
 }
 
 // FORMA_GET_TEXTO 
 const char* forma_get_texto(Forma* f) {
-    if (f == NULL || f->tipo != 't' || f->dados.t.texto_ptr == NULL) return "";
-    return f->dados.t.texto_ptr;
+    if (f == NULL || f->tipo != 't' || textos[f->texto].conteudo == NULL) return "";
+    return textos[f->texto].conteudo;
 }
 
 // FORMA_GET_ANCORA
 const char* forma_get_ancora(Forma* f) {
     if (f == NULL || f->tipo != 't') return "start";
-    return f->dados.t.ancora_tipo;
+    return textos[f->texto].ancora;
 }
 
 // FORMA_GET_RETANGULO_DADOS
 void forma_get_retangulo_dados(Forma* f, double* x, double* y, double* largura, double* altura) {
     if (f && f->tipo == 'r') {
-        *x = f->dados.r.x; *y = f->dados.r.y; *largura = f->dados.r.largura; *altura = f->dados.r.altura;
+        *x = f->v[0]; *y = f->v[1]; *largura = f->v[2]; *altura = f->v[3];
     }
 }
 
 // FORMA_GET_CIRCULO_DADOS
 void forma_get_circulo_dados(Forma* f, double* x, double* y, double* raio) {
     if (f && f->tipo == 'c') {
-        *x = f->dados.c.x; *y = f->dados.c.y; *raio = f->dados.c.raio;
+        *x = f->v[0]; *y = f->v[1]; *raio = f->v[2];
     }
 }
 
 // FORMA_GET_LINHA_DADOS
 void forma_get_linha_dados(Forma* f, double* x1, double* y1, double* x2, double* y2) {
     if (f && f->tipo == 'l') {
-        *x1 = f->dados.l.x1; *y1 = f->dados.l.y1; *x2 = f->dados.l.x2; *y2 = f->dados.l.y2;
+        *x1 = f->v[0]; *y1 = f->v[1]; *x2 = f->v[2]; *y2 = f->v[3];
     }
 }
 
 // FORMA_GET_TEXTO_DADOS 
 void forma_get_texto_dados(Forma* f, double* x, double* y, char* ancora_char, const char** texto) {
     if (f && f->tipo == 't') { 
-        *x = f->dados.t.x;
-        *y = f->dados.t.y;
-        *ancora_char = f->dados.t.ancora_tipo[0]; 
-        *texto = f->dados.t.texto_ptr;
+        *x = f->v[0];
+        *y = f->v[1];
+        *ancora_char = textos[f->texto].ancora[0]; 
+        *texto = textos[f->texto].conteudo;
     }
 }
 
@@ -308,23 +459,24 @@ void forma_get_texto_bbox(Forma* f, double* x, double* y, double* largura, doubl
         return;
     }
 
-    *altura = 10.0; 
-    
-    double largura_caractere_media = 6.0; 
-    *largura = largura_caractere_media * strlen(f->dados.t.texto_ptr);
-
-    *x = f->dados.t.x; 
-    *y = f->dados.t.y;
-        
-    *y = *y - *altura; 
+    caixa_do_texto(f->v[0], f->v[1], &textos[f->texto], x, y, largura, altura);
+}
 
-    char ancora = f->dados.t.ancora_tipo[0];
-    
-    if (ancora == 'm') {
-        *x = *x - (*largura / 2.0);
-    } else if (ancora == 'e' || ancora == 'f') {
-        *x = *x - *largura;
+// FORMA_GET_BBOX
+void forma_get_bbox(Forma* f, double* min_x, double* min_y, double* max_x, double* max_y) {
+    if (f == NULL) {
+        *min_x = *min_y = *max_x = *max_y = 0.0;
+        return;
     }
+
+    *min_x = f->caixa[0]; *min_y = f->caixa[1];
+    *max_x = f->caixa[2]; *max_y = f->caixa[3];
+}
+
+// FORMA_CAIXA_INTERSECTA
+bool forma_caixa_intersecta(Forma* f, double min_x, double min_y, double max_x, double max_y) {
+    return f->caixa[0] <= max_x && f->caixa[2] >= min_x && 
+           f->caixa[1] <= max_y && f->caixa[3] >= min_y;
 }
 
 // COR_COMPLEMENTAR
@@ -349,17 +501,17 @@ double forma_calcular_area(Forma* forma) {
 
     switch (forma->tipo) {
         case 'r':
-            return forma->dados.r.largura * forma->dados.r.altura;
+            return forma->v[2] * forma->v[3];
         case 'c':
-            return M_PI * forma->dados.c.raio * forma->dados.c.raio;
+            return M_PI * forma->v[2] * forma->v[2];
         case 'l': {
-            double dx = forma->dados.l.x2 - forma->dados.l.x1;
-            double dy = forma->dados.l.y2 - forma->dados.l.y1;
+            double dx = forma->v[2] - forma->v[0];
+            double dy = forma->v[3] - forma->v[1];
             double comprimento = sqrt(dx * dx + dy * dy);
             return 2 * comprimento;
         }
         case 't': { 
-            return 20.0 * strlen(forma->dados.t.texto_ptr);
+            return 20.0 * textos[forma->texto].comprimento;
         }
         default:
             return 0.0;
@@ -371,44 +523,31 @@ double forma_calcular_area(Forma* forma) {
 void destruir_forma(Forma* forma) {
     if (forma == NULL) return;
 
-    if (forma->tipo == 't' && forma->dados.t.texto_ptr != NULL) {
-        free(forma->dados.t.texto_ptr);
-    }
-
-    free(forma);
+    liberar_texto(forma->texto);
+    liberar_registro(forma);
 }
 
 // FORMA_CLONAR
 Forma* forma_clonar(Forma* f, int nova_id) {
     if (f == NULL) return NULL;
 
-    Forma* clone = NULL;
+    Forma* clone = alocar_forma(nova_id, f->tipo);
+    if (clone == NULL) return NULL;
 
-    switch(f->tipo) {
-        case 'c':
-            clone = criar_circulo(nova_id, f->dados.c.x, f->dados.c.y, f->dados.c.raio, f->cor_borda, f->cor_preenchimento);
-            break;
-        case 'r':
-            clone = criar_retangulo(nova_id, f->dados.r.x, f->dados.r.y, f->dados.r.largura, f->dados.r.altura, f->cor_borda, f->cor_preenchimento);
-            break;
-        case 'l':
-            clone = criar_linha(nova_id, 
-                f->dados.l.x1, f->dados.l.y1, 
-                f->dados.l.x2, f->dados.l.y2, 
-                f->cor_borda); 
-            break;
-        case 't':
-            clone = criar_texto(nova_id, 
-                f->dados.t.x, f->dados.t.y, 
-                f->dados.t.texto_ptr, f->dados.t.ancora_tipo, 
-                f->cor_borda, f->cor_preenchimento);
-            break;
-    }
+    // o registro é copiado inteiro; só o texto precisa de uma entrada nova
+    *clone = *f;
+    clone->id = nova_id;
 
-    if (clone != NULL) {
-        clone->dx = f->dx; clone->dy = f->dy;
-        clone->esmagada = f->esmagada;
+    if (f->tipo == 't') {
+        clone->texto = novo_texto(textos[f->texto].conteudo, textos[f->texto].ancora);
+        if (clone->texto == SEM_TEXTO) {
+            liberar_registro(clone);
+            return NULL;
+        }
     }
+
+    // linhas não herdam o preenchimento (como se fossem recriadas)
+    if (f->tipo == 'l') clone->cor_preenchimento = paleta_internar("#FFFFFF");
     
     return clone;
 }
@@ -417,70 +556,50 @@ Forma* forma_clonar(Forma* f, int nova_id) {
 void forma_mover(Forma* f, double dx, double dy) {
     if (f == NULL) return;
 
-    switch (f->tipo) {
-        case 'c': f->dados.c.x += dx; f->dados.c.y += dy; break;
-        case 'r': f->dados.r.x += dx; f->dados.r.y += dy; break;
-        case 'l':
-            f->dados.l.x1 += dx; f->dados.l.y1 += dy;
-            f->dados.l.x2 += dx; f->dados.l.y2 += dy; break;
-        case 't': f->dados.t.x += dx; f->dados.t.y += dy; break; 
-    }
+    f->v[0] += dx; f->v[1] += dy;
+    if (f->tipo == 'l') { f->v[2] += dx; f->v[3] += dy; }
+
+    atualizar_caixa(f);
 }
 
 // FORMA_SET_POSICAO 
 void forma_set_posicao(Forma* f, double x, double y) {
     if (f == NULL) return;
 
-    switch (f->tipo) {
-        case 'c': f->dados.c.x = x; f->dados.c.y = y; break;
-        case 'r': f->dados.r.x = x; f->dados.r.y = y; break;
-        case 'l': {
-            double dx = f->dados.l.x2 - f->dados.l.x1;
-            double dy = f->dados.l.y2 - f->dados.l.y1;
-            f->dados.l.x1 = x; f->dados.l.y1 = y;
-            f->dados.l.x2 = x + dx; f->dados.l.y2 = y + dy;
-            break;
-        }
-        case 't': f->dados.t.x = x; f->dados.t.y = y; break;
+    if (f->tipo == 'l') {
+        f->v[2] = x + (f->v[2] - f->v[0]);
+        f->v[3] = y + (f->v[3] - f->v[1]);
     }
-}
-
-// FORMA_SET_VETOR
-void forma_set_vetor(Forma* f, double dx, double dy) { if (f) { f->dx = dx; f->dy = dy; } }
+    f->v[0] = x; f->v[1] = y;
 
-// FORMA_SET_ESMAGADA
-void forma_set_esmagada(Forma* f, int valor) { if (f) f->esmagada = valor; }
+    atualizar_caixa(f);
+}
 
 // FORMA_SET_COR_BORDA 
 void forma_set_cor_borda(Forma* f, const char* nova_cor) {
     if (f == NULL) return;
-    strncpy(f->cor_borda, nova_cor, MAX_COR_LEN - 1);
-    f->cor_borda[MAX_COR_LEN - 1] = '\0';
+    f->cor_borda = paleta_internar(nova_cor);
 } 
 
 // FORMA_SET_COR_PREENCHIMENTO
 void forma_set_cor_preenchimento(Forma* f, const char* nova_cor) {
     if (f == NULL) return;
-    strncpy(f->cor_preenchimento, nova_cor, MAX_COR_LEN - 1);
-    f->cor_preenchimento[MAX_COR_LEN - 1] = '\0';
+    f->cor_preenchimento = paleta_internar(nova_cor);
 }
 
+// FORMA_SET_ID_COR_BORDA
+void forma_set_id_cor_borda(Forma* f, IdCor nova_cor) { if (f) f->cor_borda = nova_cor; }
+
+// FORMA_SET_ID_COR_PREENCHIMENTO
+void forma_set_id_cor_preenchimento(Forma* f, IdCor nova_cor) { if (f) f->cor_preenchimento = nova_cor; }
+
 // FORMA_TROCAR_CORES
 void forma_trocar_cores(Forma* forma) {
     if (forma == NULL) return;
     
-    const char* cor_atual_preenchimento = forma_get_cor_preenchimento(forma);
-    const char* cor_atual_borda = forma_get_cor_borda(forma);
-    
-    char temp_cor_preenchimento[MAX_COR_LEN]; 
-    char temp_cor_borda[MAX_COR_LEN];
-
-    strcpy(temp_cor_preenchimento, cor_atual_preenchimento);
-    strcpy(temp_cor_borda, cor_atual_borda);
-
-    forma_set_cor_preenchimento(forma, temp_cor_borda);
-    forma_set_cor_borda(forma, temp_cor_preenchimento);
-    
+    IdCor temp = forma->cor_borda;
+    forma->cor_borda = forma->cor_preenchimento;
+    forma->cor_preenchimento = temp;
 }
 
 // =======================================================
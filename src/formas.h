@@ -4,6 +4,8 @@
 #include <stdio.h> 
 #include <stdbool.h>
 
+#include "paleta.h"
+
 // FORMAS UTILIZADAS NO PROJETO
 // ====================================================
 // Serão utilizadas no projeto 4 formas:
@@ -18,9 +20,6 @@
 // DECLARAÇÃO DA ESTRUTURA DA FORMA
 typedef struct forma Forma;
 
-// função auxiliar DUPLICAR_STRING
-static char* duplicar_string(const char* s);
-
 // =================================
 // FUNÇÕES DE CRIAÇÃO (CONSTRUTORES)
 // =================================
@@ -108,14 +107,6 @@ double forma_get_y(Forma* f);
 // retorna a posição atual da forma (x, y)
 void forma_get_posicao(Forma* f, double* x, double* y);
 
-// FORMA_GET_VETOR
-// retorna o vetor de deslocamento da forma (dx, dy)
-void forma_get_vetor(Forma* f, double* dx, double* dy);
-
-// FORMA_GET_ESMAGADA
-// retorna se a forma está esmagada ou não
-int forma_get_esmagada(Forma* f);
-
 // FORMA_GET_COR_BORDA
 // retorna a cor da borda de uma forma
 const char* forma_get_cor_borda(Forma* f);
@@ -124,6 +115,14 @@ const char* forma_get_cor_borda(Forma* f);
 // retorna a cor de preenchimento de uma forma
 const char* forma_get_cor_preenchimento(Forma* f);
 
+// FORMA_GET_ID_COR_BORDA
+// retorna o índice da cor da borda na paleta
+IdCor forma_get_id_cor_borda(Forma* f);
+
+// FORMA_GET_ID_COR_PREENCHIMENTO
+// retorna o índice da cor de preenchimento na paleta
+IdCor forma_get_id_cor_preenchimento(Forma* f);
+
 // GET_COR_GANHADORA
 const char* get_cor_ganhadora(Forma* f_I, char* temp_complementar_buffer);
 
@@ -184,6 +183,15 @@ void forma_get_texto_dados(Forma* f, double* x, double* y, char* ancora, const c
 // consegue o retângulo correspondente ao texto   
 void forma_get_texto_bbox(Forma* f, double* x, double* y, double* largura, double* altura);
 
+// FORMA_GET_BBOX
+// consegue o retângulo envolvente da forma (min_x, min_y, max_x, max_y),
+// guardado no registro em precisão simples e arredondado para fora
+void forma_get_bbox(Forma* f, double* min_x, double* min_y, double* max_x, double* max_y);
+
+// FORMA_CAIXA_INTERSECTA
+// verifica se o retângulo envolvente da forma toca o retângulo dado
+bool forma_caixa_intersecta(Forma* f, double min_x, double min_y, double max_x, double max_y);
+
 // COR_COMPLEMENTAR
 void cor_complementar(const char* cor_hex, char* complementar_hex);
 
@@ -215,14 +223,6 @@ void forma_mover(Forma* f, double dx, double dy);
 // define a nova posição da forma (x, y)
 void forma_set_posicao(Forma* f, double novo_x, double novo_y);
 
-// FORMA_SET_VETOR
-// define o vetor de deslocamento da forma (dx, dy)
-void forma_set_vetor(Forma* f, double dx, double dy);
-
-// FORMA_SET_ESMAGADA
-// esmaga uma forma
-void forma_set_esmagada(Forma* f, int valor);
-
 // FORMA_SET_COR_BORDA
 // define uma nova cor de borda para a forma
 void forma_set_cor_borda(Forma* f, const char* nova_cor);
@@ -231,6 +231,14 @@ void forma_set_cor_borda(Forma* f, const char* nova_cor);
 // define uma nova cor de preenchimento para a forma
 void forma_set_cor_preenchimento(Forma* f, const char* nova_cor);
 
+// FORMA_SET_ID_COR_BORDA
+// define a cor de borda a partir de um índice da paleta
+void forma_set_id_cor_borda(Forma* f, IdCor nova_cor);
+
+// FORMA_SET_ID_COR_PREENCHIMENTO
+// define a cor de preenchimento a partir de um índice da paleta
+void forma_set_id_cor_preenchimento(Forma* f, IdCor nova_cor);
+
 // FORMA_TROCAR_CORES
 // troca as cores de borda e preenchimento de uma forma
 void forma_trocar_cores(Forma* f);
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <float.h>
 #include "geometria.h"
 
 #ifndef M_PI
@@ -9,11 +10,11 @@
 
 #define EPSILON 1e-9
 
-// ESTRUTURA DO PONTO
-struct Ponto {
-    double x;
-    double y;
-};
+// metade do épsilon da máquina (2^-53) e a cota de erro do filtro da orientação
+// (Shewchuk, "Adaptive Precision Floating-Point Arithmetic and Fast Robust
+// Geometric Predicates")
+#define EPS_MAQUINA (DBL_EPSILON / 2.0)
+#define COTA_ERRO_ORIENTACAO ((3.0 + 16.0 * EPS_MAQUINA) * EPS_MAQUINA)
 
 // --------------------------------
 // FUNÇÕES DE CRIAÇÃO E DESTRUIÇÃO
@@ -35,30 +36,21 @@ void destruir_ponto(Ponto* p) {
     }
 }
 
-// ---------------
-// FUNÇÕES GETTER
-// ---------------
-
-// GET_X
-double get_x(Ponto* p) {
-    return p ? p->x : 0.0;
-}
-
-// GET_Y
-double get_y(Ponto* p) {
-    return p ? p->y : 0.0;
-}
-
 // ------------------------------
 // OPERAÇÕES MATEMÁTICAS - pontos
 // ------------------------------
 
+// DISTANCIA_PONTOS_V
+double distancia_pontos_v(Ponto p1, Ponto p2) {
+    double dx = p2.x - p1.x;
+    double dy = p2.y - p1.y;
+    return sqrt(dx * dx + dy * dy);
+}
+
 // DISTANCIA_PONTOS
 double distancia_pontos(Ponto* p1, Ponto* p2) {
     if (!p1 || !p2) return 0.0;
-    double dx = p2->x - p1->x;
-    double dy = p2->y - p1->y;
-    return sqrt(dx * dx + dy * dy);
+    return distancia_pontos_v(*p1, *p2);
 }
 
 // ANGULO_ENTRE_PONTOS
@@ -69,6 +61,36 @@ double angulo_entre_pontos(Ponto* origem, Ponto* final) {
     return atan2(dy, dx);
 }
 
+// COMPARAR_DIRECOES
+int comparar_direcoes(double dx1, double dy1, double dx2, double dy2) {
+    int metade1 = (dy1 > 0 || (dy1 == 0 && dx1 >= 0)) ? 0 : 1;
+    int metade2 = (dy2 > 0 || (dy2 == 0 && dx2 >= 0)) ? 0 : 1;
+    
+    if (metade1 != metade2) return metade1 - metade2;
+    
+    double cruz = dx1 * dy2 - dy1 * dx2;
+    if (cruz > 0) return -1;
+    if (cruz < 0) return 1;
+    return 0;
+}
+
+// COMPARAR_DIRECOES_A_PARTIR
+// o semiplano passa a ser o lado de (sx, sy): produto vetorial e escalar com ela
+int comparar_direcoes_a_partir(double sx, double sy, double dx1, double dy1, double dx2, double dy2) {
+    double lado1 = sx * dy1 - sy * dx1, frente1 = sx * dx1 + sy * dy1;
+    double lado2 = sx * dy2 - sy * dx2, frente2 = sx * dx2 + sy * dy2;
+    
+    int metade1 = (lado1 > 0 || (lado1 == 0 && frente1 >= 0)) ? 0 : 1;
+    int metade2 = (lado2 > 0 || (lado2 == 0 && frente2 >= 0)) ? 0 : 1;
+    
+    if (metade1 != metade2) return metade1 - metade2;
+    
+    double cruz = dx1 * dy2 - dy1 * dx2;
+    if (cruz > 0) return -1;
+    if (cruz < 0) return 1;
+    return 0;
+}
+
 // DETERMINANTE
 double determinante(Ponto* p1, Ponto* p2, Ponto* p3) {
     if (!p1 || !p2 || !p3) return 0.0;
@@ -76,57 +98,169 @@ double determinante(Ponto* p1, Ponto* p2, Ponto* p3) {
     return (p2->x - p1->x) * (p3->y - p1->y) - (p2->y - p1->y) * (p3->x - p1->x);
 }
 
+// -------------------------------------
+// ARITMÉTICA EXATA (expansões de doubles)
+// -------------------------------------
+// um valor exato é guardado como uma soma de doubles que não se sobrepõem,
+// do menor para o maior em magnitude; o sinal é o do último termo.
+
+// SOMA_EXATA (a + b = x + y, sem erro)
+static void soma_exata(double a, double b, double* x, double* y) {
+    *x = a + b;
+    double b_virtual = *x - a;
+    double a_virtual = *x - b_virtual;
+    *y = (a - a_virtual) + (b - b_virtual);
+}
+
+// DIFERENCA_EXATA (a - b = x + y, sem erro)
+static void diferenca_exata(double a, double b, double* x, double* y) {
+    *x = a - b;
+    double b_virtual = a - *x;
+    double a_virtual = *x + b_virtual;
+    *y = (a - a_virtual) + (b_virtual - b);
+}
+
+// PRODUTO_EXATO (a * b = x + y, sem erro)
+static void produto_exato(double a, double b, double* x, double* y) {
+    *x = a * b;
+    *y = fma(a, b, -*x);
+}
+
+// EXPANSAO_SOMAR
+// soma b à expansão e (n termos), descartando termos nulos; retorna o novo tamanho
+static int expansao_somar(double* e, int n, double b) {
+    double q = b;
+    int m = 0;
+    
+    for (int i = 0; i < n; i++) {
+        double h;
+        soma_exata(q, e[i], &q, &h);
+        if (h != 0.0) e[m++] = h;
+    }
+    
+    if (q != 0.0 || m == 0) e[m++] = q;
+    return m;
+}
+
+// ORIENTACAO_EXATA
+static double orientacao_exata(Ponto p1, Ponto p2, Ponto p3) {
+    double ax, ax_r, by, by_r, ay, ay_r, bx, bx_r;
+    diferenca_exata(p2.x, p1.x, &ax, &ax_r);
+    diferenca_exata(p3.y, p1.y, &by, &by_r);
+    diferenca_exata(p2.y, p1.y, &ay, &ay_r);
+    diferenca_exata(p3.x, p1.x, &bx, &bx_r);
+    
+    // (ax + ax_r)(by + by_r) - (ay + ay_r)(bx + bx_r), termo a termo
+    double esq[4][2] = {{ax, by}, {ax, by_r}, {ax_r, by}, {ax_r, by_r}};
+    double dir[4][2] = {{ay, bx}, {ay, bx_r}, {ay_r, bx}, {ay_r, bx_r}};
+    
+    double e[32];
+    int n = 0;
+    
+    for (int i = 0; i < 4; i++) {
+        double x, y;
+        
+        produto_exato(esq[i][0], esq[i][1], &x, &y);
+        n = expansao_somar(e, n, y);
+        n = expansao_somar(e, n, x);
+        
+        produto_exato(dir[i][0], dir[i][1], &x, &y);
+        n = expansao_somar(e, n, -y);
+        n = expansao_somar(e, n, -x);
+    }
+    
+    return e[n - 1];
+}
+
+// ORIENTACAO_V
+// filtro: o determinante em double já decide o sinal quando está longe
+// o bastante de zero; só os casos quase degenerados vão para a conta exata
+double orientacao_v(Ponto p1, Ponto p2, Ponto p3) {
+    double esq = (p2.x - p1.x) * (p3.y - p1.y);
+    double dir = (p2.y - p1.y) * (p3.x - p1.x);
+    double det = esq - dir;
+    double soma;
+    
+    if (esq > 0.0) {
+        if (dir <= 0.0) return det;
+        soma = esq + dir;
+    }
+    else if (esq < 0.0) {
+        if (dir >= 0.0) return det;
+        soma = -esq - dir;
+    }
+    else {
+        return det;
+    }
+    
+    double cota = COTA_ERRO_ORIENTACAO * soma;
+    if (det >= cota || -det >= cota) return det;
+    
+    return orientacao_exata(p1, p2, p3);
+}
+
 // ORIENTACAO
 double orientacao(Ponto* p1, Ponto* p2, Ponto* p3) {
-    return determinante(p1, p2, p3);
+    if (!p1 || !p2 || !p3) return 0.0;
+    return orientacao_v(*p1, *p2, *p3);
 }
 
 // ---------------------------------
 // OPERAÇÕES MATEMÁTICAS - segmentos
 // ---------------------------------
 
+// DENTRO_DA_CAIXA
+static bool dentro_da_caixa(Ponto* p, Ponto* s1, Ponto* s2) {
+    return p->x >= fmin(s1->x, s2->x) && p->x <= fmax(s1->x, s2->x) &&
+           p->y >= fmin(s1->y, s2->y) && p->y <= fmax(s1->y, s2->y);
+}
+
 // SEGMENTOS_INTERSECTAM
 bool segmentos_intersectam(Ponto* p1, Ponto* p2, Ponto* q1, Ponto* q2) {
     if (!p1 || !p2 || !q1 || !q2) return false;
     
-    double d1 = orientacao(q1, q2, p1);
-    double d2 = orientacao(q1, q2, p2);
-    double d3 = orientacao(p1, p2, q1);
-    double d4 = orientacao(p1, p2, q2);
+    // os sinais das orientações são exatos
+    Ponto a = *p1, b = *p2, c = *q1, d = *q2;
+    double d1 = orientacao_v(c, d, a);
+    double d2 = orientacao_v(c, d, b);
+    double d3 = orientacao_v(a, b, c);
+    double d4 = orientacao_v(a, b, d);
     
-    if (((d1 > EPSILON && d2 < -EPSILON) || (d1 < -EPSILON && d2 > EPSILON)) &&
-        ((d3 > EPSILON && d4 < -EPSILON) || (d3 < -EPSILON && d4 > EPSILON))) {
+    if (((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) &&
+        ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0))) {
         return true;
     }
     
-    // colineares
-    if (fabs(d1) < EPSILON && ponto_no_segmento(p1, q1, q2)) return true;
-    if (fabs(d2) < EPSILON && ponto_no_segmento(p2, q1, q2)) return true;
-    if (fabs(d3) < EPSILON && ponto_no_segmento(q1, p1, p2)) return true;
-    if (fabs(d4) < EPSILON && ponto_no_segmento(q2, p1, p2)) return true;
+    // colineares: basta ver se o ponto cai dentro da caixa do outro segmento
+    if (d1 == 0 && dentro_da_caixa(p1, q1, q2)) return true;
+    if (d2 == 0 && dentro_da_caixa(p2, q1, q2)) return true;
+    if (d3 == 0 && dentro_da_caixa(q1, p1, p2)) return true;
+    if (d4 == 0 && dentro_da_caixa(q2, p1, p2)) return true;
     
     return false;
 }
 
-// INTERSECAO_SEGMENTOS
-Ponto* intersecao_segmentos(Ponto* p1, Ponto* p2, Ponto* q1, Ponto* q2) {
-    if (!p1 || !p2 || !q1 || !q2) return NULL;
+// INTERSECAO_SEGMENTOS_V
+bool intersecao_segmentos_v(Ponto p1, Ponto p2, Ponto q1, Ponto q2, Ponto* saida) {
+    double denom = (p1.x - p2.x) * (q1.y - q2.y) - (p1.y - p2.y) * (q1.x - q2.x);
     
-    double x1 = p1->x, y1 = p1->y;
-    double x2 = p2->x, y2 = p2->y;
-    double x3 = q1->x, y3 = q1->y;
-    double x4 = q2->x, y4 = q2->y;
+    if (fabs(denom) < EPSILON) return false;
     
-    double denom = (x1 - x2) * (y3 - y4) - (y1 - y2) * (x3 - x4);
+    double t = ((p1.x - q1.x) * (q1.y - q2.y) - (p1.y - q1.y) * (q1.x - q2.x)) / denom;
     
-    if (fabs(denom) < EPSILON) return NULL;
-    
-    double t = ((x1 - x3) * (y3 - y4) - (y1 - y3) * (x3 - x4)) / denom;
+    saida->x = p1.x + t * (p2.x - p1.x);
+    saida->y = p1.y + t * (p2.y - p1.y);
+    return true;
+}
+
+// INTERSECAO_SEGMENTOS
+Ponto* intersecao_segmentos(Ponto* p1, Ponto* p2, Ponto* q1, Ponto* q2) {
+    if (!p1 || !p2 || !q1 || !q2) return NULL;
     
-    double ix = x1 + t * (x2 - x1);
-    double iy = y1 + t * (y2 - y1);
+    Ponto i;
+    if (!intersecao_segmentos_v(*p1, *p2, *q1, *q2, &i)) return NULL;
     
-    return criar_ponto(ix, iy);
+    return criar_ponto(i.x, i.y);
 }
 
 // DISTANCIA_PONTO_SEGMENTO
@@ -159,66 +293,5 @@ double distancia_ponto_segmento(Ponto* p, Ponto* s1, Ponto* s2) {
 bool ponto_no_segmento(Ponto* p, Ponto* s1, Ponto* s2) {
     if (!p || !s1 || !s2) return false;
     
-    double min_x = fmin(s1->x, s2->x);
-    double max_x = fmax(s1->x, s2->x);
-    double min_y = fmin(s1->y, s2->y);
-    double max_y = fmax(s1->y, s2->y);
-    
-    return (p->x >= min_x - EPSILON && p->x <= max_x + EPSILON && p->y >= min_y - EPSILON && p->y <= max_y + EPSILON &&
-    fabs(orientacao(s1, s2, p)) < EPSILON);
-}
-
-// ---------------------------------
-// OPERAÇÕES MATEMÁTICAS - polígonos
-// ---------------------------------
-
-// PONTO_EM_POLIGONO
-bool ponto_em_poligono(Ponto* p, Ponto** vertices, int n) {
-    if (!p || !vertices || n < 3) return false;
-    
-    bool dentro = false;
-    Ponto* p1 = vertices[0];
-    
-    for (int i = 1; i <= n; i++) {
-        Ponto* p2 = vertices[i % n];
-        
-        if (p->y > fmin(p1->y, p2->y)) {
-            if (p->y <= fmax(p1->y, p2->y)) {
-                if (p->x <= fmax(p1->x, p2->x)) {
-                    double x_intersecao;
-                    
-                    if (fabs(p1->y - p2->y) > EPSILON) {
-                        x_intersecao = (p->y - p1->y) * (p2->x - p1->x) / (p2->y - p1->y) + p1->x;
-                    } 
-                    else {
-                        x_intersecao = p1->x;
-                    }
-                    
-                    if (fabs(p1->x - p2->x) < EPSILON || p->x <= x_intersecao) {
-                        dentro = !dentro;
-                    }
-                }
-            }
-        }
-        p1 = p2;
-    }
-    
-    return dentro;
-}
-
-// SEGMENTO_INTERSECTA_POLIGONO
-bool segmento_intersecta_poligono(Ponto* p1, Ponto* p2, Ponto** vertices, int n) {
-    if (!p1 || !p2 || !vertices || n < 3) return false;
-    
-    if (ponto_em_poligono(p1, vertices, n) || ponto_em_poligono(p2, vertices, n)) {
-        return true;
-    }
-    
-    for (int i = 0; i < n; i++) {
-        if (segmentos_intersectam(p1, p2, vertices[i], vertices[(i + 1) % n])) {
-            return true;
-        }
-    }
-    
-    return false;
+    return dentro_da_caixa(p, s1, s2) && orientacao(s1, s2, p) == 0;
 }
\ No newline at end of file
@@ -10,7 +10,13 @@
 // ===========================================
 
 // ESTRUTURA DO PONTO NO PLANO CARTESIANO
-typedef struct Ponto Ponto;
+// a estrutura é exposta para que os pontos possam ser usados por valor
+// (na pilha ou em registradores) nos laços geométricos mais quentes;
+// criar_ponto continua existindo para quem guarda pontos em listas
+typedef struct Ponto {
+    double x;
+    double y;
+} Ponto;
 
 // --------------------------------
 // FUNÇÕES DE CRIAÇÃO E DESTRUIÇÃO
@@ -27,6 +33,15 @@ Ponto* criar_ponto(double x, double y);
 // recebe: o ponto que vai ser destruído
 void destruir_ponto(Ponto* p);
 
+// -> ponto_xy
+// função: monta um ponto por valor, sem alocação
+// recebe: coordenadas (x, y)
+// retorna: o ponto (x, y)
+static inline Ponto ponto_xy(double x, double y) {
+    Ponto p = {x, y};
+    return p;
+}
+
 // ---------------
 // FUNÇÕES GETTER
 // ---------------
@@ -34,14 +49,18 @@ void destruir_ponto(Ponto* p);
 // -> get_x
 // função: descobrir o x de uma coordenada
 // recebe: ponteiro para o ponto
-// retorna: x
-double get_x(Ponto* p);
+// retorna: x (0 se o ponto for NULL)
+static inline double get_x(Ponto* p) {
+    return p ? p->x : 0.0;
+}
 
 // -> get_y
 // função: descobrir o y de uma coordenada
 // recebe: ponteiro para o ponto
-// retorna: y
-double get_y(Ponto* p);
+// retorna: y (0 se o ponto for NULL)
+static inline double get_y(Ponto* p) {
+    return p ? p->y : 0.0;
+}
 
 // ------------------------------
 // OPERAÇÕES MATEMÁTICAS - pontos
@@ -53,12 +72,33 @@ double get_y(Ponto* p);
 // retorna: distância entre os pontos
 double distancia_pontos(Ponto* p1, Ponto* p2);
 
+// -> distancia_pontos_v
+// função: mesma conta de distancia_pontos, com os pontos por valor
+// recebe: dois pontos
+// retorna: distância entre os pontos
+double distancia_pontos_v(Ponto p1, Ponto p2);
+
 // -> angulo_entre_pontos
 // função: calcula o ângulo entre dois pontos
 // recebe: dois pontos
 // retorna: o ângulo (em radianos) entre os pontos
 double angulo_entre_pontos(Ponto* origem, Ponto* final);
 
+// -> comparar_direcoes
+// função: compara duas direções pelo ângulo que fazem com o eixo x (de 0 a 2pi),
+// sem trigonometria: primeiro o semiplano (y > 0, ou y = 0 com x >= 0, vem antes),
+// depois o sinal do produto vetorial
+// recebe: as duas direções (dx1, dy1) e (dx2, dy2)
+// retorna: negativo se a primeira vem antes, positivo se vem depois e 0 se são a mesma direção
+int comparar_direcoes(double dx1, double dy1, double dx2, double dy2);
+
+// -> comparar_direcoes_a_partir
+// função: como comparar_direcoes, mas com os ângulos medidos a partir da direção
+// (sx, sy) em vez do eixo x; com (1, 0) dá exatamente o mesmo resultado
+// recebe: a direção inicial e as duas direções (dx1, dy1) e (dx2, dy2)
+// retorna: negativo se a primeira vem antes, positivo se vem depois e 0 se são a mesma direção
+int comparar_direcoes_a_partir(double sx, double sy, double dx1, double dy1, double dx2, double dy2);
+
 // -> determinante
 // função: calcula o determinante para 3 pontos
 // recebe: três pontos
@@ -66,11 +106,19 @@ double angulo_entre_pontos(Ponto* origem, Ponto* final);
 double determinante(Ponto* p1, Ponto* p2, Ponto* p3);
 
 // -> orientação
-// função: calcula a orientação de 3 pontos, usada para verificar intersecção de segmentos
+// função: calcula a orientação de 3 pontos, usada para verificar intersecção de segmentos.
+// o sinal é sempre exato: um filtro em double resolve os casos comuns e só os quase
+// colineares são refeitos em aritmética exata
 // recebe: três pontos
-// retorna: a posição de p3 em relação aos outros dois pontos
+// retorna: positivo se p3 está à esquerda de p1->p2, negativo à direita e 0 se colineares
 double orientacao(Ponto* p1, Ponto* p2, Ponto* p3);
 
+// -> orientacao_v
+// função: mesma conta de orientacao, com os pontos por valor
+// recebe: três pontos
+// retorna: positivo se p3 está à esquerda de p1->p2, negativo à direita e 0 se colineares
+double orientacao_v(Ponto p1, Ponto p2, Ponto p3);
+
 // ---------------------------------
 // OPERAÇÕES MATEMÁTICAS - segmentos
 // ---------------------------------
@@ -87,6 +135,12 @@ bool segmentos_intersectam(Ponto* p1, Ponto* p2, Ponto* q1, Ponto* q2);
 // retorna: o ponto de intersecção
 Ponto* intersecao_segmentos(Ponto* p1, Ponto* p2, Ponto* q1, Ponto* q2);
 
+// -> intersecao_segmentos_v
+// função: mesma conta de intersecao_segmentos, com os pontos por valor e sem alocação
+// recebe: ponto inicial e final de cada segmento e onde guardar a intersecção
+// retorna: verdadeiro se as retas se cruzam (falso se forem paralelas)
+bool intersecao_segmentos_v(Ponto p1, Ponto p2, Ponto q1, Ponto q2, Ponto* saida);
+
 // -> distancia_ponto_segmento
 // função: descobrir a distância entre um ponto e um segmento
 // recebe: o ponto, e os pontos inicial e final do segmento
@@ -99,20 +153,4 @@ double distancia_ponto_segmento(Ponto* p, Ponto* s1, Ponto* s2);
 // retorna: verdadeiro para caso estiver ou falso caso não
 bool ponto_no_segmento(Ponto* p, Ponto* s1, Ponto* s2);
 
-// ---------------------------------
-// OPERAÇÕES MATEMÁTICAS - polígonos
-// ---------------------------------
-
-// -> ponto_em_poligono
-// função: descobrir se um ponto está no polígono
-// recebe: o ponto, array de vértices do polígono e o número de vértices
-// retorna: verdadeiro se estiver ou falso caso não
-bool ponto_em_poligono(Ponto* p, Ponto** vertices, int n);
-
-// -> segmento_intersecta_poligono
-// função: descobrir se um segmento intersecta um polígono
-// recebe: os pontos inicial e final do segmento, array de vértices do polígono e o número de vértices
-// retorna: verdadeiro se intersectar ou falso caso não
-bool segmento_intersecta_poligono(Ponto* p1, Ponto* p2, Ponto** vertices, int n);
-
 #endif
\ No newline at end of file
@@ -0,0 +1,395 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "grade.h"
+#include "lista.h"
+
+#define CAPACIDADE_INICIAL 64
+#define MAX_CELULAS_POR_ITEM 64
+
+// ESTRUTURA DE UMA ENTRADA (item indexado)
+typedef struct {
+    void* item;
+    double min_x, min_y, max_x, max_y;
+    long sequencia;
+    unsigned int marca;
+} Entrada;
+
+// ESTRUTURA DE UMA CÉLULA (lista de índices de entradas)
+typedef struct {
+    int cx, cy;
+    bool ocupada;
+    int n, cap;
+    int* entradas;
+} Celula;
+
+// ESTRUTURA DA GRADE
+struct Grade {
+    double tamanho_celula;
+
+    Celula* celulas;
+    int cap_celulas;
+    int n_celulas;
+
+    Entrada* entradas;
+    int n_entradas;
+    int cap_entradas;
+
+    int* livres;
+    int n_livres;
+    int cap_livres;
+
+    // itens que cobririam células demais ficam fora do hash
+    Celula grandes;
+
+    long proxima_sequencia;
+    unsigned int marca_atual;
+};
+
+// ===================
+// FUNÇÕES AUXILIARES
+// ===================
+
+// COORDENADA_CELULA
+static int coordenada_celula(Grade* g, double v) {
+    return (int) floor(v / g->tamanho_celula);
+}
+
+// HASH_CELULA
+static unsigned int hash_celula(int cx, int cy) {
+    return ((unsigned int) cx * 73856093u) ^ ((unsigned int) cy * 19349663u);
+}
+
+// CELULA_ADICIONAR
+static void celula_adicionar(Celula* c, int indice) {
+    if (c->n == c->cap) {
+        int nova_cap = c->cap ? c->cap * 2 : 4;
+        int* novo = (int*) realloc(c->entradas, nova_cap * sizeof(int));
+        if (novo == NULL) return;
+        c->entradas = novo;
+        c->cap = nova_cap;
+    }
+    c->entradas[c->n++] = indice;
+}
+
+// CELULA_RETIRAR
+static bool celula_retirar(Celula* c, int indice) {
+    for (int i = 0; i < c->n; i++) {
+        if (c->entradas[i] == indice) {
+            c->entradas[i] = c->entradas[--c->n];
+            return true;
+        }
+    }
+    return false;
+}
+
+// BUSCAR_CELULA (cria a célula se pedido)
+static Celula* buscar_celula(Grade* g, int cx, int cy, bool criar);
+
+// CRESCER_TABELA
+static void crescer_tabela(Grade* g) {
+    Celula* antigas = g->celulas;
+    int cap_antiga = g->cap_celulas;
+
+    int nova_cap = cap_antiga * 2;
+    Celula* novas = (Celula*) calloc(nova_cap, sizeof(Celula));
+    if (novas == NULL) return;
+
+    g->celulas = novas;
+    g->cap_celulas = nova_cap;
+
+    for (int i = 0; i < cap_antiga; i++) {
+        if (!antigas[i].ocupada) continue;
+
+        unsigned int h = hash_celula(antigas[i].cx, antigas[i].cy) & (nova_cap - 1);
+        while (novas[h].ocupada) h = (h + 1) & (nova_cap - 1);
+        novas[h] = antigas[i];
+    }
+
+    free(antigas);
+}
+
+// BUSCAR_CELULA
+static Celula* buscar_celula(Grade* g, int cx, int cy, bool criar) {
+    if (criar && (g->n_celulas + 1) * 10 > g->cap_celulas * 7) {
+        crescer_tabela(g);
+    }
+
+    unsigned int h = hash_celula(cx, cy) & (g->cap_celulas - 1);
+
+    while (g->celulas[h].ocupada) {
+        if (g->celulas[h].cx == cx && g->celulas[h].cy == cy) {
+            return &g->celulas[h];
+        }
+        h = (h + 1) & (g->cap_celulas - 1);
+    }
+
+    if (!criar) return NULL;
+
+    Celula* c = &g->celulas[h];
+    c->ocupada = true;
+    c->cx = cx;
+    c->cy = cy;
+    c->n = 0;
+    c->cap = 0;
+    c->entradas = NULL;
+    g->n_celulas++;
+
+    return c;
+}
+
+// NOVA_ENTRADA
+static int nova_entrada(Grade* g) {
+    if (g->n_livres > 0) {
+        return g->livres[--g->n_livres];
+    }
+
+    if (g->n_entradas == g->cap_entradas) {
+        int nova_cap = g->cap_entradas * 2;
+        Entrada* novo = (Entrada*) realloc(g->entradas, nova_cap * sizeof(Entrada));
+        if (novo == NULL) return -1;
+        g->entradas = novo;
+        g->cap_entradas = nova_cap;
+    }
+
+    return g->n_entradas++;
+}
+
+// LIBERAR_ENTRADA
+static void liberar_entrada(Grade* g, int indice) {
+    g->entradas[indice].item = NULL;
+
+    if (g->n_livres == g->cap_livres) {
+        int nova_cap = g->cap_livres ? g->cap_livres * 2 : 16;
+        int* novo = (int*) realloc(g->livres, nova_cap * sizeof(int));
+        if (novo == NULL) return;
+        g->livres = novo;
+        g->cap_livres = nova_cap;
+    }
+    g->livres[g->n_livres++] = indice;
+}
+
+// ITEM_GRANDE
+static bool item_grande(int cx0, int cy0, int cx1, int cy1) {
+    double n = ((double) cx1 - cx0 + 1) * ((double) cy1 - cy0 + 1);
+    return n > MAX_CELULAS_POR_ITEM;
+}
+
+// --------------------------------
+// FUNÇÕES DE CRIAÇÃO E DESTRUIÇÃO
+// --------------------------------
+
+// CRIAR_GRADE
+Grade* criar_grade(double tamanho_celula) {
+    Grade* g = (Grade*) malloc(sizeof(Grade));
+    if (g == NULL) return NULL;
+
+    g->tamanho_celula = tamanho_celula > 0 ? tamanho_celula : 1.0;
+
+    g->cap_celulas = CAPACIDADE_INICIAL;
+    g->n_celulas = 0;
+    g->celulas = (Celula*) calloc(g->cap_celulas, sizeof(Celula));
+
+    g->cap_entradas = CAPACIDADE_INICIAL;
+    g->n_entradas = 0;
+    g->entradas = (Entrada*) malloc(g->cap_entradas * sizeof(Entrada));
+
+    g->livres = NULL;
+    g->n_livres = 0;
+    g->cap_livres = 0;
+
+    memset(&g->grandes, 0, sizeof(Celula));
+
+    g->proxima_sequencia = 0;
+    g->marca_atual = 0;
+
+    if (g->celulas == NULL || g->entradas == NULL) {
+        free(g->celulas);
+        free(g->entradas);
+        free(g);
+        return NULL;
+    }
+
+    return g;
+}
+
+// DESTRUIR_GRADE
+void destruir_grade(Grade* g) {
+    if (g == NULL) return;
+
+    for (int i = 0; i < g->cap_celulas; i++) {
+        if (g->celulas[i].ocupada) free(g->celulas[i].entradas);
+    }
+
+    free(g->grandes.entradas);
+    free(g->celulas);
+    free(g->entradas);
+    free(g->livres);
+    free(g);
+}
+
+// ---------------------------
+// ALTERAR GRADES EXISTENTES
+// ---------------------------
+
+// GRADE_INSERIR
+void grade_inserir(Grade* g, void* item, double min_x, double min_y, double max_x, double max_y) {
+    if (g == NULL || item == NULL) return;
+
+    int indice = nova_entrada(g);
+    if (indice < 0) return;
+
+    Entrada* e = &g->entradas[indice];
+    e->item = item;
+    e->min_x = min_x;
+    e->min_y = min_y;
+    e->max_x = max_x;
+    e->max_y = max_y;
+    e->sequencia = g->proxima_sequencia++;
+    e->marca = g->marca_atual;
+
+    int cx0 = coordenada_celula(g, min_x), cy0 = coordenada_celula(g, min_y);
+    int cx1 = coordenada_celula(g, max_x), cy1 = coordenada_celula(g, max_y);
+
+    if (item_grande(cx0, cy0, cx1, cy1)) {
+        celula_adicionar(&g->grandes, indice);
+        return;
+    }
+
+    for (int cx = cx0; cx <= cx1; cx++) {
+        for (int cy = cy0; cy <= cy1; cy++) {
+            Celula* c = buscar_celula(g, cx, cy, true);
+            if (c) celula_adicionar(c, indice);
+        }
+    }
+}
+
+// GRADE_REMOVER
+bool grade_remover(Grade* g, void* item, double min_x, double min_y, double max_x, double max_y) {
+    if (g == NULL || item == NULL) return false;
+
+    int cx0 = coordenada_celula(g, min_x), cy0 = coordenada_celula(g, min_y);
+    int cx1 = coordenada_celula(g, max_x), cy1 = coordenada_celula(g, max_y);
+
+    if (item_grande(cx0, cy0, cx1, cy1)) {
+        for (int i = 0; i < g->grandes.n; i++) {
+            int indice = g->grandes.entradas[i];
+            if (g->entradas[indice].item == item) {
+                celula_retirar(&g->grandes, indice);
+                liberar_entrada(g, indice);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // acha a entrada na primeira célula coberta
+    Celula* primeira = buscar_celula(g, cx0, cy0, false);
+    if (primeira == NULL) return false;
+
+    int indice = -1;
+    for (int i = 0; i < primeira->n; i++) {
+        if (g->entradas[primeira->entradas[i]].item == item) {
+            indice = primeira->entradas[i];
+            break;
+        }
+    }
+    if (indice < 0) return false;
+
+    for (int cx = cx0; cx <= cx1; cx++) {
+        for (int cy = cy0; cy <= cy1; cy++) {
+            Celula* c = buscar_celula(g, cx, cy, false);
+            if (c) celula_retirar(c, indice);
+        }
+    }
+
+    liberar_entrada(g, indice);
+    return true;
+}
+
+// --------------
+// FUNÇÕES BUSCA
+// --------------
+
+// ITEM ACHADO NA CONSULTA (a sequência vai junto para ordenar sem olhar a grade)
+typedef struct {
+    long sequencia;
+    void* item;
+} Achado;
+
+// COMPARAR_SEQUENCIA
+static int comparar_sequencia(const void* a, const void* b) {
+    long s1 = ((const Achado*) a)->sequencia;
+    long s2 = ((const Achado*) b)->sequencia;
+    return (s1 > s2) - (s1 < s2);
+}
+
+// COLETAR_CELULA
+static void coletar_celula(Grade* g, Celula* c, double min_x, double min_y, double max_x, double max_y,
+                           Achado** achados, int* n, int* cap) {
+    for (int i = 0; i < c->n; i++) {
+        int indice = c->entradas[i];
+        Entrada* e = &g->entradas[indice];
+
+        if (e->marca == g->marca_atual) continue;
+        e->marca = g->marca_atual;
+
+        if (e->max_x < min_x || e->min_x > max_x || e->max_y < min_y || e->min_y > max_y) continue;
+
+        if (*n == *cap) {
+            int nova_cap = *cap ? *cap * 2 : 16;
+            Achado* novo = (Achado*) realloc(*achados, nova_cap * sizeof(Achado));
+            if (novo == NULL) return;
+            *achados = novo;
+            *cap = nova_cap;
+        }
+        (*achados)[*n].sequencia = e->sequencia;
+        (*achados)[*n].item = e->item;
+        (*n)++;
+    }
+}
+
+// GRADE_CONSULTAR
+int grade_consultar(Grade* g, double min_x, double min_y, double max_x, double max_y, Lista* saida) {
+    if (g == NULL || saida == NULL) return 0;
+
+    g->marca_atual++;
+
+    Achado* achados = NULL;
+    int n = 0, cap = 0;
+
+    coletar_celula(g, &g->grandes, min_x, min_y, max_x, max_y, &achados, &n, &cap);
+
+    int cx0 = coordenada_celula(g, min_x), cy0 = coordenada_celula(g, min_y);
+    int cx1 = coordenada_celula(g, max_x), cy1 = coordenada_celula(g, max_y);
+    double n_cobertas = ((double) cx1 - cx0 + 1) * ((double) cy1 - cy0 + 1);
+
+    if (n_cobertas > g->n_celulas) {
+        // região maior que a parte ocupada: percorre só as células existentes
+        for (int i = 0; i < g->cap_celulas; i++) {
+            Celula* c = &g->celulas[i];
+            if (!c->ocupada || c->cx < cx0 || c->cx > cx1 || c->cy < cy0 || c->cy > cy1) continue;
+            coletar_celula(g, c, min_x, min_y, max_x, max_y, &achados, &n, &cap);
+        }
+    }
+    else {
+        for (int cx = cx0; cx <= cx1; cx++) {
+            for (int cy = cy0; cy <= cy1; cy++) {
+                Celula* c = buscar_celula(g, cx, cy, false);
+                if (c) coletar_celula(g, c, min_x, min_y, max_x, max_y, &achados, &n, &cap);
+            }
+        }
+    }
+
+    // devolve na ordem de inserção (mantém a ordem de desenho)
+    if (n > 1) qsort(achados, n, sizeof(Achado), comparar_sequencia);
+
+    for (int i = 0; i < n; i++) {
+        inserir_fim_lista(saida, achados[i].item);
+    }
+
+    free(achados);
+    return n;
+}
@@ -0,0 +1,65 @@
+#ifndef GRADE_H
+#define GRADE_H
+
+#include <stdbool.h>
+
+#include "lista.h"
+
+// ===============================================
+// GRADE ESPACIAL
+// ----------------------------------------------
+// índice espacial uniforme (hash de células) que
+// guarda itens pelo retângulo envolvente e
+// responde consultas por região sem percorrer
+// todos os itens.
+// ===============================================
+
+// ESTRUTURA DA GRADE
+typedef struct Grade Grade;
+
+// --------------------------------
+// FUNÇÕES DE CRIAÇÃO E DESTRUIÇÃO
+// --------------------------------
+
+/* -> criar_grade
+    FUNÇÃO: cria uma grade vazia
+    RECEBE: o tamanho (lado) de cada célula
+    RETORNA: ponteiro para a grade
+*/
+Grade* criar_grade(double tamanho_celula);
+
+/* -> destruir_grade
+    FUNÇÃO: destrói a grade (não destrói os itens, apenas a estrutura)
+    RECEBE: a grade
+*/
+void destruir_grade(Grade* g);
+
+// ---------------------------
+// ALTERAR GRADES EXISTENTES
+// ---------------------------
+
+/* -> grade_inserir
+    FUNÇÃO: indexa um item pelo seu retângulo envolvente
+    RECEBE: a grade, o item e o retângulo (min_x, min_y, max_x, max_y)
+*/
+void grade_inserir(Grade* g, void* item, double min_x, double min_y, double max_x, double max_y);
+
+/* -> grade_remover
+    FUNÇÃO: remove um item da grade
+    RECEBE: a grade, o item e o mesmo retângulo usado na inserção
+    RETORNA: verdadeiro se o item foi encontrado e removido
+*/
+bool grade_remover(Grade* g, void* item, double min_x, double min_y, double max_x, double max_y);
+
+// --------------
+// FUNÇÕES BUSCA
+// --------------
+
+/* -> grade_consultar
+    FUNÇÃO: encontra os itens cujo retângulo intersecta uma região
+    RECEBE: a grade, a região (min_x, min_y, max_x, max_y) e a lista de saída
+    RETORNA: quantidade de itens inseridos na lista (na ordem de inserção na grade)
+*/
+int grade_consultar(Grade* g, double min_x, double min_y, double max_x, double max_y, Lista* saida);
+
+#endif
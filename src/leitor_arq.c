@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <math.h>
 
 #include "leitor_arq.h"
 #include "visibilidade.h"
@@ -10,8 +11,20 @@
 #include "geometria.h" 
 #include "formas.h" 
 #include "lista.h" 
+#include "grade.h"
+#include "planarizacao.h"
+#include "cache_visibilidade.h"
+#include "bvh.h"
+#include "raios.h"
+#include "triangulacao.h"
+#include "checkpoint.h"
+#include "paleta.h"
+#include "poligono.h"
 
 #define MAX_LINE 1024
+#define TAMANHO_CELULA_GRADE 50.0
+#define TAMANHO_CACHE_VISIBILIDADE 8
+#define CUSTO_RAIO 50.0 // um raio por nível da BVH, em testes de vértice do polígono
 
 // FONTES
 static char font_family[50] = "sans-serif";
@@ -19,6 +32,210 @@ static char font_weight[20] = "normal";
 static int font_size = 12;
 
 static int proximo_id_segmento = 10000; 
+static int proximo_id_clone = 50000;
+
+// CHECKPOINTS (intervalo 0 = desligado)
+static char* caminho_checkpoint = NULL;
+static int intervalo_checkpoint = 0;
+static bool retomar_checkpoint = false;
+static Checkpoint* checkpoint_qry = NULL;
+
+// RECORTE DOS SVGS DE VISIBILIDADE (margem negativa = desligado)
+static double margem_viewport = -1.0;
+static Grade* indice_formas = NULL;
+static Grade* indice_segmentos = NULL;
+
+// POLÍGONOS DE VISIBILIDADE JÁ CALCULADOS (a versão muda a cada comando 'a')
+static unsigned int versao_anteparos = 0;
+static CacheVisibilidade* cache_poligonos = NULL;
+
+// HIERARQUIA DOS ANTEPAROS (consultas de raio)
+static Bvh* bvh_anteparos = NULL;
+
+// MOTOR DE VISIBILIDADE ('v' = varredura, 't' = expansão na triangulação)
+// a triangulação é refeita quando a versão dos anteparos muda
+static char motor_visibilidade = 'v';
+static Triangulacao* triangulacao_anteparos = NULL;
+static unsigned int versao_triangulacao = 0;
+static bool triangulacao_montada = false;
+
+// TESTE POR RAIOS (pintura e clonagem sem polígono, escolhido por bomba)
+static bool teste_por_raios = false;
+
+// ALCANCE DAS BOMBAS SEM RAIO PRÓPRIO NO .QRY (0 = sem limite)
+static double alcance_padrao = 0.0;
+
+// ALCANCE DE UMA BOMBA
+// raio (0 = sem limite) e setor em graus, centrado em direcao (abertura fora
+// de (0, 360) = volta inteira)
+typedef struct {
+    double raio;
+    double direcao;
+    double abertura;
+} AlcanceBomba;
+
+// DEFINIR_VIEWPORT_SVG
+void definir_viewport_svg(double margem) {
+    margem_viewport = margem;
+}
+
+// DEFINIR_MOTOR_VISIBILIDADE
+void definir_motor_visibilidade(char motor) {
+    motor_visibilidade = motor;
+}
+
+// DEFINIR_TESTE_POR_RAIOS
+void definir_teste_por_raios(bool ligado) {
+    teste_por_raios = ligado;
+}
+
+// DEFINIR_ALCANCE_BOMBAS
+void definir_alcance_bombas(double alcance) {
+    alcance_padrao = alcance;
+}
+
+// DEFINIR_CHECKPOINT
+void definir_checkpoint(char* caminho, int intervalo, bool retomar) {
+    caminho_checkpoint = caminho;
+    intervalo_checkpoint = intervalo;
+    retomar_checkpoint = retomar;
+}
+
+// INDEXAR_FORMA
+static void indexar_forma(Forma* f) {
+    if (indice_formas == NULL) return;
+    
+    double min_x, min_y, max_x, max_y;
+    forma_get_bbox(f, &min_x, &min_y, &max_x, &max_y);
+    grade_inserir(indice_formas, f, min_x, min_y, max_x, max_y);
+}
+
+// DESINDEXAR_FORMA
+static void desindexar_forma(Forma* f) {
+    if (indice_formas == NULL) return;
+    
+    double min_x, min_y, max_x, max_y;
+    forma_get_bbox(f, &min_x, &min_y, &max_x, &max_y);
+    grade_remover(indice_formas, f, min_x, min_y, max_x, max_y);
+}
+
+// INDEXAR_SEGMENTO
+static void indexar_segmento(Segmento* s) {
+    if (indice_segmentos == NULL) return;
+    
+    double min_x, min_y, max_x, max_y;
+    segmento_get_bbox(s, &min_x, &min_y, &max_x, &max_y);
+    grade_inserir(indice_segmentos, s, min_x, min_y, max_x, max_y);
+}
+
+// ANTEPAROS_NO_ALCANCE
+// anteparos que chegam no círculo de alcance, achados pela BVH (ou NULL se
+// não foi possível montar a lista; a lista inteira de anteparos serve no lugar)
+static Lista* anteparos_no_alcance(Ponto* origem, double alcance) {
+    if (bvh_anteparos == NULL) return NULL;
+    
+    Lista* caixa = criar_lista();
+    Lista* locais = criar_lista();
+    if (caixa == NULL || locais == NULL) {
+        if (caixa) destruir_lista(caixa);
+        if (locais) destruir_lista(locais);
+        return NULL;
+    }
+    
+    double x = get_x(origem), y = get_y(origem);
+    bvh_consultar(bvh_anteparos, x - alcance, y - alcance, x + alcance, y + alcance, caixa);
+    
+    Elemento* elem = get_primeiro_elemento(caixa);
+    while (elem != NULL) {
+        Segmento* s = (Segmento*) get_elemento(caixa, elem);
+        if (segmento_distancia_ponto(s, origem) <= alcance) inserir_fim_lista(locais, s);
+        elem = get_proximo_elemento(elem);
+    }
+    
+    destruir_lista(caixa);
+    return locais;
+}
+
+// EM_SETOR
+static bool em_setor(AlcanceBomba alcance) {
+    return alcance.abertura > 0.0 && alcance.abertura < 360.0;
+}
+
+// OBTER_POLIGONO_VISIBILIDADE
+// o polígono fica com o cache: quem chama não deve destruí-lo. com raio,
+// basta passar os anteparos que chegam no círculo
+static Poligono* obter_poligono_visibilidade(Ponto* origem, Lista* segmentos, char tipoOrd, int limInsert, AlcanceBomba alcance) {
+    // bombas de volta inteira dividem o polígono, qualquer que seja a direção
+    if (!em_setor(alcance)) alcance.direcao = alcance.abertura = 0.0;
+    
+    Poligono* poligono = cache_visibilidade_buscar(cache_poligonos, get_x(origem), get_y(origem), alcance.raio, alcance.direcao, alcance.abertura, versao_anteparos);
+    if (poligono) return poligono;
+    
+    if (alcance.raio > 0.0 || em_setor(alcance)) {
+        // só os anteparos por perto e os vértices dentro do setor entram na varredura
+        poligono = calcular_visibilidade_setor(origem, segmentos, tipoOrd, limInsert, alcance.raio, alcance.direcao, alcance.abertura);
+        if (poligono) cache_visibilidade_guardar(cache_poligonos, get_x(origem), get_y(origem), alcance.raio, alcance.direcao, alcance.abertura, versao_anteparos, poligono);
+        return poligono;
+    }
+    
+    if (motor_visibilidade == 't') {
+        if (!triangulacao_montada || versao_triangulacao != versao_anteparos) {
+            destruir_triangulacao(triangulacao_anteparos);
+            triangulacao_anteparos = criar_triangulacao(segmentos);
+            versao_triangulacao = versao_anteparos;
+            triangulacao_montada = true;
+        }
+        
+        // origens que a triangulação não responde ficam com a varredura
+        poligono = triangulacao_visibilidade(triangulacao_anteparos, origem);
+    }
+    
+    if (!poligono) poligono = calcular_visibilidade(origem, segmentos, tipoOrd, limInsert);
+    if (poligono) cache_visibilidade_guardar(cache_poligonos, get_x(origem), get_y(origem), 0.0, 0.0, 0.0, versao_anteparos, poligono);
+    
+    return poligono;
+}
+
+// ESCREVER_SVG_VISIBILIDADE
+static void escrever_svg_visibilidade(char* nome, Lista* formas, Lista* segmentos, Poligono* poligono, double x, double y) {
+    FILE* svg = NULL;
+    
+    if (indice_formas == NULL) {
+        svg = criar_svg(nome);
+        if (svg == NULL) return;
+        
+        desenhar_formas(svg, formas);
+        desenhar_segmentos(svg, segmentos);
+    }
+    else {
+        // a caixa do polígono já vem pronta; só falta incluir a origem
+        double caixa[4];
+        poligono_caixa(poligono, caixa);
+        
+        double min_x = fmin(caixa[0], x) - margem_viewport;
+        double min_y = fmin(caixa[1], y) - margem_viewport;
+        double max_x = fmax(caixa[2], x) + margem_viewport;
+        double max_y = fmax(caixa[3], y) + margem_viewport;
+        
+        svg = criar_svg_viewbox(nome, min_x, min_y, max_x - min_x, max_y - min_y);
+        if (svg == NULL) return;
+        
+        Lista* visiveis = criar_lista();
+        
+        grade_consultar(indice_formas, min_x, min_y, max_x, max_y, visiveis);
+        desenhar_formas(svg, visiveis);
+        destruir_lista(visiveis);
+        
+        visiveis = criar_lista();
+        grade_consultar(indice_segmentos, min_x, min_y, max_x, max_y, visiveis);
+        desenhar_segmentos(svg, visiveis);
+        destruir_lista(visiveis);
+    }
+    
+    desenhar_poligono(svg, poligono, "#000000", "#FF0000", 0.5);
+    fprintf(svg, "<circle cx=\"%.2f\" cy=\"%.2f\" r=\"3\" fill=\"red\" stroke=\"black\" />\n", x, y);
+    fechar_svg(svg);
+}
 
 // LER_ARQUIVO_GEO
 int ler_arquivo_geo(char* caminho_arquivo, Lista* formas) {
@@ -131,6 +348,9 @@ static void processar_segmento(int id_ini, int id_fim, char orientacao, Lista* f
     
     fprintf(txt, "COMANDO 'a': transformando formas [%d, %d] em anteparos\n", id_ini, id_fim);
     
+    Lista* novos = criar_lista();
+    if (novos == NULL) return;
+    
     Elemento* elem = get_primeiro_elemento(formas);
     
     while (elem != NULL) {
@@ -146,7 +366,8 @@ static void processar_segmento(int id_ini, int id_fim, char orientacao, Lista* f
                 Elemento* s_elem = get_primeiro_elemento(segs);
                 while (s_elem != NULL) {
                     Segmento* seg = (Segmento*) get_elemento(segs, s_elem); 
-                    inserir_fim_lista(segmentos_globais, seg);
+                    inserir_fim_lista(novos, seg);
+                    checkpoint_registrar_segmento(checkpoint_qry, seg);
                     
                     Ponto* ini = segmento_get_inicio(seg); 
                     Ponto* fim = segmento_get_fim(seg); 
@@ -165,83 +386,211 @@ static void processar_segmento(int id_ini, int id_fim, char orientacao, Lista* f
         
         elem = get_proximo_elemento(elem);
     }
+    
+    // o comando inteiro entra como um lote: os anteparos que se cruzam são divididos
+    planarizar_anteparos(segmentos_globais, novos, indice_segmentos, bvh_anteparos);
+    destruir_lista(novos);
+    versao_anteparos++;
+}
+
+// FORMA_ATINGIDA
+// testa a forma contra o polígono de visibilidade. a caixa do polígono descarta
+// antes as formas distantes, lendo só o registro da forma
+static bool forma_atingida(Forma* f, Poligono* poligono, const double caixa[4]) {
+    if (poligono_tamanho(poligono) < 3) return false;
+    
+    char tipo = forma_get_tipo(f);
+    bool dentro = false;
+    
+    if (tipo == 'l') {
+        if (!forma_caixa_intersecta(f, caixa[0], caixa[1], caixa[2], caixa[3])) return false;
+        
+        dentro = poligono_intersecta_segmento(poligono, ponto_xy(forma_get_x1(f), forma_get_y1(f)), ponto_xy(forma_get_x2(f), forma_get_y2(f)));
+    }
+    else if (tipo == 'c' || tipo == 'r' || tipo == 't') {
+        double x = forma_get_x(f), y = forma_get_y(f);
+        if (x < caixa[0] || x > caixa[2] || y < caixa[1] || y > caixa[3]) return false;
+        
+        dentro = poligono_contem_ponto(poligono, ponto_xy(x, y));
+    }
+    
+    return dentro;
+}
+
+// FORMA_VISIVEL_POR_RAIOS
+// retorna 1 se a forma é atingida, 0 se não é e -1 se os raios não decidem.
+// com alcance, só conta o que está dentro do círculo (a linha é cortada nele)
+static int forma_visivel_por_raios(Forma* f, Ponto origem, double alcance) {
+    char tipo = forma_get_tipo(f);
+    
+    if (tipo == 'l') {
+        Ponto a = ponto_xy(forma_get_x1(f), forma_get_y1(f));
+        Ponto b = ponto_xy(forma_get_x2(f), forma_get_y2(f));
+        
+        if (alcance > 0.0) {
+            double dx = b.x - a.x, dy = b.y - a.y;
+            double fx = a.x - origem.x, fy = a.y - origem.y;
+            double qa = dx * dx + dy * dy, qb = 2.0 * (fx * dx + fy * dy);
+            double disc = qb * qb - 4.0 * qa * (fx * fx + fy * fy - alcance * alcance);
+            if (qa <= 0.0 || disc < 0.0) return 0;
+            
+            double t1 = fmax((-qb - sqrt(disc)) / (2.0 * qa), 0.0);
+            double t2 = fmin((-qb + sqrt(disc)) / (2.0 * qa), 1.0);
+            if (t1 > t2) return 0;
+            
+            b = ponto_xy(a.x + t2 * dx, a.y + t2 * dy);
+            a = ponto_xy(a.x + t1 * dx, a.y + t1 * dy);
+        }
+        
+        return linha_visivel_por_raios(bvh_anteparos, origem, a, b);
+    }
+    if (tipo == 'c' || tipo == 'r' || tipo == 't') {
+        Ponto p = ponto_xy(forma_get_x(f), forma_get_y(f));
+        if (alcance > 0.0 && distancia_pontos_v(origem, p) > alcance) return 0;
+        
+        return ponto_visivel_por_raio(bvh_anteparos, origem, p);
+    }
+    
+    return 0;
+}
+
+// ESCOLHER_TESTE_POR_RAIOS
+// estimativa, em testes de um vértice do polígono, do custo de cada modo: o
+// polígono precisa ser calculado (se não estiver no cache) e cada forma é
+// testada contra todos os vértices dele. a varredura ordena os n_anteparos
+// que recebe e deixa cerca de dois vértices por anteparo; a triangulação
+// (montada uma vez por versão dos anteparos) só visita o que a origem vê, da
+// ordem da raiz do total. cada raio desce a BVH inteira
+static bool escolher_teste_por_raios(Poligono* poligono, int n_formas, int n_anteparos, bool com_alcance) {
+    if (!teste_por_raios || bvh_anteparos == NULL) return false;
+    
+    double n = n_anteparos;
+    double log_total = log2(bvh_tamanho(bvh_anteparos) + 2.0);
+    double custo_poligono;
+    
+    if (poligono) {
+        custo_poligono = n_formas * (double) poligono_tamanho(poligono);
+    }
+    else if (motor_visibilidade == 't' && !com_alcance) {
+        custo_poligono = n_formas * 4.0 * sqrt(n);
+    }
+    else {
+        custo_poligono = n * log2(n + 2.0) + n_formas * (2.0 * n + 4.0);
+    }
+    
+    return n_formas * CUSTO_RAIO * log_total < custo_poligono;
+}
+
+// FORMAS_ATINGIDAS
+// marca quais das n_formas primeiras formas da lista a bomba atinge, por raios
+// ou pelo polígono de visibilidade (o que for mais barato). se algum raio não
+// decide, o polígono é usado para todas
+// retorna NULL se o polígono não pôde ser calculado
+static bool* formas_atingidas(Ponto* origem, Lista* formas, int n_formas, Lista* segmentos, char tipoOrd, int limInsert, AlcanceBomba alcance) {
+    bool* atingidas = (bool*) calloc(n_formas > 0 ? n_formas : 1, sizeof(bool));
+    if (atingidas == NULL) {
+        fprintf(stderr, "erro ao alocar as formas atingidas\n");
+        return NULL;
+    }
+    
+    double raio = alcance.raio;
+    Lista* locais = NULL;
+    int n_candidatas = n_formas;
+    int n_anteparos = lista_tamanho(segmentos);
+    
+    // os raios não olham o setor: com ele, vale sempre o polígono
+    Poligono* poligono = NULL;
+    if (!em_setor(alcance)) poligono = cache_visibilidade_buscar(cache_poligonos, get_x(origem), get_y(origem), raio, 0.0, 0.0, versao_anteparos);
+    
+    if (raio > 0.0) {
+        // as formas longe do círculo saem de graça nos dois modos
+        double x = get_x(origem), y = get_y(origem);
+        n_candidatas = 0;
+        
+        Elemento* elem = get_primeiro_elemento(formas);
+        for (int i = 0; elem != NULL && i < n_formas; i++) {
+            if (forma_caixa_intersecta((Forma*) get_elemento(formas, elem), x - raio, y - raio, x + raio, y + raio)) n_candidatas++;
+            elem = get_proximo_elemento(elem);
+        }
+        
+        if (poligono == NULL) locais = anteparos_no_alcance(origem, raio);
+        if (locais) n_anteparos = lista_tamanho(locais);
+    }
+    
+    if (!em_setor(alcance) && escolher_teste_por_raios(poligono, n_candidatas, n_anteparos, raio > 0.0)) {
+        bool decidido = true;
+        int i = 0;
+        
+        Elemento* elem = get_primeiro_elemento(formas);
+        while (decidido && elem != NULL && i < n_formas) {
+            int visivel = forma_visivel_por_raios((Forma*) get_elemento(formas, elem), *origem, raio);
+            decidido = (visivel >= 0);
+            atingidas[i++] = (visivel == 1);
+            elem = get_proximo_elemento(elem);
+        }
+        
+        if (decidido) {
+            if (locais) destruir_lista(locais);
+            return atingidas;
+        }
+    }
+    
+    if (poligono == NULL) poligono = obter_poligono_visibilidade(origem, locais ? locais : segmentos, tipoOrd, limInsert, alcance);
+    if (locais) destruir_lista(locais);
+    
+    if (poligono == NULL) {
+        free(atingidas);
+        return NULL;
+    }
+    
+    double caixa[4];
+    poligono_caixa(poligono, caixa);
+    
+    Elemento* elem = get_primeiro_elemento(formas);
+    for (int i = 0; elem != NULL && i < n_formas; i++) {
+        atingidas[i] = forma_atingida((Forma*) get_elemento(formas, elem), poligono, caixa);
+        elem = get_proximo_elemento(elem);
+    }
+    
+    return atingidas;
+}
+
+// ESCREVER_ALCANCE
+static void escrever_alcance(FILE* txt, AlcanceBomba alcance) {
+    if (alcance.raio > 0.0) fprintf(txt, "Alcance: %.2f\n", alcance.raio);
+    if (em_setor(alcance)) fprintf(txt, "Setor: direção %.2f, abertura %.2f\n", alcance.direcao, alcance.abertura);
 }
 
 // PROCESSAR_DESTRUICAO
-static void processar_destruicao(double x, double y, char* sufixo, Lista* formas, Lista* segmentos, FILE* txt, char tipoOrd, int limInsert) { 
+static void processar_destruicao(double x, double y, AlcanceBomba alcance, char* sufixo, Lista* formas, Lista* segmentos, FILE* txt, char tipoOrd, int limInsert) { 
     
     fprintf(txt, "COMANDO 'd': Bomba de destruição em (%.2f, %.2f)\n", x, y);
+    escrever_alcance(txt, alcance);
     
     Ponto* origem = criar_ponto(x, y);
-    Lista* poligono = calcular_visibilidade(origem, segmentos, tipoOrd, limInsert);
+    Lista* locais = (alcance.raio > 0.0) ? anteparos_no_alcance(origem, alcance.raio) : NULL;
+    Poligono* poligono = obter_poligono_visibilidade(origem, locais ? locais : segmentos, tipoOrd, limInsert, alcance);
+    if (locais) destruir_lista(locais);
     
     char nome_svg_poligono[100];
     sprintf(nome_svg_poligono, "visibilidade_%s.svg", sufixo);
-    FILE* svg_poligono = criar_svg(nome_svg_poligono);
 
     if (poligono) {
         
-        int n_pts = lista_tamanho(poligono);
-        int n = n_pts / 2;
-        
-        Ponto** vertices = NULL;
-        Lista* vertices_para_desenho = NULL;
-        
-        if (n > 0) {
-            vertices = (Ponto**) malloc(n * sizeof(Ponto*));
-            vertices_para_desenho = criar_lista();
-
-            Elemento* elem = get_primeiro_elemento(poligono);
-            int idx = 0;
-            
-            while (elem != NULL && idx < n) {
-                Ponto* p = (Ponto*) get_elemento(poligono, elem);
-                
-                vertices[idx++] = p; 
-                
-                inserir_fim_lista(vertices_para_desenho, criar_ponto(get_x(p), get_y(p)));
-                
-                elem = get_proximo_elemento(elem); 
-                if (elem) elem = get_proximo_elemento(elem); 
-            }
-        }
-
-        if (svg_poligono && vertices_para_desenho) {
-            desenhar_formas(svg_poligono, formas); 
-            desenhar_segmentos(svg_poligono, segmentos); 
-            desenhar_poligono(svg_poligono, vertices_para_desenho, "#000000", "#FF0000", 0.5);
-            fprintf(svg_poligono, "<circle cx=\"%.2f\" cy=\"%.2f\" r=\"3\" fill=\"red\" stroke=\"black\" />\n", x, y);
-            fechar_svg(svg_poligono);
+        if (poligono_tamanho(poligono) > 0) {
+            escrever_svg_visibilidade(nome_svg_poligono, formas, segmentos, poligono, x, y);
         }
         
+        double caixa[4];
+        poligono_caixa(poligono, caixa);
+        
         Lista* destruidas = criar_lista();
         
         Elemento* elem = get_primeiro_elemento(formas);
         while (elem != NULL) {
             Forma* f = (Forma*) get_elemento(formas, elem);
             
-            bool dentro = false;
-            char tipo = forma_get_tipo(f);
-            
-            if (n > 0) {
-                if (tipo == 'c') {
-                    Ponto* centro = criar_ponto(forma_get_x(f), forma_get_y(f));
-                    dentro = ponto_em_poligono(centro, vertices, n);
-                    destruir_ponto(centro);
-                } 
-                else if (tipo == 'r' || tipo == 't') {
-                    Ponto* p = criar_ponto(forma_get_x(f), forma_get_y(f));
-                    dentro = ponto_em_poligono(p, vertices, n);
-                    destruir_ponto(p);
-                } 
-                else if (tipo == 'l') {
-                    Ponto* p1 = criar_ponto(forma_get_x1(f), forma_get_y1(f));
-                    Ponto* p2 = criar_ponto(forma_get_x2(f), forma_get_y2(f));
-                    dentro = segmento_intersecta_poligono(p1, p2, vertices, n);
-                    destruir_ponto(p1);
-                    destruir_ponto(p2);
-                }
-            } 
+            bool dentro = forma_atingida(f, poligono, caixa);
             
             if (dentro) {
                 fprintf(txt, "Forma ID %d tipo '%c' DESTRUÍDA\n", forma_get_id(f), forma_get_tipo(f));
@@ -260,6 +609,8 @@ static void processar_destruicao(double x, double y, char* sufixo, Lista* formas
                 Forma* fb = (Forma*) get_elemento(formas, busca);
                 if (fb == f) {
                     remover_posicao_lista(formas, busca);
+                    desindexar_forma(f);
+                    checkpoint_registrar_destruicao(checkpoint_qry, forma_get_id(f));
                     destruir_forma(f);
                     break;
                 }
@@ -270,133 +621,71 @@ static void processar_destruicao(double x, double y, char* sufixo, Lista* formas
         }
         
         destruir_lista(destruidas);
-        if (vertices) free(vertices);
-        if (vertices_para_desenho) destruir_lista_de_pontos(vertices_para_desenho); 
-        destruir_lista(poligono); 
     }
     
     destruir_ponto(origem);
 }
 
 // PROCESSAR_PINTURA
-static void processar_pintura(double x, double y, char* cor, char* sufixo, Lista* formas, Lista* segmentos, FILE* txt, char tipoOrd, int limInsert) {
+static void processar_pintura(double x, double y, AlcanceBomba alcance, char* cor, char* sufixo, Lista* formas, Lista* segmentos, FILE* txt, char tipoOrd, int limInsert) {
     
     fprintf(txt, "COMANDO 'p': Bomba de pintura em (%.2f, %.2f) cor %s\n", x, y, cor);
+    escrever_alcance(txt, alcance);
     
+    IdCor id_cor = paleta_internar(cor); // uma busca só, todas as formas pintadas recebem o índice
     Ponto* origem = criar_ponto(x, y);
-    Lista* poligono = calcular_visibilidade(origem, segmentos, tipoOrd, limInsert); 
+    int n_formas = lista_tamanho(formas);
+    bool* atingidas = formas_atingidas(origem, formas, n_formas, segmentos, tipoOrd, limInsert, alcance);
     
-    if (poligono) {
-        int n_pts = lista_tamanho(poligono);
-        int n = n_pts / 2;
-        Ponto** vertices = (Ponto**) malloc(n * sizeof(Ponto*));
-        
-        Elemento* elem = get_primeiro_elemento(poligono);
-        int idx = 0;
-        while (elem != NULL && idx < n) {
-            vertices[idx++] = (Ponto*) get_elemento(poligono, elem);
-            elem = get_proximo_elemento(elem);
-            if (elem) elem = get_proximo_elemento(elem);
-        }
-        
-        elem = get_primeiro_elemento(formas);
-        while (elem != NULL) {
+    if (atingidas) {
+        Elemento* elem = get_primeiro_elemento(formas);
+        for (int i = 0; elem != NULL && i < n_formas; i++) {
             Forma* f = (Forma*) get_elemento(formas, elem);
             
-            bool dentro = false;
-            char tipo = forma_get_tipo(f);
-            
-            if (tipo == 'c') {
-                Ponto* centro = criar_ponto(forma_get_x(f), forma_get_y(f));
-                dentro = ponto_em_poligono(centro, vertices, n);
-                destruir_ponto(centro);
-            } 
-            else if (tipo == 'r' || tipo == 't') {
-                Ponto* p = criar_ponto(forma_get_x(f), forma_get_y(f));
-                dentro = ponto_em_poligono(p, vertices, n);
-                destruir_ponto(p);
-            }
-            else if (tipo == 'l') {
-                Ponto* p1 = criar_ponto(forma_get_x1(f), forma_get_y1(f));
-                Ponto* p2 = criar_ponto(forma_get_x2(f), forma_get_y2(f));
-                dentro = segmento_intersecta_poligono(p1, p2, vertices, n);
-                destruir_ponto(p1);
-                destruir_ponto(p2);
-            }
-            
-            if (dentro) {
+            if (atingidas[i]) {
                 fprintf(txt, "Forma ID %d tipo '%c' PINTADA\n", forma_get_id(f), forma_get_tipo(f));
-                forma_set_cor_borda(f, cor);
-                forma_set_cor_preenchimento(f, cor);
+                forma_set_id_cor_borda(f, id_cor);
+                forma_set_id_cor_preenchimento(f, id_cor);
+                checkpoint_registrar_pintura(checkpoint_qry, forma_get_id(f), cor);
             }
             
             elem = get_proximo_elemento(elem);
         }
         
-        free(vertices);
-        destruir_lista(poligono);
+        free(atingidas);
     }
     
     destruir_ponto(origem);
 }
 
 // PROCESSAR_CLONAGEM
-static void processar_clonagem(double x, double y, double dx, double dy, char* sufixo, Lista* formas, Lista* segmentos, FILE* txt, char tipoOrd, int limInsert) {
+static void processar_clonagem(double x, double y, double dx, double dy, AlcanceBomba alcance, char* sufixo, Lista* formas, Lista* segmentos, FILE* txt, char tipoOrd, int limInsert) {
     
     fprintf(txt, "COMANDO 'cln': Bomba de clonagem em (%.2f, %.2f)\n", x, y);
     fprintf(txt, "Deslocamento: dx= %.2f, dy= %.2f\n", dx, dy);
+    escrever_alcance(txt, alcance);
     
+    // os clones vão para o fim da lista; só as formas que já existiam antes
+    // da bomba são testadas (um clone ainda visível seria clonado de novo)
     Ponto* origem = criar_ponto(x, y);
-    Lista* poligono = calcular_visibilidade(origem, segmentos, tipoOrd, limInsert); 
+    int n_formas = lista_tamanho(formas);
+    bool* atingidas = formas_atingidas(origem, formas, n_formas, segmentos, tipoOrd, limInsert, alcance);
     
-    if (poligono) {
-        int n_pts = lista_tamanho(poligono);
-        int n = n_pts / 2;
-        Ponto** vertices = (Ponto**) malloc(n * sizeof(Ponto*));
-        
-        Elemento* elem = get_primeiro_elemento(poligono);
-        int idx = 0;
-        
-        while (elem != NULL && idx < n) {
-            vertices[idx++] = (Ponto*) get_elemento(poligono, elem);
-            elem = get_proximo_elemento(elem);
-            if (elem) elem = get_proximo_elemento(elem);
-        }
-        
-        static int proximo_id_clone = 50000;
-        
-        elem = get_primeiro_elemento(formas);
-        while (elem != NULL) {
+    if (atingidas) {
+        Elemento* elem = get_primeiro_elemento(formas);
+        for (int i = 0; elem != NULL && i < n_formas; i++) {
             Forma* f = (Forma*) get_elemento(formas, elem);
             
-            bool dentro = false;
-            char tipo = forma_get_tipo(f);
-            
-            if (tipo == 'c') {
-                Ponto* centro = criar_ponto(forma_get_x(f), forma_get_y(f));
-                dentro = ponto_em_poligono(centro, vertices, n);
-                destruir_ponto(centro);
-            }
-            else if (tipo == 'r' || tipo == 't') {
-                Ponto* p = criar_ponto(forma_get_x(f), forma_get_y(f));
-                dentro = ponto_em_poligono(p, vertices, n);
-                destruir_ponto(p);
-            } 
-            else if (tipo == 'l') {
-                Ponto* p1 = criar_ponto(forma_get_x1(f), forma_get_y1(f));
-                Ponto* p2 = criar_ponto(forma_get_x2(f), forma_get_y2(f));
-                dentro = segmento_intersecta_poligono(p1, p2, vertices, n);
-                destruir_ponto(p1);
-                destruir_ponto(p2);
-            }
-            
-            if (dentro) {
+            if (atingidas[i]) {
                 int id_original = forma_get_id(f);
+                char tipo = forma_get_tipo(f);
                 Forma* clone = forma_clonar(f, proximo_id_clone++);
                 
                 if (clone) {
                     forma_mover(clone, dx, dy);
                     inserir_fim_lista(formas, clone);
+                    indexar_forma(clone);
+                    checkpoint_registrar_clone(checkpoint_qry, id_original, forma_get_id(clone), dx, dy);
                     
                     fprintf(txt, "Forma ID %d tipo '%c' -> Clone ID %d\n", id_original, tipo, forma_get_id(clone));
                 }
@@ -405,13 +694,19 @@ static void processar_clonagem(double x, double y, double dx, double dy, char* s
             elem = get_proximo_elemento(elem);
         }
         
-        free(vertices);
-        destruir_lista(poligono);
+        free(atingidas);
     }
     
     destruir_ponto(origem);
 }
 
+// MARCAR_CHECKPOINT
+// o relatório vai para o disco antes do marco, que guarda o tamanho dele
+static void marcar_checkpoint(FILE* arquivo, FILE* arquivo_txt) {
+    fflush(arquivo_txt);
+    checkpoint_marcar(checkpoint_qry, ftell(arquivo), ftell(arquivo_txt), proximo_id_segmento, proximo_id_clone);
+}
+
 // LER_ARQUIVO_QRY
 int ler_arquivo_qry(char* caminho_arquivo, Lista* formas, FILE* arquivo_txt) {
     FILE* arquivo = fopen(caminho_arquivo, "r");
@@ -420,11 +715,61 @@ int ler_arquivo_qry(char* caminho_arquivo, Lista* formas, FILE* arquivo_txt) {
         return -1;
     }
     
+    cache_poligonos = criar_cache_visibilidade(TAMANHO_CACHE_VISIBILIDADE);
+    if (cache_poligonos == NULL) {
+        fprintf(stderr, "erro ao criar o cache de visibilidade\n");
+        fclose(arquivo);
+        return -1;
+    }
+    
+    // acompanha os anteparos para as consultas de um raio só (pode ficar NULL)
+    bvh_anteparos = criar_bvh();
+    
     Lista* segmentos_globais = criar_lista();
     char linha[MAX_LINE];
     char tipo_ordenacao = 'q';
     int limite_insert = 10;
     
+    if (intervalo_checkpoint > 0 && caminho_checkpoint != NULL) {
+        checkpoint_qry = abrir_checkpoint(caminho_checkpoint, caminho_arquivo, retomar_checkpoint);
+        
+        // o relatório volta ao tamanho do último marco (ou ao cabeçalho, sem
+        // marco nenhum): o que foi escrito depois dele vai ser escrito de novo
+        long offset = 0, offset_txt = ftell(arquivo_txt);
+        Lista* restaurados = criar_lista();
+        int marcos = checkpoint_restaurar(checkpoint_qry, formas, restaurados, &offset, &offset_txt, &proximo_id_segmento, &proximo_id_clone);
+        if (retomar_checkpoint) checkpoint_cortar_relatorio(arquivo_txt, offset_txt);
+        if (marcos > 0) {
+            fseek(arquivo, offset, SEEK_SET);
+            printf("retomando do checkpoint (posição %ld do .qry)\n", offset);
+        }
+        
+        // o diário guarda os anteparos originais; como a divisão não depende de como
+        // eles foram agrupados em lotes, planarizar todos de uma vez dá o mesmo resultado
+        planarizar_anteparos(segmentos_globais, restaurados, NULL, bvh_anteparos);
+        destruir_lista(restaurados);
+        versao_anteparos++;
+    }
+    
+    if (margem_viewport >= 0.0) {
+        indice_formas = criar_grade(TAMANHO_CELULA_GRADE);
+        indice_segmentos = criar_grade(TAMANHO_CELULA_GRADE);
+        
+        Elemento* elem = get_primeiro_elemento(formas);
+        while (elem != NULL) {
+            indexar_forma((Forma*) get_elemento(formas, elem));
+            elem = get_proximo_elemento(elem);
+        }
+        
+        elem = get_primeiro_elemento(segmentos_globais);
+        while (elem != NULL) {
+            indexar_segmento((Segmento*) get_elemento(segmentos_globais, elem));
+            elem = get_proximo_elemento(elem);
+        }
+    }
+    
+    int comandos = 0;
+    
     while (fgets(linha, MAX_LINE, arquivo) != NULL) {
         char comando;
         
@@ -440,33 +785,60 @@ int ler_arquivo_qry(char* caminho_arquivo, Lista* formas, FILE* arquivo_txt) {
         } 
         else if (comando == 'd') {
             double x, y;
+            AlcanceBomba alcance = { alcance_padrao, 0.0, 0.0 };
             char sufixo[50];
             
-            if (sscanf(linha, "d %lf %lf %s", &x, &y, sufixo) == 3) {
-                processar_destruicao(x, y, sufixo, formas, segmentos_globais, arquivo_txt, tipo_ordenacao, limite_insert); 
+            // o raio e o setor (direção e abertura) no fim da linha são opcionais
+            if (sscanf(linha, "d %lf %lf %s %lf %lf %lf", &x, &y, sufixo, &alcance.raio, &alcance.direcao, &alcance.abertura) >= 3) {
+                processar_destruicao(x, y, alcance, sufixo, formas, segmentos_globais, arquivo_txt, tipo_ordenacao, limite_insert); 
             }
             
         } 
         else if (comando == 'p') {
             double x, y;
+            AlcanceBomba alcance = { alcance_padrao, 0.0, 0.0 };
             char cor[20], sufixo[50];
             
-            if (sscanf(linha, "p %lf %lf %s %s", &x, &y, cor, sufixo) == 4) {
-                processar_pintura(x, y, cor, sufixo, formas, segmentos_globais, arquivo_txt, tipo_ordenacao, limite_insert); 
+            if (sscanf(linha, "p %lf %lf %s %s %lf %lf %lf", &x, &y, cor, sufixo, &alcance.raio, &alcance.direcao, &alcance.abertura) >= 4) {
+                processar_pintura(x, y, alcance, cor, sufixo, formas, segmentos_globais, arquivo_txt, tipo_ordenacao, limite_insert); 
             }
             
         } 
         else if (comando == 'c' && linha[1] == 'l' && linha[2] == 'n') {
             double x, y, dx, dy;
+            AlcanceBomba alcance = { alcance_padrao, 0.0, 0.0 };
             char sufixo[50];
             
-            if (sscanf(linha, "cln %lf %lf %lf %lf %s", &x, &y, &dx, &dy, sufixo) == 5) {
-                processar_clonagem(x, y, dx, dy, sufixo, formas, segmentos_globais, arquivo_txt, tipo_ordenacao, limite_insert);
+            if (sscanf(linha, "cln %lf %lf %lf %lf %s %lf %lf %lf", &x, &y, &dx, &dy, sufixo, &alcance.raio, &alcance.direcao, &alcance.abertura) >= 5) {
+                processar_clonagem(x, y, dx, dy, alcance, sufixo, formas, segmentos_globais, arquivo_txt, tipo_ordenacao, limite_insert);
             }
         }
+        
+        if (checkpoint_qry && ++comandos % intervalo_checkpoint == 0) {
+            marcar_checkpoint(arquivo, arquivo_txt);
+        }
+    }
+    
+    if (checkpoint_qry) {
+        marcar_checkpoint(arquivo, arquivo_txt);
+        fechar_checkpoint(checkpoint_qry);
+        checkpoint_qry = NULL;
     }
     
     fclose(arquivo);
     destruir_lista(segmentos_globais); 
+    
+    destruir_grade(indice_formas);
+    destruir_grade(indice_segmentos);
+    indice_formas = NULL;
+    indice_segmentos = NULL;
+    esquecer_ordem_visibilidade();
+    destruir_cache_visibilidade(cache_poligonos);
+    cache_poligonos = NULL;
+    destruir_bvh(bvh_anteparos);
+    bvh_anteparos = NULL;
+    destruir_triangulacao(triangulacao_anteparos);
+    triangulacao_anteparos = NULL;
+    triangulacao_montada = false;
     return 0;
 }
\ No newline at end of file
@@ -25,6 +25,44 @@ int ler_arquivo_geo(char* caminho_arquivo, Lista* formas);
 //             LEITURA DE ARQUIVO .QRY
 // ---------------------------------------------------
 
+/* -> definir_viewport_svg
+    FUNÇÃO: liga o modo de recorte dos SVGs de visibilidade, que passam a
+    conter apenas as formas e anteparos próximos do polígono
+    RECEBE: margem em torno do retângulo envolvente do polígono (negativa desliga)
+ */
+void definir_viewport_svg(double margem);
+
+/* -> definir_motor_visibilidade
+    FUNÇÃO: escolhe como os polígonos de visibilidade são calculados: 'v' faz a
+    varredura angular a cada bomba; 't' triangula os anteparos uma vez (por
+    conjunto de anteparos) e expande a visibilidade pelos triângulos
+    RECEBE: 'v' ou 't'
+ */
+void definir_motor_visibilidade(char motor);
+
+/* -> definir_teste_por_raios
+    FUNÇÃO: deixa as bombas de pintura e de clonagem testarem cada forma com um
+    raio da origem até ela, sem montar o polígono de visibilidade, quando a
+    estimativa de custo indicar que compensa (decidido a cada bomba)
+    RECEBE: verdadeiro para ligar
+ */
+void definir_teste_por_raios(bool ligado);
+
+/* -> definir_alcance_bombas
+    FUNÇÃO: define o alcance das bombas (d, p e cln) que não trazem o próprio
+    alcance no fim da linha do .qry: só os anteparos e formas dentro desse raio
+    em volta da origem são considerados
+    RECEBE: o raio de alcance (0 = sem limite)
+ */
+void definir_alcance_bombas(double alcance);
+
+/* -> definir_checkpoint
+    FUNÇÃO: liga os checkpoints periódicos do processamento do .qry
+    RECEBE: caminho do diário de checkpoints, intervalo (em comandos) entre
+    marcos e se a execução deve ser retomada do último marco gravado
+ */
+void definir_checkpoint(char* caminho, int intervalo, bool retomar);
+
 /* -> ler_arquivo_qry
     FUNÇÃO: processar arquivo .qry executando comandos
     RECEBE: caminho do arquivo, lista de formas a ser modificada pelos comandos
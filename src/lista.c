@@ -203,6 +203,32 @@ void inserir_fim_lista(Lista* l, void* elemento) {
     l->tamanho++;
 }
 
+// INSERIR_ANTES_LISTA
+bool inserir_antes_lista(Lista* l, Elemento* x, void* elemento) {
+    if (l == NULL || x == NULL) return false;
+    
+    Elemento* novo = (Elemento*)malloc(sizeof(Elemento));
+    if (novo == NULL) {
+        perror("AVISO: erro ao alocar elemento!");
+        return false;
+    }
+    
+    novo->dado = elemento;
+    novo->proximo = x;
+    novo->anterior = x->anterior;
+    
+    if (x->anterior == NULL) {
+        l->primeiro = novo;
+    }
+    else {
+        x->anterior->proximo = novo;
+    }
+    
+    x->anterior = novo;
+    l->tamanho++;
+    return true;
+}
+
 // REMOVER_INICIO_LISTA
 void* remover_inicio_lista(Lista* l) {
     if (l == NULL || l->primeiro == NULL) {
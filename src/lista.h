@@ -99,6 +99,12 @@ void inserir_inicio_lista(Lista* l, void* elemento);
 // recebe: a lista e o elemento para inserir
 void inserir_fim_lista(Lista* l, void* elemento);
 
+// -> inserir_antes_lista
+// função: inserir um elemento logo antes de outro que já está na lista
+// recebe: a lista, o elemento da lista e o elemento para inserir
+// retorna: falso se não houve memória (a lista fica como estava)
+bool inserir_antes_lista(Lista* l, Elemento* x, void* elemento);
+
 // -> remover_inicio_lista
 // função: remove o elemento no início da lista
 // recebe: a lista
@@ -6,6 +6,10 @@
 #include "formas.h"
 #include "leitor_arq.h"
 #include "svg.h"
+#include "snapshot.h"
+#include "paleta.h"
+
+#define INTERVALO_CHECKPOINT_PADRAO 50
 
 // ESTRUTURA PARAMETROS
 typedef struct {
@@ -15,6 +19,13 @@ typedef struct {
     char* arquivo_qry;
     char tipo_ordenacao;
     int limite_insertionsort;
+    char motor_visibilidade;
+    bool teste_por_raios;
+    double alcance;
+    double margem_viewport;
+    char* arquivo_snapshot;
+    int intervalo_checkpoint;
+    bool retomar;
 } Parametros;
 
 // FUNCAO AUXILIAR SUBSTITITUTA DE STRDUP
@@ -41,6 +52,13 @@ void inicializar_parametros(Parametros* p) {
     p->arquivo_qry = NULL;
     p->tipo_ordenacao = 'q';
     p->limite_insertionsort = 10;
+    p->motor_visibilidade = 'v';
+    p->teste_por_raios = false;
+    p->alcance = 0.0;
+    p->margem_viewport = -1.0;
+    p->arquivo_snapshot = NULL;
+    p->intervalo_checkpoint = 0;
+    p->retomar = false;
 }
 
 // LIBERAR_PARAMETROS 
@@ -78,9 +96,52 @@ int processar_argumentos(int argc, char* argv[], Parametros* p) {
                 return -1;
             }
         } 
+        else if (strcmp(argv[i], "-vis") == 0 && i + 1 < argc) {
+            char* motor = argv[++i];
+            if (strcmp(motor, "v") == 0) {
+                p->motor_visibilidade = 'v';
+            }
+            else if (strcmp(motor, "t") == 0) {
+                p->motor_visibilidade = 't';
+            }
+            else {
+                fprintf(stderr, "motor de visibilidade inválido: %s\n", motor);
+                return -1;
+            }
+        }
+        else if (strcmp(argv[i], "-raios") == 0) {
+            p->teste_por_raios = true;
+        }
+        else if (strcmp(argv[i], "-alcance") == 0 && i + 1 < argc) {
+            p->alcance = atof(argv[++i]);
+            if (p->alcance < 0.0) {
+                fprintf(stderr, "alcance das bombas inválido: %s\n", argv[i]);
+                return -1;
+            }
+        }
         else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
             p->limite_insertionsort = atoi(argv[++i]);
         }
+        else if (strcmp(argv[i], "-snap") == 0 && i + 1 < argc) {
+            p->arquivo_snapshot = argv[++i];
+        }
+        else if (strcmp(argv[i], "-ckpt") == 0 && i + 1 < argc) {
+            p->intervalo_checkpoint = atoi(argv[++i]);
+            if (p->intervalo_checkpoint <= 0) {
+                fprintf(stderr, "intervalo de checkpoint inválido: %s\n", argv[i]);
+                return -1;
+            }
+        }
+        else if (strcmp(argv[i], "-resume") == 0) {
+            p->retomar = true;
+        }
+        else if (strcmp(argv[i], "-vp") == 0 && i + 1 < argc) {
+            p->margem_viewport = atof(argv[++i]);
+            if (p->margem_viewport < 0.0) {
+                fprintf(stderr, "margem do viewport inválida: %s\n", argv[i]);
+                return -1;
+            }
+        }
         else {
             fprintf(stderr, "argumento desconhecido: %s\n", argv[i]);
             return -1;
@@ -164,8 +225,6 @@ int main(int argc, char* argv[]) {
     char* caminho_geo = construir_caminho(params.dir_entrada, params.arquivo_geo);
     char* nome_base = extrair_nome_base(params.arquivo_geo);
     
-    printf("lendo arquivo .geo: %s\n", caminho_geo);
-    
     Lista* formas = criar_lista();
     if (formas == NULL) {
         fprintf(stderr, "erro ao criar lista de formas\n");
@@ -175,7 +234,20 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
-    if (ler_arquivo_geo(caminho_geo, formas) != 0) {
+    bool usou_snapshot = false;
+    
+    if (params.arquivo_snapshot != NULL) {
+        usou_snapshot = carregar_snapshot(params.arquivo_snapshot, caminho_geo, formas) == 0;
+        if (usou_snapshot) {
+            printf("lendo snapshot: %s\n", params.arquivo_snapshot);
+        }
+    }
+    
+    if (!usou_snapshot) {
+        printf("lendo arquivo .geo: %s\n", caminho_geo);
+    }
+    
+    if (!usou_snapshot && ler_arquivo_geo(caminho_geo, formas) != 0) {
         fprintf(stderr, "erro ao ler arquivo .geo\n");
         Elemento* elem = get_primeiro_elemento(formas);
         while (elem != NULL) {
@@ -193,6 +265,12 @@ int main(int argc, char* argv[]) {
     printf("formas carregadas: %d\n", lista_tamanho(formas));
     
     ordenar_lista_por_id(formas);
+    
+    if (params.arquivo_snapshot != NULL && !usou_snapshot) {
+        if (salvar_snapshot(params.arquivo_snapshot, caminho_geo, formas) == 0) {
+            printf("snapshot gravado: %s\n", params.arquivo_snapshot);
+        }
+    }
 
     char caminho_svg_inicial[512];
     snprintf(caminho_svg_inicial, 512, "%s/%s.svg", params.dir_saida, nome_base);
@@ -216,17 +294,47 @@ int main(int argc, char* argv[]) {
         printf("processando arquivo .qry: %s\n", caminho_qry);
         printf("tipo de ordenação: %s\n", params.tipo_ordenacao == 'q' ? "qsort" : "mergesort");
         printf("limite insertionsort: %d\n", params.limite_insertionsort);
+        printf("motor de visibilidade: %s\n", params.motor_visibilidade == 'v' ? "varredura" : "triangulação");
+        definir_motor_visibilidade(params.motor_visibilidade);
+        
+        if (params.teste_por_raios) {
+            printf("pintura e clonagem por raios quando compensar\n");
+            definir_teste_por_raios(true);
+        }
+        
+        if (params.alcance > 0.0) {
+            printf("alcance das bombas: %.2f\n", params.alcance);
+            definir_alcance_bombas(params.alcance);
+        }
+        
+        if (params.margem_viewport >= 0.0) {
+            printf("recorte dos SVGs de visibilidade: margem %.2f\n", params.margem_viewport);
+            definir_viewport_svg(params.margem_viewport);
+        }
         
         char caminho_txt[512];
         snprintf(caminho_txt, 512, "%s/%s-%s.txt", params.dir_saida, nome_base, nome_qry);
         
-        FILE* arquivo_txt = fopen(caminho_txt, "w");
+        char caminho_checkpoint[512];
+        snprintf(caminho_checkpoint, 512, "%s/%s-%s.ckpt", params.dir_saida, nome_base, nome_qry);
+        
+        if (params.retomar || params.intervalo_checkpoint > 0) {
+            int intervalo = params.intervalo_checkpoint > 0 ? params.intervalo_checkpoint : INTERVALO_CHECKPOINT_PADRAO;
+            printf("checkpoint a cada %d comandos: %s%s\n", intervalo, caminho_checkpoint, params.retomar ? " (retomando)" : "");
+            definir_checkpoint(caminho_checkpoint, intervalo, params.retomar);
+        }
+        
+        // ao retomar, o relatório é aberto sem ser apagado; a leitura do .qry
+        // o corta de volta no tamanho que ele tinha no último marco
+        FILE* arquivo_txt = params.retomar ? fopen(caminho_txt, "r+") : NULL;
+        if (arquivo_txt == NULL) arquivo_txt = fopen(caminho_txt, "w");
         if (arquivo_txt == NULL) {
             fprintf(stderr, "erro ao criar arquivo .txt\n");
             free(caminho_qry);
             free(nome_qry);
         } 
         else {
+            // o cabeçalho de uma execução retomada é o mesmo, reescrito por cima
             fprintf(arquivo_txt, "Relatório de processamento\n");
             fprintf(arquivo_txt, "Arquivo .geo: %s\n", params.arquivo_geo);
             fprintf(arquivo_txt, "Arquivo .qry: %s\n\n", params.arquivo_qry);
@@ -268,6 +376,7 @@ int main(int argc, char* argv[]) {
         elem = get_proximo_elemento(elem);
     }
     destruir_lista(formas);
+    liberar_paleta();
 
     free(caminho_geo);
     free(nome_base);
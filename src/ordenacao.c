@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "ordenacao.h"
 #include "visibilidade.h"
@@ -114,4 +115,61 @@ static int comparar_qsort(const void* a, const void* b) {
 void ordena_com_qsort(void** array, int n) {
     if (!array || n <= 1) return;
     qsort(array, n, sizeof(void*), comparar_qsort);
+}
+
+// --------------------------
+//   ORDENAÇÃO ADAPTATIVA
+// --------------------------
+
+// ORDENACAO_ADAPTATIVA
+int ordenacao_adaptativa(void** array, int n, int janela, char tipo, int limite_insert) {
+    if (!array || n <= 1) return 0;
+    
+    void** fora = (void**) malloc(n * sizeof(void*));
+    if (!fora) {
+        if (tipo == 'q') ordena_com_qsort(array, n);
+        else mergesort(array, n, limite_insert);
+        return n;
+    }
+    
+    // os m primeiros já estão em ordem; cada chave só procura seu lugar
+    // nas últimas "janela" posições (m <= i, então o deslocamento nunca
+    // sobrescreve o que ainda não foi lido)
+    int m = 0, f = 0;
+    
+    for (int i = 0; i < n; i++) {
+        void* chave = array[i];
+        int j = m;
+        
+        while (j > 0 && m - j < janela && comparar_vertices((Vertice*)array[j - 1], (Vertice*)chave) > 0) {
+            j--;
+        }
+        
+        if (j > 0 && comparar_vertices((Vertice*)array[j - 1], (Vertice*)chave) > 0) {
+            fora[f++] = chave;
+            continue;
+        }
+        
+        memmove(&array[j + 1], &array[j], (m - j) * sizeof(void*));
+        array[j] = chave;
+        m++;
+    }
+    
+    if (tipo == 'q') ordena_com_qsort(fora, f);
+    else mergesort(fora, f, limite_insert);
+    
+    // intercala de trás para frente, no próprio array
+    int i = m - 1, j = f - 1, k = n - 1;
+    
+    while (j >= 0) {
+        if (i >= 0 && comparar_vertices((Vertice*)array[i], (Vertice*)fora[j]) > 0) {
+            array[k--] = array[i--];
+        }
+        else {
+            array[k--] = fora[j--];
+        }
+    }
+    
+    free(fora);
+    return f;
 }
\ No newline at end of file
@@ -11,7 +11,8 @@
 // que são aqueles que deixam elementos de
 // uma estrutura em sequência.
 // (MÓDULO CONTÉM: mergesort, insertionsort,
-// e um wrapper de qsort).
+// um wrapper de qsort e uma ordenação adaptativa
+// para arrays quase ordenados).
 // ===========================================
 
 // --------------------------
@@ -52,4 +53,20 @@ void mergesort(void** array, int n, int limite_insert);
  */
 void ordena_com_qsort(void** array, int n);
 
+// --------------------------
+//   ORDENAÇÃO ADAPTATIVA
+// --------------------------
+
+/* FUNÇÃO: ordenar um array que já está quase em ordem
+ -> ADAPTATIVA: insertionsort em que cada elemento só anda até
+ "janela" posições; os que precisariam ir mais longe são separados,
+ ordenados (qsort ou mergesort) e intercalados no fim. Custa
+ O(n * janela) mais a ordenação dos separados.
+    RECEBE: array de ponteiros, tamanho do array, janela, tipo de
+    ordenação dos separados ('q' para qsort, senão mergesort) e
+    limite para usar insertionsort.
+    RETORNA: quantidade de elementos que foram separados.
+ */
+int ordenacao_adaptativa(void** array, int n, int janela, char tipo, int limite_insert);
+
 #endif 
\ No newline at end of file
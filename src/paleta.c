@@ -0,0 +1,140 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "paleta.h"
+
+#define MAX_CORES 65535
+#define VAZIO 0xFFFF
+#define COR_PADRAO "#000000"
+
+// as cores ficam em blocos de tamanho fixo que nunca mudam de lugar (só o
+// vetor de blocos é realocado), então o ponteiro de paleta_cor continua valendo
+#define BITS_BLOCO 8
+#define CORES_POR_BLOCO (1 << BITS_BLOCO)
+
+// ESTRUTURA DA PALETA (única, global)
+static char (**blocos)[TAM_MAX_COR] = NULL;
+static int n_blocos = 0;
+static int cap_blocos = 0;
+static int n_cores = 0;
+
+// tabela hash: posição -> índice da cor (VAZIO = livre)
+static uint16_t* tabela = NULL;
+static int cap_tabela = 0;
+
+// ===================
+// FUNÇÕES AUXILIARES
+// ===================
+
+// COR_EM
+static char* cor_em(int i) {
+    return blocos[i >> BITS_BLOCO][i & (CORES_POR_BLOCO - 1)];
+}
+
+// HASH_COR (FNV-1a)
+static unsigned int hash_cor(const char* cor) {
+    unsigned int h = 2166136261u;
+    for (int i = 0; i < TAM_MAX_COR - 1 && cor[i]; i++) {
+        h ^= (unsigned char) cor[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// POSICAO_TABELA
+static int posicao_tabela(const char* cor) {
+    int h = (int) (hash_cor(cor) & (unsigned int) (cap_tabela - 1));
+    while (tabela[h] != VAZIO && strncmp(cor_em(tabela[h]), cor, TAM_MAX_COR - 1) != 0) {
+        h = (h + 1) & (cap_tabela - 1);
+    }
+    return h;
+}
+
+// CRESCER_TABELA
+static int crescer_tabela(void) {
+    int nova_cap = cap_tabela ? cap_tabela * 2 : 64;
+    uint16_t* nova = (uint16_t*) malloc(nova_cap * sizeof(uint16_t));
+    if (nova == NULL) return -1;
+
+    free(tabela);
+    tabela = nova;
+    cap_tabela = nova_cap;
+    memset(tabela, 0xFF, cap_tabela * sizeof(uint16_t));
+
+    for (int i = 0; i < n_cores; i++) {
+        tabela[posicao_tabela(cor_em(i))] = (uint16_t) i;
+    }
+    return 0;
+}
+
+// NOVO_BLOCO
+static int novo_bloco(void) {
+    if (n_blocos == cap_blocos) {
+        int nova_cap = cap_blocos ? cap_blocos * 2 : 4;
+        char (**novo)[TAM_MAX_COR] = realloc(blocos, nova_cap * sizeof(*novo));
+        if (novo == NULL) return -1;
+        blocos = novo;
+        cap_blocos = nova_cap;
+    }
+
+    blocos[n_blocos] = malloc(CORES_POR_BLOCO * sizeof(*blocos[n_blocos]));
+    if (blocos[n_blocos] == NULL) return -1;
+    n_blocos++;
+    return 0;
+}
+
+// ===================
+// FUNÇÕES DA PALETA
+// ===================
+
+// PALETA_INTERNAR
+IdCor paleta_internar(const char* cor) {
+    if (cor == NULL) cor = COR_PADRAO;
+
+    if ((n_cores + 1) * 2 > cap_tabela && crescer_tabela() != 0) {
+        fprintf(stderr, "erro ao aumentar a paleta, usando a primeira cor para: %s\n", cor);
+        return 0;
+    }
+
+    int pos = posicao_tabela(cor);
+    if (tabela[pos] != VAZIO) return tabela[pos];
+
+    if (n_cores == MAX_CORES) {
+        fprintf(stderr, "paleta cheia, usando a primeira cor para: %s\n", cor);
+        return 0;
+    }
+
+    if (n_cores == n_blocos * CORES_POR_BLOCO && novo_bloco() != 0) {
+        fprintf(stderr, "erro ao aumentar a paleta, usando a primeira cor para: %s\n", cor);
+        return 0;
+    }
+
+    char* nova = cor_em(n_cores);
+    strncpy(nova, cor, TAM_MAX_COR - 1);
+    nova[TAM_MAX_COR - 1] = '\0';
+    tabela[pos] = (uint16_t) n_cores;
+
+    return (IdCor) n_cores++;
+}
+
+// PALETA_COR
+const char* paleta_cor(IdCor id) {
+    if (id >= n_cores) return COR_PADRAO;
+    return cor_em(id);
+}
+
+// PALETA_TAMANHO
+int paleta_tamanho(void) {
+    return n_cores;
+}
+
+// LIBERAR_PALETA
+void liberar_paleta(void) {
+    for (int i = 0; i < n_blocos; i++) free(blocos[i]);
+    free(blocos);
+    free(tabela);
+    blocos = NULL;
+    tabela = NULL;
+    n_cores = n_blocos = cap_blocos = cap_tabela = 0;
+}
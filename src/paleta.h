@@ -0,0 +1,47 @@
+#ifndef PALETA_H
+#define PALETA_H
+
+#include <stdint.h>
+
+// ===============================================
+// PALETA DE CORES
+// ----------------------------------------------
+// tabela global de cores sem repetição. formas e
+// segmentos guardam só o índice (16 bits) da cor;
+// a string fica uma única vez na paleta.
+// ===============================================
+
+// ÍNDICE DE UMA COR NA PALETA
+typedef uint16_t IdCor;
+
+// TAMANHO MÁXIMO DE UMA COR (com o '\0')
+#define TAM_MAX_COR 20
+
+/* -> paleta_internar
+    FUNÇÃO: encontra a cor na paleta, adicionando-a se ainda não existir
+    (cores maiores que TAM_MAX_COR - 1 caracteres são truncadas)
+    RECEBE: a cor (ex.: "#FF0000")
+    RETORNA: o índice da cor (se faltar memória, avisa e devolve 0)
+ */
+IdCor paleta_internar(const char* cor);
+
+/* -> paleta_cor
+    FUNÇÃO: consegue a string de uma cor da paleta
+    RECEBE: o índice da cor
+    RETORNA: ponteiro para a string guardada na paleta (não deve ser liberado;
+    continua valendo quando outras cores são adicionadas, até liberar_paleta)
+ */
+const char* paleta_cor(IdCor id);
+
+/* -> paleta_tamanho
+    FUNÇÃO: consegue a quantidade de cores na paleta
+    RETORNA: quantidade de cores (os índices válidos vão de 0 a tamanho - 1)
+ */
+int paleta_tamanho(void);
+
+/* -> liberar_paleta
+    FUNÇÃO: libera a memória da paleta (os índices deixam de valer)
+ */
+void liberar_paleta(void);
+
+#endif
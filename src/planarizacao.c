@@ -0,0 +1,434 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "planarizacao.h"
+#include "segmento.h"
+#include "geometria.h"
+#include "lista.h"
+#include "grade.h"
+#include "bvh.h"
+
+#define TAMANHO_CELULA_PLANARIZACAO 50.0
+
+// marca (segmento_set_marca) dos anteparos que receberam algum corte no lote
+#define MARCA_CORTADO 1
+
+// CORTE
+// ponto em que um anteparo original (identificado pelo id) deve ser dividido,
+// com a posição t ao longo dele
+typedef struct {
+    int id;
+    double t;
+    Ponto* ponto;
+    int criado;    // índice do ponto em criados, -1 se é a ponta de outro segmento
+    bool usado;    // virou a ponta de um pedaço
+} Corte;
+
+// LISTA DE CORTES
+// os pontos de cruzamento criados no lote ficam em criados até a divisão: os que
+// não viram ponta de nenhum pedaço (cortes repetidos, ou perdidos num erro) são
+// destruídos no fim, os outros passam a ser dos pedaços
+typedef struct {
+    Corte* v;
+    int n;
+    int cap;
+    Ponto** criados;
+    int n_criados;
+    int cap_criados;
+    int afetados;  // anteparos marcados com MARCA_CORTADO
+} ListaCortes;
+
+// ===================
+// FUNÇÕES AUXILIARES
+// ===================
+
+// ADICIONAR_CORTE
+// registra o corte e marca o segmento s, para só os marcados serem divididos
+static bool adicionar_corte(ListaCortes* cortes, Segmento* s, Ponto* p, int criado) {
+    if (cortes->n == cortes->cap) {
+        int nova_cap = cortes->cap ? cortes->cap * 2 : 64;
+        Corte* novo = (Corte*) realloc(cortes->v, nova_cap * sizeof(Corte));
+        if (novo == NULL) return false;
+        cortes->v = novo;
+        cortes->cap = nova_cap;
+    }
+
+    Corte* c = &cortes->v[cortes->n++];
+    c->id = segmento_get_id(s);
+    c->t = segmento_parametro(s, *p);
+    c->ponto = p;
+    c->criado = criado;
+    c->usado = false;
+
+    if (!(segmento_get_marca(s) & MARCA_CORTADO)) {
+        segmento_set_marca(s, segmento_get_marca(s) | MARCA_CORTADO);
+        cortes->afetados++;
+    }
+    return true;
+}
+
+// GUARDAR_CRIADO
+// retorna o índice do ponto em criados, ou -1 sem memória (o ponto é destruído)
+static int guardar_criado(ListaCortes* cortes, Ponto* p) {
+    if (cortes->n_criados == cortes->cap_criados) {
+        int nova_cap = cortes->cap_criados ? cortes->cap_criados * 2 : 64;
+        Ponto** novo = (Ponto**) realloc(cortes->criados, nova_cap * sizeof(Ponto*));
+        if (novo == NULL) {
+            destruir_ponto(p);
+            return -1;
+        }
+        cortes->criados = novo;
+        cortes->cap_criados = nova_cap;
+    }
+
+    cortes->criados[cortes->n_criados] = p;
+    return cortes->n_criados++;
+}
+
+// DESTRUIR_NAO_USADOS
+// destrói os pontos criados que nenhum pedaço usou e esvazia a lista de cortes
+static void destruir_nao_usados(ListaCortes* cortes) {
+    bool* usado = (bool*) calloc(cortes->n_criados + 1, sizeof(bool));
+
+    if (usado != NULL) {
+        for (int i = 0; i < cortes->n; i++) {
+            if (cortes->v[i].criado >= 0 && cortes->v[i].usado) usado[cortes->v[i].criado] = true;
+        }
+        for (int i = 0; i < cortes->n_criados; i++) {
+            if (!usado[i]) destruir_ponto(cortes->criados[i]);
+        }
+    }
+    // sem memória nem para as marcas, é mais seguro deixar os pontos vazarem
+
+    free(usado);
+    free(cortes->criados);
+    free(cortes->v);
+}
+
+// COMPARAR_CORTES
+static int comparar_cortes(const void* a, const void* b) {
+    const Corte* c1 = (const Corte*) a;
+    const Corte* c2 = (const Corte*) b;
+
+    if (c1->id != c2->id) return (c1->id > c2->id) - (c1->id < c2->id);
+    return (c1->t > c2->t) - (c1->t < c2->t);
+}
+
+// MESMO_PONTO
+static bool mesmo_ponto(Ponto* p, Ponto* q) {
+    return get_x(p) == get_x(q) && get_y(p) == get_y(q);
+}
+
+// PONTA_NO_INTERIOR
+// a ponta p de outro segmento, já sabida sobre a reta de s, cai entre as pontas
+// do pedaço s (sem ser uma delas)
+static bool ponta_no_interior(Segmento* s, Ponto* p) {
+    Ponto* ini = segmento_get_inicio(s);
+    Ponto* fim = segmento_get_fim(s);
+
+    if (mesmo_ponto(p, ini) || mesmo_ponto(p, fim)) return false;
+
+    double min_x, min_y, max_x, max_y;
+    segmento_get_bbox(s, &min_x, &min_y, &max_x, &max_y);
+    return get_x(p) >= min_x && get_x(p) <= max_x && get_y(p) >= min_y && get_y(p) <= max_y;
+}
+
+// SINAIS_OPOSTOS
+static bool sinais_opostos(double a, double b) {
+    return (a > 0 && b < 0) || (a < 0 && b > 0);
+}
+
+// NA_RETA_X / NA_RETA_Y
+// ponto da reta p1-p2 com a coordenada x (ou y) dada
+static Ponto na_reta_x(Ponto p1, Ponto p2, double x) {
+    return ponto_xy(x, p1.y + (x - p1.x) * (p2.y - p1.y) / (p2.x - p1.x));
+}
+
+static Ponto na_reta_y(Ponto p1, Ponto p2, double y) {
+    return ponto_xy(p1.x + (y - p1.y) * (p2.x - p1.x) / (p2.y - p1.y), y);
+}
+
+// PONTO_DE_CRUZAMENTO
+// cruzamento dos originais p1-p2 e q1-q2 (que se cruzam propriamente). quando um
+// deles é vertical ou horizontal, o ponto fica exatamente sobre ele e é calculado
+// só com o outro: anteparos sobrepostos na mesma parede, cortados por um mesmo
+// segmento, recebem exatamente o mesmo ponto
+static bool ponto_de_cruzamento(Ponto p1, Ponto p2, Ponto q1, Ponto q2, Ponto* saida) {
+    bool p_vertical = p1.x == p2.x, p_horizontal = p1.y == p2.y;
+    bool q_vertical = q1.x == q2.x, q_horizontal = q1.y == q2.y;
+
+    if (p_vertical && q_horizontal) *saida = ponto_xy(p1.x, q1.y);
+    else if (p_horizontal && q_vertical) *saida = ponto_xy(q1.x, p1.y);
+    else if (q_vertical) *saida = na_reta_x(p1, p2, q1.x);
+    else if (q_horizontal) *saida = na_reta_y(p1, p2, q1.y);
+    else if (p_vertical) *saida = na_reta_x(q1, q2, p1.x);
+    else if (p_horizontal) *saida = na_reta_y(q1, q2, p1.y);
+    else return intersecao_segmentos_v(p1, p2, q1, q2, saida);
+
+    return true;
+}
+
+// CORTAR_PAR
+// registra os cortes entre um segmento novo e outro anteparo. as pontas de cada
+// pedaço são comparadas com a reta do original do outro, e o ponto de um
+// cruzamento é calculado sempre com as pontas dos originais e na ordem dos ids:
+// um pedaço já cortado em outro lote (com pontas arredondadas) é visto como o
+// trecho do original que ele é, e o mesmo par de anteparos produz o mesmo ponto
+// em qualquer lote
+static bool cortar_par(ListaCortes* cortes, Segmento* s, Segmento* c) {
+    if (segmento_get_id(s) == segmento_get_id(c)) return true;
+
+    Ponto* s1 = segmento_get_inicio(s);
+    Ponto* s2 = segmento_get_fim(s);
+    Ponto* c1 = segmento_get_inicio(c);
+    Ponto* c2 = segmento_get_fim(c);
+
+    Ponto os1, os2, oc1, oc2;
+    segmento_get_original(s, &os1, &os2);
+    segmento_get_original(c, &oc1, &oc2);
+
+    double d1 = orientacao_v(oc1, oc2, *s1);
+    double d2 = orientacao_v(oc1, oc2, *s2);
+    double d3 = orientacao_v(os1, os2, *c1);
+    double d4 = orientacao_v(os1, os2, *c2);
+
+    if (sinais_opostos(d1, d2) && sinais_opostos(d3, d4)) {
+        Ponto x;
+        bool achou = (segmento_get_id(s) < segmento_get_id(c))
+                   ? ponto_de_cruzamento(os1, os2, oc1, oc2, &x)
+                   : ponto_de_cruzamento(oc1, oc2, os1, os2, &x);
+        if (!achou) return true;
+
+        Ponto* p = criar_ponto(x.x, x.y);
+        if (p == NULL) return false;
+
+        int k = guardar_criado(cortes, p);
+        if (k < 0) return false;
+
+        return adicionar_corte(cortes, s, p, k) && adicionar_corte(cortes, c, p, k);
+    }
+
+    // ponta de um sobre o meio do outro (inclui sobreposições colineares)
+    if (d1 == 0 && ponta_no_interior(c, s1) && !adicionar_corte(cortes, c, s1, -1)) return false;
+    if (d2 == 0 && ponta_no_interior(c, s2) && !adicionar_corte(cortes, c, s2, -1)) return false;
+    if (d3 == 0 && ponta_no_interior(s, c1) && !adicionar_corte(cortes, s, c1, -1)) return false;
+    if (d4 == 0 && ponta_no_interior(s, c2) && !adicionar_corte(cortes, s, c2, -1)) return false;
+
+    return true;
+}
+
+// PRIMEIRO_CORTE_APOS
+// busca binária do primeiro corte do anteparo id com parâmetro maior que t
+static int primeiro_corte_apos(ListaCortes* cortes, int id, double t) {
+    int ini = 0, fim = cortes->n;
+
+    while (ini < fim) {
+        int meio = ini + (fim - ini) / 2;
+        Corte* c = &cortes->v[meio];
+
+        if (c->id < id || (c->id == id && c->t <= t)) ini = meio + 1;
+        else fim = meio;
+    }
+    return ini;
+}
+
+// INDICES
+// estruturas mantidas em dia com a lista de anteparos
+typedef struct {
+    Grade* grade;
+    Bvh* bvh;
+} Indices;
+
+// INDEXAR
+static void indexar(Indices* ind, Segmento* s) {
+    if (ind->bvh) bvh_inserir(ind->bvh, s);
+    if (ind->grade == NULL) return;
+
+    double min_x, min_y, max_x, max_y;
+    segmento_get_bbox(s, &min_x, &min_y, &max_x, &max_y);
+    grade_inserir(ind->grade, s, min_x, min_y, max_x, max_y);
+}
+
+// DESINDEXAR
+static void desindexar(Indices* ind, Segmento* s) {
+    if (ind->bvh) bvh_remover(ind->bvh, s);
+    if (ind->grade == NULL) return;
+
+    double min_x, min_y, max_x, max_y;
+    segmento_get_bbox(s, &min_x, &min_y, &max_x, &max_y);
+    grade_remover(ind->grade, s, min_x, min_y, max_x, max_y);
+}
+
+// DESFAZER_PEDACOS
+// tira da lista (e dos índices) os n pedaços já criados, que estão logo antes de x
+static void desfazer_pedacos(Lista* anteparos, Elemento* x, int n, Indices* indice) {
+    for (int i = 0; i < n; i++) {
+        Segmento* pedaco = (Segmento*) remover_posicao_lista(anteparos, get_elemento_anterior(x));
+        desindexar(indice, pedaco);
+        destruir_segmento(pedaco);
+    }
+}
+
+// DIVIDIR_SEGMENTO
+// troca s (no elemento x da lista) pelos pedaços entre os cortes que caem no seu
+// interior, no mesmo lugar. se faltar memória, os pedaços já criados são desfeitos
+// e s fica como estava
+static bool dividir_segmento(Lista* anteparos, Elemento* x, Segmento* s, ListaCortes* cortes, Indices* indice) {
+    Ponto* ini = segmento_get_inicio(s);
+    Ponto* fim = segmento_get_fim(s);
+    int id = segmento_get_id(s);
+    double t_ini = segmento_parametro(s, *ini);
+    double t_fim = segmento_parametro(s, *fim);
+
+    int primeiro = primeiro_corte_apos(cortes, id, t_ini);
+    int i = primeiro;
+    Ponto* anterior = ini;
+    double t_anterior = t_ini;
+    int pedacos = 0;
+    bool falhou = false;
+
+    for (; i < cortes->n && cortes->v[i].id == id && cortes->v[i].t < t_fim; i++) {
+        Corte* c = &cortes->v[i];
+
+        // cortes repetidos (o mesmo ponto achado por dois pedaços vizinhos)
+        if (c->t <= t_anterior || mesmo_ponto(c->ponto, anterior) || mesmo_ponto(c->ponto, fim)) continue;
+
+        Segmento* pedaco = criar_pedaco_segmento(s, anterior, c->ponto);
+        if (pedaco == NULL || !inserir_antes_lista(anteparos, x, pedaco)) {
+            destruir_segmento(pedaco);
+            falhou = true;
+            break;
+        }
+
+        indexar(indice, pedaco);
+        c->usado = true;
+        pedacos++;
+        anterior = c->ponto;
+        t_anterior = c->t;
+    }
+
+    if (!falhou && pedacos == 0) return true;
+
+    Segmento* ultimo = falhou ? NULL : criar_pedaco_segmento(s, anterior, fim);
+    if (ultimo == NULL || !inserir_antes_lista(anteparos, x, ultimo)) {
+        destruir_segmento(ultimo);
+        desfazer_pedacos(anteparos, x, pedacos, indice);
+        for (int k = primeiro; k < i; k++) cortes->v[k].usado = false;
+        return false;
+    }
+
+    indexar(indice, ultimo);
+    remover_posicao_lista(anteparos, x);
+    desindexar(indice, s);
+    destruir_segmento(s);
+    return true;
+}
+
+// ===================
+// FUNÇÃO PRINCIPAL
+// ===================
+
+// CONSULTAR_INDICE
+// anteparos já existentes cuja caixa toca a região, pelo índice que houver
+static void consultar_indice(Indices* ind, double min_x, double min_y, double max_x, double max_y, Lista* saida) {
+    if (ind->grade) grade_consultar(ind->grade, min_x, min_y, max_x, max_y, saida);
+    else bvh_consultar(ind->bvh, min_x, min_y, max_x, max_y, saida);
+}
+
+// PLANARIZAR_ANTEPAROS
+int planarizar_anteparos(Lista* anteparos, Lista* novos, Grade* grade, Bvh* bvh) {
+    if (anteparos == NULL || novos == NULL) return -1;
+    if (lista_vazia(novos)) return 0;
+
+    Indices indice = { grade, bvh };
+    bool com_indice = (grade != NULL || bvh != NULL);
+    Grade* busca = criar_grade(TAMANHO_CELULA_PLANARIZACAO);
+    Lista* candidatos = criar_lista();
+    ListaCortes cortes = { NULL, 0, 0, NULL, 0, 0, 0 };
+    bool erro = (busca == NULL || candidatos == NULL);
+
+    // sem índice dos anteparos, os que tocam a região do lote vão para a grade
+    // de busca junto com os novos
+    if (!com_indice && !erro) {
+        double lote[4] = { 1e18, 1e18, -1e18, -1e18 };
+        Elemento* elem = get_primeiro_elemento(novos);
+        while (elem != NULL) {
+            double min_x, min_y, max_x, max_y;
+            segmento_get_bbox((Segmento*) get_elemento(novos, elem), &min_x, &min_y, &max_x, &max_y);
+            if (min_x < lote[0]) lote[0] = min_x;
+            if (min_y < lote[1]) lote[1] = min_y;
+            if (max_x > lote[2]) lote[2] = max_x;
+            if (max_y > lote[3]) lote[3] = max_y;
+            elem = get_proximo_elemento(elem);
+        }
+
+        elem = get_primeiro_elemento(anteparos);
+        while (elem != NULL) {
+            Segmento* s = (Segmento*) get_elemento(anteparos, elem);
+            double min_x, min_y, max_x, max_y;
+            segmento_get_bbox(s, &min_x, &min_y, &max_x, &max_y);
+
+            if (min_x <= lote[2] && max_x >= lote[0] && min_y <= lote[3] && max_y >= lote[1]) {
+                grade_inserir(busca, s, min_x, min_y, max_x, max_y);
+            }
+            elem = get_proximo_elemento(elem);
+        }
+    }
+
+    // cada novo é comparado com os anteparos antigos e com os novos anteriores a ele,
+    // então cada par é visto uma vez só
+    Elemento* elem = erro ? NULL : get_primeiro_elemento(novos);
+    while (elem != NULL && !erro) {
+        Segmento* s = (Segmento*) get_elemento(novos, elem);
+        double min_x, min_y, max_x, max_y;
+        segmento_get_bbox(s, &min_x, &min_y, &max_x, &max_y);
+
+        if (com_indice) consultar_indice(&indice, min_x, min_y, max_x, max_y, candidatos);
+        grade_consultar(busca, min_x, min_y, max_x, max_y, candidatos);
+        while (!lista_vazia(candidatos)) {
+            Segmento* c = (Segmento*) remover_inicio_lista(candidatos);
+            if (!erro && !cortar_par(&cortes, s, c)) erro = true;
+        }
+
+        grade_inserir(busca, s, min_x, min_y, max_x, max_y);
+        elem = get_proximo_elemento(elem);
+    }
+
+    destruir_grade(busca);
+    destruir_lista(candidatos);
+
+    while (!lista_vazia(novos)) {
+        Segmento* s = (Segmento*) remover_inicio_lista(novos);
+        inserir_fim_lista(anteparos, s);
+        indexar(&indice, s);
+    }
+
+    // só os anteparos marcados são trocados pelos seus pedaços, no lugar deles;
+    // depois de um erro o resto só tem a marca apagada
+    if (!erro && cortes.n > 0) qsort(cortes.v, cortes.n, sizeof(Corte), comparar_cortes);
+
+    elem = get_primeiro_elemento(anteparos);
+    while (elem != NULL && cortes.afetados > 0) {
+        Elemento* prox = get_proximo_elemento(elem);
+        Segmento* s = (Segmento*) get_elemento(anteparos, elem);
+        int marca = segmento_get_marca(s);
+
+        if (marca & MARCA_CORTADO) {
+            segmento_set_marca(s, marca & ~MARCA_CORTADO);
+            cortes.afetados--;
+            if (!erro && !dividir_segmento(anteparos, elem, s, &cortes, &indice)) erro = true;
+        }
+        elem = prox;
+    }
+
+    int feitos = cortes.n;
+    destruir_nao_usados(&cortes);
+
+    if (erro) {
+        fprintf(stderr, "erro de memória ao planarizar os anteparos\n");
+        return -1;
+    }
+
+    return feitos;
+}
@@ -0,0 +1,33 @@
+#ifndef PLANARIZACAO_H
+#define PLANARIZACAO_H
+
+#include "lista.h"
+#include "grade.h"
+#include "bvh.h"
+
+// ===============================================
+// PLANARIZAÇÃO DOS ANTEPAROS
+// ----------------------------------------------
+// mantém o conjunto de anteparos sem cruzamentos:
+// quando novos segmentos chegam, eles e os que já
+// existiam são divididos nos pontos em que se
+// cruzam (ou em que a ponta de um toca o meio do
+// outro), de modo que dois anteparos só se
+// encontram pelas pontas.
+// ===============================================
+
+/* -> planarizar_anteparos
+    FUNÇÃO: acrescenta um lote de segmentos ao conjunto de anteparos, dividindo os
+    que se cruzam. os pedaços ficam no lugar do segmento dividido, na ordem em que
+    aparecem nele, então o resultado não depende de como os lotes foram agrupados.
+    os segmentos divididos são destruídos (os pontos não)
+    RECEBE:
+    - anteparos: lista de segmentos já sem cruzamentos (recebe os novos no fim)
+    - novos: lista com o lote de segmentos (fica vazia)
+    - grade: grade dos anteparos a manter atualizada (ou NULL)
+    - bvh: hierarquia dos anteparos a manter atualizada (ou NULL)
+    RETORNA: quantidade de cortes feitos, ou -1 em caso de erro
+*/
+int planarizar_anteparos(Lista* anteparos, Lista* novos, Grade* grade, Bvh* bvh);
+
+#endif
@@ -0,0 +1,443 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "poligono.h"
+#include "geometria.h"
+
+// abaixo disso, percorrer todas as arestas sai mais barato que montar a grade
+#define MIN_VERTICES_GRADE 64
+
+// folga relativa nas faixas de células, para que os arredondamentos nunca
+// deixem de fora uma célula que o segmento toca
+#define FOLGA_GRADE 1e-9
+
+// ESTRUTURA DA GRADE DE ARESTAS
+// células uniformes sobre a caixa do polígono; as arestas de cada célula ficam
+// em sequência no array arestas, de inicio[c] até inicio[c + 1]
+typedef struct {
+    int nx, ny;
+    double tam_x, tam_y;
+    double folga_x, folga_y;
+    int* inicio;
+    int* arestas;
+    unsigned int* marca;
+    unsigned int marca_atual;
+} GradeArestas;
+
+// ESTRUTURA DO POLÍGONO
+// as coordenadas ficam lado a lado (x, y) num só array; a caixa acompanha os
+// vértices acrescentados. a grade é montada na primeira consulta de segmento
+// e descartada quando o contorno muda
+struct Poligono {
+    double* xy;
+    int n;
+    int capacidade;
+    double min_x, min_y, max_x, max_y;
+    GradeArestas* grade;
+};
+
+// ===================
+// FUNÇÕES AUXILIARES
+// ===================
+
+// NO_MEIO_DE_RETA
+// b está no trecho reto de a até c (fora dele, b é a ponta de uma agulha de
+// largura zero, que fica). o teste é exato: com tolerância, os pontos que
+// ficam bem sobre um anteparo trocariam de lado
+static bool no_meio_de_reta(const double* a, const double* b, const double* c) {
+    if (orientacao_v(ponto_xy(a[0], a[1]), ponto_xy(b[0], b[1]), ponto_xy(c[0], c[1])) != 0) return false;
+    
+    return (b[0] - a[0]) * (c[0] - b[0]) + (b[1] - a[1]) * (c[1] - b[1]) >= 0.0;
+}
+
+// REPETIDO
+static bool repetido(const double* a, const double* b, double tolerancia) {
+    return fabs(a[0] - b[0]) <= tolerancia && fabs(a[1] - b[1]) <= tolerancia;
+}
+
+// CRUZA_RAIO
+// a aresta p1-p2 cruza o raio horizontal que sai de q para a direita (regra
+// y_min < y <= y_max; o ponto à esquerda da aresta ou sobre ela)
+static bool cruza_raio(Ponto p1, Ponto p2, Ponto q) {
+    if (p1.y < p2.y) return q.y > p1.y && q.y <= p2.y && orientacao_v(p1, p2, q) >= 0;
+    
+    return q.y > p2.y && q.y <= p1.y && orientacao_v(p2, p1, q) >= 0;
+}
+
+// ARESTA
+static void aresta(Poligono* p, int i, Ponto* v1, Ponto* v2) {
+    int k = (i + 1 < p->n) ? i + 1 : 0;
+    *v1 = ponto_xy(p->xy[2 * i], p->xy[2 * i + 1]);
+    *v2 = ponto_xy(p->xy[2 * k], p->xy[2 * k + 1]);
+}
+
+// ---------------------
+// GRADE DE ARESTAS
+// ---------------------
+
+// COLUNA_GRADE
+static int coluna_grade(Poligono* p, double x) {
+    GradeArestas* g = p->grade;
+    int c = (int) ((x - p->min_x) / g->tam_x);
+    return c < 0 ? 0 : (c >= g->nx ? g->nx - 1 : c);
+}
+
+// LINHA_GRADE
+static int linha_grade(Poligono* p, double y) {
+    GradeArestas* g = p->grade;
+    int l = (int) ((y - p->min_y) / g->tam_y);
+    return l < 0 ? 0 : (l >= g->ny ? g->ny - 1 : l);
+}
+
+// LINHAS_NA_COLUNA
+// faixa de linhas que o segmento a-b ocupa dentro da coluna c. a faixa de x
+// da coluna é alargada pela folga antes de virar faixa de y, o que cobre os
+// erros de arredondamento mesmo em segmentos quase verticais
+static void linhas_na_coluna(Poligono* p, Ponto a, Ponto b, int c, int* l0, int* l1) {
+    GradeArestas* g = p->grade;
+    double y0 = a.y, y1 = b.y;
+    double dx = b.x - a.x;
+    
+    if (dx != 0.0) {
+        double x0 = p->min_x + c * g->tam_x - g->folga_x;
+        double x1 = x0 + g->tam_x + 2.0 * g->folga_x;
+        double t0 = (x0 - a.x) / dx, t1 = (x1 - a.x) / dx;
+        if (t0 > t1) { double t = t0; t0 = t1; t1 = t; }
+        if (t0 < 0.0) t0 = 0.0;
+        if (t1 > 1.0) t1 = 1.0;
+        
+        y0 = a.y + t0 * (b.y - a.y);
+        y1 = a.y + t1 * (b.y - a.y);
+    }
+    if (y0 > y1) { double y = y0; y0 = y1; y1 = y; }
+    
+    *l0 = linha_grade(p, y0 - g->folga_y);
+    *l1 = linha_grade(p, y1 + g->folga_y);
+}
+
+// DISTRIBUIR_ARESTAS
+// percorre as células de cada aresta; sem destino, só conta quantas arestas
+// cada célula recebe
+static void distribuir_arestas(Poligono* p, int* contagem, int* destino) {
+    GradeArestas* g = p->grade;
+    
+    for (int i = 0; i < p->n; i++) {
+        Ponto v1, v2;
+        aresta(p, i, &v1, &v2);
+        
+        int c0 = coluna_grade(p, fmin(v1.x, v2.x) - g->folga_x);
+        int c1 = coluna_grade(p, fmax(v1.x, v2.x) + g->folga_x);
+        for (int c = c0; c <= c1; c++) {
+            int l0, l1;
+            linhas_na_coluna(p, v1, v2, c, &l0, &l1);
+            for (int l = l0; l <= l1; l++) {
+                int cel = l * g->nx + c;
+                if (destino) destino[contagem[cel]] = i;
+                contagem[cel]++;
+            }
+        }
+    }
+}
+
+// DESTRUIR_GRADE
+static void destruir_grade(Poligono* p) {
+    if (p->grade == NULL) return;
+    
+    free(p->grade->inicio);
+    free(p->grade->arestas);
+    free(p->grade->marca);
+    free(p->grade);
+    p->grade = NULL;
+}
+
+// MONTAR_GRADE
+// cerca de uma célula por vértice, quadradas dentro da caixa do polígono.
+// se faltar memória, fica sem grade e as consultas percorrem todas as arestas
+static bool montar_grade(Poligono* p) {
+    double w = p->max_x - p->min_x, h = p->max_y - p->min_y;
+    double lado = (w > 0.0 && h > 0.0) ? sqrt(w * h / p->n) : fmax(w, h) / p->n;
+    
+    GradeArestas* g = (GradeArestas*) calloc(1, sizeof(GradeArestas));
+    if (g == NULL) return false;
+    
+    g->nx = (lado > 0.0 && w > 0.0) ? (int) fmin(w / lado, p->n) + 1 : 1;
+    g->ny = (lado > 0.0 && h > 0.0) ? (int) fmin(h / lado, p->n) + 1 : 1;
+    g->tam_x = (w > 0.0) ? w / g->nx : 1.0;
+    g->tam_y = (h > 0.0) ? h / g->ny : 1.0;
+    
+    double escala = fmax(fmax(fabs(p->min_x), fabs(p->max_x)), fmax(fabs(p->min_y), fabs(p->max_y)));
+    g->folga_x = FOLGA_GRADE * (escala + g->tam_x);
+    g->folga_y = FOLGA_GRADE * (escala + g->tam_y);
+    
+    int n_celulas = g->nx * g->ny;
+    g->inicio = (int*) calloc(n_celulas + 1, sizeof(int));
+    g->marca = (unsigned int*) calloc(p->n, sizeof(unsigned int));
+    p->grade = g;
+    if (g->inicio == NULL || g->marca == NULL) {
+        destruir_grade(p);
+        return false;
+    }
+    
+    // primeira passada conta, a segunda preenche a partir do início de cada célula
+    distribuir_arestas(p, g->inicio + 1, NULL);
+    for (int c = 0; c < n_celulas; c++) g->inicio[c + 1] += g->inicio[c];
+    
+    g->arestas = (int*) malloc((g->inicio[n_celulas] > 0 ? g->inicio[n_celulas] : 1) * sizeof(int));
+    int* proximo = (int*) malloc(n_celulas * sizeof(int));
+    if (g->arestas == NULL || proximo == NULL) {
+        free(proximo);
+        destruir_grade(p);
+        return false;
+    }
+    
+    for (int c = 0; c < n_celulas; c++) proximo[c] = g->inicio[c];
+    distribuir_arestas(p, proximo, g->arestas);
+    
+    free(proximo);
+    return true;
+}
+
+// NOVA_MARCA
+// cada consulta usa uma marca nova para não testar duas vezes a aresta que
+// aparece em várias células
+static unsigned int nova_marca(GradeArestas* g) {
+    if (++g->marca_atual == 0) {
+        for (int i = 0; i < g->inicio[g->nx * g->ny]; i++) g->marca[g->arestas[i]] = 0;
+        g->marca_atual = 1;
+    }
+    return g->marca_atual;
+}
+
+// CONTEM_PONTO_NA_GRADE
+// o mesmo raio para a direita de poligono_contem_ponto, mas só com as arestas
+// das células da linha do ponto, da coluna dele em diante: uma aresta que o
+// raio cruza passa por uma dessas células
+static bool contem_ponto_na_grade(Poligono* p, Ponto q) {
+    if (q.x > p->max_x || q.y < p->min_y || q.y > p->max_y) return false;
+    
+    GradeArestas* g = p->grade;
+    unsigned int marca = nova_marca(g);
+    int l = linha_grade(p, q.y);
+    bool dentro = false;
+    
+    for (int c = coluna_grade(p, q.x); c < g->nx; c++) {
+        int cel = l * g->nx + c;
+        for (int j = g->inicio[cel]; j < g->inicio[cel + 1]; j++) {
+            int i = g->arestas[j];
+            if (g->marca[i] == marca) continue;
+            g->marca[i] = marca;
+            
+            Ponto v1, v2;
+            aresta(p, i, &v1, &v2);
+            if (cruza_raio(v1, v2, q)) dentro = !dentro;
+        }
+    }
+    
+    return dentro;
+}
+
+// CRUZA_ARESTA_NA_GRADE
+// testa o segmento só contra as arestas das células por onde ele passa
+static bool cruza_aresta_na_grade(Poligono* p, Ponto a, Ponto b) {
+    GradeArestas* g = p->grade;
+    unsigned int marca = nova_marca(g);
+    
+    int c0 = coluna_grade(p, fmin(a.x, b.x) - g->folga_x);
+    int c1 = coluna_grade(p, fmax(a.x, b.x) + g->folga_x);
+    for (int c = c0; c <= c1; c++) {
+        int l0, l1;
+        linhas_na_coluna(p, a, b, c, &l0, &l1);
+        
+        for (int l = l0; l <= l1; l++) {
+            int cel = l * g->nx + c;
+            for (int j = g->inicio[cel]; j < g->inicio[cel + 1]; j++) {
+                int i = g->arestas[j];
+                if (g->marca[i] == marca) continue;
+                g->marca[i] = marca;
+                
+                Ponto v1, v2;
+                aresta(p, i, &v1, &v2);
+                if (segmentos_intersectam(&a, &b, &v1, &v2)) return true;
+            }
+        }
+    }
+    
+    return false;
+}
+
+// --------------------------------
+// FUNÇÕES DE CRIAÇÃO E DESTRUIÇÃO
+// --------------------------------
+
+// CRIAR_POLIGONO
+Poligono* criar_poligono(int capacidade) {
+    if (capacidade < 4) capacidade = 4;
+    
+    Poligono* p = (Poligono*) malloc(sizeof(Poligono));
+    if (p == NULL) return NULL;
+    
+    p->xy = (double*) malloc(2 * capacidade * sizeof(double));
+    if (p->xy == NULL) {
+        free(p);
+        return NULL;
+    }
+    
+    p->n = 0;
+    p->capacidade = capacidade;
+    p->min_x = p->min_y = 0.0;
+    p->max_x = p->max_y = -1.0; // vazia
+    p->grade = NULL;
+    return p;
+}
+
+// DESTRUIR_POLIGONO
+void destruir_poligono(Poligono* p) {
+    if (p == NULL) return;
+    
+    destruir_grade(p);
+    free(p->xy);
+    free(p);
+}
+
+// ---------------------------
+// ALTERAR POLÍGONOS EXISTENTES
+// ---------------------------
+
+// POLIGONO_ADICIONAR
+bool poligono_adicionar(Poligono* p, double x, double y) {
+    if (p == NULL) return false;
+    
+    destruir_grade(p);
+    if (p->n == p->capacidade) {
+        double* novo = (double*) realloc(p->xy, 4 * p->capacidade * sizeof(double));
+        if (novo == NULL) return false;
+    
+        p->xy = novo;
+        p->capacidade *= 2;
+    }
+    
+    if (p->n == 0 || x < p->min_x) p->min_x = x;
+    if (p->n == 0 || y < p->min_y) p->min_y = y;
+    if (p->n == 0 || x > p->max_x) p->max_x = x;
+    if (p->n == 0 || y > p->max_y) p->max_y = y;
+    
+    p->xy[2 * p->n] = x;
+    p->xy[2 * p->n + 1] = y;
+    p->n++;
+    return true;
+}
+
+// POLIGONO_SIMPLIFICAR
+// compacta o array no próprio lugar: cada vértice novo derruba os anteriores
+// que ficaram no meio de uma reta. os vértices que saem estão sempre entre
+// outros que ficam, então a caixa não muda
+void poligono_simplificar(Poligono* p, double tolerancia) {
+    if (p == NULL || p->n < 4) return;
+    
+    destruir_grade(p);
+    double* xy = p->xy;
+    int m = 0;
+    
+    for (int i = 0; i < p->n; i++) {
+        double novo[2] = { xy[2 * i], xy[2 * i + 1] };
+        if (m > 0 && repetido(&xy[2 * (m - 1)], novo, tolerancia)) continue;
+    
+        while (m >= 2 && no_meio_de_reta(&xy[2 * (m - 2)], &xy[2 * (m - 1)], novo)) m--;
+        xy[2 * m] = novo[0];
+        xy[2 * m + 1] = novo[1];
+        m++;
+    }
+    
+    // o contorno é fechado: o fim também se junta com o começo
+    int ini = 0;
+    bool mudou = true;
+    while (mudou && m - ini > 3) {
+        mudou = false;
+        if (repetido(&xy[2 * (m - 1)], &xy[2 * ini], tolerancia) ||
+            no_meio_de_reta(&xy[2 * (m - 2)], &xy[2 * (m - 1)], &xy[2 * ini])) {
+            m--;
+            mudou = true;
+        }
+        else if (no_meio_de_reta(&xy[2 * (m - 1)], &xy[2 * ini], &xy[2 * (ini + 1)])) {
+            ini++;
+            mudou = true;
+        }
+    }
+    
+    for (int i = ini; i < m; i++) {
+        xy[2 * (i - ini)] = xy[2 * i];
+        xy[2 * (i - ini) + 1] = xy[2 * i + 1];
+    }
+    p->n = m - ini;
+}
+
+// --------------
+// FUNÇÕES GET
+// --------------
+
+// POLIGONO_TAMANHO
+int poligono_tamanho(Poligono* p) {
+    return p ? p->n : 0;
+}
+
+// POLIGONO_VERTICE
+Ponto poligono_vertice(Poligono* p, int i) {
+    return ponto_xy(p->xy[2 * i], p->xy[2 * i + 1]);
+}
+
+// POLIGONO_COORDENADAS
+const double* poligono_coordenadas(Poligono* p) {
+    return p ? p->xy : NULL;
+}
+
+// POLIGONO_CAIXA
+void poligono_caixa(Poligono* p, double caixa[4]) {
+    caixa[0] = p->min_x;
+    caixa[1] = p->min_y;
+    caixa[2] = p->max_x;
+    caixa[3] = p->max_y;
+}
+
+// ----------------
+// TESTES DE ACERTO
+// ----------------
+
+// POLIGONO_CONTEM_PONTO
+// raio horizontal para a direita; cada aresta que ele cruza inverte o estado
+bool poligono_contem_ponto(Poligono* p, Ponto q) {
+    if (p == NULL || p->n < 3) return false;
+    
+    bool dentro = false;
+    for (int i = 0; i < p->n; i++) {
+        Ponto v1, v2;
+        aresta(p, i, &v1, &v2);
+        if (cruza_raio(v1, v2, q)) dentro = !dentro;
+    }
+    
+    return dentro;
+}
+
+// POLIGONO_INTERSECTA_SEGMENTO
+// se nenhuma aresta encosta no segmento, ele está todo dentro ou todo fora, e
+// basta olhar uma das pontas. com a grade, as arestas e o raio dessa ponta
+// ficam restritos às células por onde passam
+bool poligono_intersecta_segmento(Poligono* p, Ponto a, Ponto b) {
+    if (p == NULL || p->n < 3) return false;
+    
+    if (fmax(a.x, b.x) < p->min_x || fmin(a.x, b.x) > p->max_x ||
+        fmax(a.y, b.y) < p->min_y || fmin(a.y, b.y) > p->max_y) return false;
+    
+    if (p->grade == NULL && p->n >= MIN_VERTICES_GRADE) montar_grade(p);
+    
+    if (p->grade) return cruza_aresta_na_grade(p, a, b) || contem_ponto_na_grade(p, a);
+    
+    for (int i = 0; i < p->n; i++) {
+        Ponto v1, v2;
+        aresta(p, i, &v1, &v2);
+        if (segmentos_intersectam(&a, &b, &v1, &v2)) return true;
+    }
+    
+    return poligono_contem_ponto(p, a);
+}
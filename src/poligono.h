@@ -0,0 +1,109 @@
+#ifndef POLIGONO_H
+#define POLIGONO_H
+
+#include <stdbool.h>
+
+#include "geometria.h"
+
+// ===============================================
+// POLÍGONO
+// ----------------------------------------------
+// polígono guardado num único array contínuo de
+// coordenadas (x0, y0, x1, y1, ...), sem um ponto
+// alocado por vértice. é o resultado do cálculo
+// de visibilidade e vai direto para os testes de
+// acerto das bombas e para o SVG.
+// ===============================================
+
+// ESTRUTURA DO POLÍGONO
+typedef struct Poligono Poligono;
+
+// --------------------------------
+// FUNÇÕES DE CRIAÇÃO E DESTRUIÇÃO
+// --------------------------------
+
+/* -> criar_poligono
+    FUNÇÃO: cria um polígono vazio
+    RECEBE: quantos vértices reservar de início (o array cresce sozinho)
+    RETORNA: ponteiro para o polígono ou NULL se faltar memória
+*/
+Poligono* criar_poligono(int capacidade);
+
+/* -> destruir_poligono
+    FUNÇÃO: libera o polígono e o array de coordenadas
+    RECEBE: o polígono
+*/
+void destruir_poligono(Poligono* p);
+
+// ---------------------------
+// ALTERAR POLÍGONOS EXISTENTES
+// ---------------------------
+
+/* -> poligono_adicionar
+    FUNÇÃO: acrescenta um vértice no fim do contorno
+    RECEBE: o polígono e as coordenadas do vértice
+    RETORNA: verdadeiro se o vértice foi acrescentado
+*/
+bool poligono_adicionar(Poligono* p, double x, double y);
+
+/* -> poligono_simplificar
+    FUNÇÃO: tira os vértices repetidos (a menos de tolerancia) e os do meio de
+    trechos retos, inclusive na emenda entre o fim e o começo. a colinearidade
+    é testada com o predicado exato; as pontas de agulhas de largura zero ficam
+    RECEBE: o polígono e a tolerância para vértices repetidos
+*/
+void poligono_simplificar(Poligono* p, double tolerancia);
+
+// --------------
+// FUNÇÕES GET
+// --------------
+
+/* -> poligono_tamanho
+    RECEBE: o polígono
+    RETORNA: o número de vértices
+*/
+int poligono_tamanho(Poligono* p);
+
+/* -> poligono_vertice
+    RECEBE: o polígono e o índice do vértice (de 0 a tamanho - 1)
+    RETORNA: o vértice, por valor
+*/
+Ponto poligono_vertice(Poligono* p, int i);
+
+/* -> poligono_coordenadas
+    RECEBE: o polígono
+    RETORNA: o array de coordenadas (x0, y0, x1, y1, ...), que continua sendo
+    do polígono
+*/
+const double* poligono_coordenadas(Poligono* p);
+
+/* -> poligono_caixa
+    FUNÇÃO: retângulo envolvente do polígono, mantido a cada vértice novo
+    RECEBE: o polígono e onde guardar (min_x, min_y, max_x, max_y); vazio, a
+    caixa sai com o mínimo maior que o máximo
+*/
+void poligono_caixa(Poligono* p, double caixa[4]);
+
+// ----------------
+// TESTES DE ACERTO
+// ----------------
+
+/* -> poligono_contem_ponto
+    FUNÇÃO: descobrir se um ponto está no polígono (raio horizontal para a
+    direita, com as orientações exatas)
+    RECEBE: o polígono e o ponto
+    RETORNA: verdadeiro se estiver ou falso caso não
+*/
+bool poligono_contem_ponto(Poligono* p, Ponto q);
+
+/* -> poligono_intersecta_segmento
+    FUNÇÃO: descobrir se um segmento intersecta o polígono (uma das pontas
+    dentro ou alguma aresta cruzada). polígonos grandes montam, na primeira
+    consulta, uma grade com as arestas de cada célula; daí em diante só as
+    arestas das células por onde o segmento passa são testadas
+    RECEBE: o polígono e as pontas do segmento
+    RETORNA: verdadeiro se intersectar ou falso caso não
+*/
+bool poligono_intersecta_segmento(Poligono* p, Ponto a, Ponto b);
+
+#endif
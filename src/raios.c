@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "raios.h"
+#include "geometria.h"
+#include "segmento.h"
+#include "bvh.h"
+
+#define EPSILON 1e-9
+#define LIMITE_PASSOS 64
+
+// LADO DE UM RAIO
+// o filtro da busca só deixa passar os anteparos que entram no lado do raio
+// (o -> p) para onde a linha continua (sinal da orientação)
+typedef struct {
+    Ponto o, p;
+    double sinal;
+} LadoRaio;
+
+// ---------------------
+// FUNÇÕES AUXILIARES
+// ---------------------
+
+// FORA_DO_LADO
+// filtro da BVH: o raio atravessa os anteparos que não têm ponta no lado certo
+static bool fora_do_lado(Segmento* s, void* contexto) {
+    LadoRaio* lado = (LadoRaio*) contexto;
+    double o1 = orientacao_v(lado->o, lado->p, *segmento_get_inicio(s)) * lado->sinal;
+    double o2 = orientacao_v(lado->o, lado->p, *segmento_get_fim(s)) * lado->sinal;
+
+    return o1 <= 0 && o2 <= 0;
+}
+
+// ANTEPARO_ANTES
+// primeiro anteparo do raio da origem na direção de dir que fica a menos de
+// dist da origem (NULL se não há). incerto marca quando o mais próximo está,
+// dentro da tolerância, na origem ou em dist: ele toca uma das pontas do
+// raio, e visto ou escondido ali depende do arredondamento
+static Segmento* anteparo_antes(Bvh* anteparos, Ponto origem, Ponto dir, double dist, FiltroBvh filtro, void* contexto, bool* incerto) {
+    *incerto = false;
+    if (dist <= EPSILON) return NULL;
+
+    double dist_anteparo;
+    Segmento* s = bvh_raio_mais_proximo(anteparos, origem, dir.x - origem.x, dir.y - origem.y, filtro, contexto, &dist_anteparo);
+    if (s == NULL) return NULL;
+
+    double tolerancia = EPSILON * fmax(1.0, dist);
+    *incerto = dist_anteparo < tolerancia || fabs(dist_anteparo - dist) < tolerancia;
+    if (dist_anteparo >= dist - tolerancia) return NULL;
+
+    return s;
+}
+
+// CORTA_ANTES
+// o anteparo cruza o segmento da origem até b antes de chegar em b
+static bool corta_antes(Segmento* s, Ponto origem, Ponto b) {
+    Ponto e1 = *segmento_get_inicio(s), e2 = *segmento_get_fim(s);
+
+    double o1 = orientacao_v(origem, b, e1), o2 = orientacao_v(origem, b, e2);
+    if ((o1 > 0 && o2 > 0) || (o1 < 0 && o2 < 0)) return false;
+
+    double o3 = orientacao_v(e1, e2, origem), o4 = orientacao_v(e1, e2, b);
+    if (o3 == 0 && o4 == 0) return false; // visto de lado, não esconde nada
+
+    return o3 == 0 || (o3 > 0 && o4 < 0) || (o3 < 0 && o4 > 0);
+}
+
+// PASSA_PELA_PONTA
+// o raio da origem até p passa por uma ponta do anteparo (ou corre ao longo
+// dele): segue a borda do polígono, e p pode estar nela
+static bool passa_pela_ponta(Segmento* s, Ponto origem, Ponto p) {
+    return orientacao_v(origem, p, *segmento_get_inicio(s)) == 0 || orientacao_v(origem, p, *segmento_get_fim(s)) == 0;
+}
+
+// PARAMETRO_NA_LINHA
+static double parametro_na_linha(Ponto a, Ponto b, Ponto p) {
+    double dx = b.x - a.x, dy = b.y - a.y;
+    return ((p.x - a.x) * dx + (p.y - a.y) * dy) / (dx * dx + dy * dy);
+}
+
+// --------------
+// FUNÇÕES BUSCA
+// --------------
+
+// PONTO_VISIVEL_POR_RAIO
+int ponto_visivel_por_raio(Bvh* anteparos, Ponto origem, Ponto p) {
+    bool incerto;
+    Segmento* s = anteparo_antes(anteparos, origem, p, distancia_pontos_v(origem, p), NULL, NULL, &incerto);
+    if (incerto) return -1;
+    if (s == NULL) return 1;
+
+    return passa_pela_ponta(s, origem, p) ? -1 : 0;
+}
+
+// LINHA_VISIVEL_POR_RAIOS
+// p é o ponto da linha até onde ela já se sabe escondida. o anteparo s que
+// esconde p e entra no lado de b, se também cortar o raio até b, esconde todo
+// o resto (ele fica entre a origem e a linha na cunha inteira). se não, ele
+// termina dentro da cunha: até o raio pela sua ponta (ou até onde ele cruza a
+// linha) tudo está escondido, e a busca continua dali. o raio segue pela
+// própria ponta (dir), não por p, que foi arredondado: assim o próximo
+// anteparo da cadeia, que sai dessa ponta, é achado sem depender de
+// arredondamento
+int linha_visivel_por_raios(Bvh* anteparos, Ponto origem, Ponto a, Ponto b) {
+    double sinal = orientacao_v(origem, a, b);
+    if (sinal == 0) return -1;
+    sinal = sinal > 0 ? 1.0 : -1.0;
+
+    // b visto pelo lado de a
+    LadoRaio lado_b = { origem, b, -sinal };
+    bool incerto;
+    Segmento* s = anteparo_antes(anteparos, origem, b, distancia_pontos_v(origem, b), fora_do_lado, &lado_b, &incerto);
+    if (incerto) return -1;
+    if (s == NULL) return 1;
+    if (passa_pela_ponta(s, origem, b)) return -1;
+
+    Ponto p = a, dir = a;
+    double t = 0.0;
+
+    for (int passo = 0; passo < LIMITE_PASSOS; passo++) {
+        LadoRaio lado = { origem, dir, sinal };
+        s = anteparo_antes(anteparos, origem, dir, distancia_pontos_v(origem, p), fora_do_lado, &lado, &incerto);
+        if (incerto) return -1;
+        if (s == NULL) return 1;
+        if (passo == 0 && passa_pela_ponta(s, origem, a)) return -1;
+
+        if (corta_antes(s, origem, b)) return 0;
+
+        // a ponta de s no lado de b
+        Ponto e = *segmento_get_inicio(s);
+        if (orientacao_v(origem, dir, e) * sinal <= 0) e = *segmento_get_fim(s);
+
+        Ponto m;
+        bool na_cunha = orientacao_v(origem, b, e) * sinal < 0;
+        bool na_frente = orientacao_v(a, b, e) * orientacao_v(a, b, origem) > 0;
+
+        bool pela_ponta = na_cunha && na_frente;
+        bool ok = pela_ponta
+                  ? intersecao_segmentos_v(origem, e, a, b, &m)
+                  : intersecao_segmentos_v(*segmento_get_inicio(s), *segmento_get_fim(s), a, b, &m);
+        if (!ok) return -1;
+
+        double t_m = parametro_na_linha(a, b, m);
+        if (t_m <= t + EPSILON) return -1;
+        if (t_m >= 1.0) return 0;
+
+        p = m;
+        dir = pela_ponta ? e : m;
+        t = t_m;
+    }
+
+    return -1;
+}
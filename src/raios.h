@@ -0,0 +1,40 @@
+#ifndef RAIOS_H
+#define RAIOS_H
+
+#include <stdbool.h>
+
+#include "geometria.h"
+#include "bvh.h"
+
+// ===============================================
+// VISIBILIDADE POR RAIOS
+// ----------------------------------------------
+// responde se um ponto (ou parte de uma linha) é
+// visto da origem sem montar o polígono de
+// visibilidade: cada pergunta é um raio contra a
+// BVH dos anteparos, que só olha os anteparos
+// perto do caminho do raio.
+// ===============================================
+
+/* -> ponto_visivel_por_raio
+    FUNÇÃO: testa se nenhum anteparo fica entre a origem e o ponto
+    RECEBE: a BVH dos anteparos, a origem e o ponto
+    RETORNA: 1 se o ponto é visível, 0 se não é e -1 se os raios não decidem
+    (o anteparo mais próximo toca o ponto ou a origem, dentro da tolerância,
+    ou o raio passa pela ponta dele: o ponto fica na borda do polígono)
+*/
+int ponto_visivel_por_raio(Bvh* anteparos, Ponto origem, Ponto p);
+
+/* -> linha_visivel_por_raios
+    FUNÇÃO: testa se algum trecho da linha (a, b) é visto da origem. anda de a
+    para b seguindo a cadeia de anteparos que esconde a linha, com um raio pela
+    ponta de cada um
+    RECEBE: a BVH dos anteparos, a origem e as pontas da linha
+    RETORNA: 1 se algum trecho é visível, 0 se a linha está toda escondida e -1
+    se os raios não decidem (origem alinhada com a linha, anteparo tocando a
+    linha ou a origem, raio pela ponta de um anteparo até uma das pontas da
+    linha ou cadeia longa demais)
+*/
+int linha_visivel_por_raios(Bvh* anteparos, Ponto origem, Ponto a, Ponto b);
+
+#endif
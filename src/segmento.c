@@ -3,16 +3,29 @@
 #include <string.h>
 #include <math.h>
 #include "segmento.h"
+#include "paleta.h"
 
-#define MAX_COR_LEN 20
 #define EPSILON 1e-9
 
 // ESTRUTURA DO SEGMENTO
+// além dos pontos, guarda o que as consultas geométricas usam, calculado uma
+// vez na criação (os pontos de um segmento não mudam depois disso)
 struct Segmento {
     int id;
+    IdCor cor;
+    signed char lado;                  // lado do interior da forma (1, -1 ou 0 sem grupo)
+    unsigned char marca;               // marcas temporárias de uma consulta (0 fora dela)
+    int grupo;                         // id da forma fechada de origem, -1 se nenhuma
+    char orientacao;                   // 'h' horizontal, 'v' vertical ou 'g' geral (só escolhe a conta da distância)
     Ponto* inicio;
     Ponto* fim;
-    char cor[MAX_COR_LEN];
+
+    double x1, y1;                     // início
+    double dx, dy;                     // fim - início
+    double inv_comp2;                  // 1 / (dx² + dy²), 0 se o segmento é degenerado
+    double a, b, c;                    // reta suporte: a*x + b*y + c = 0, com (a, b) unitário
+    double min_x, min_y, max_x, max_y; // retângulo envolvente
+    double ox1, oy1, ox2, oy2;         // pontas do anteparo original (o próprio segmento até ser dividido)
 };
 
 // --------------------------------
@@ -29,18 +42,67 @@ Segmento* criar_segmento(int id, Ponto* inicio, Ponto* fim, char* cor) {
     s->id = id;
     s->inicio = inicio;
     s->fim = fim;
+    s->cor = paleta_internar(cor); // NULL vira "#000000"
+    s->grupo = -1;
+    s->lado = 0;
+    s->marca = 0;
     
-    if (cor) {
-        strncpy(s->cor, cor, MAX_COR_LEN - 1);
-        s->cor[MAX_COR_LEN - 1] = '\0';
-    } 
-    else {
-        strcpy(s->cor, "#000000");
-    }
+    s->x1 = get_x(inicio);
+    s->y1 = get_y(inicio);
+    s->dx = get_x(fim) - s->x1;
+    s->dy = get_y(fim) - s->y1;
+    
+    // os lados de retângulos e os círculos convertidos com h/v caem nos casos
+    // alinhados aos eixos, que têm contas próprias
+    if (s->dy == 0.0 && s->dx != 0.0) s->orientacao = 'h';
+    else if (s->dx == 0.0 && s->dy != 0.0) s->orientacao = 'v';
+    else s->orientacao = 'g';
+    
+    double comp2 = s->dx * s->dx + s->dy * s->dy;
+    s->inv_comp2 = (comp2 < EPSILON) ? 0.0 : 1.0 / comp2;
+    
+    double comp = sqrt(comp2);
+    s->a = (comp > 0.0) ? s->dy / comp : 0.0;
+    s->b = (comp > 0.0) ? -s->dx / comp : 0.0;
+    s->c = -(s->a * s->x1 + s->b * s->y1);
+    
+    s->min_x = fmin(s->x1, s->x1 + s->dx);
+    s->max_x = fmax(s->x1, s->x1 + s->dx);
+    s->min_y = fmin(s->y1, s->y1 + s->dy);
+    s->max_y = fmax(s->y1, s->y1 + s->dy);
+    
+    s->ox1 = s->x1;
+    s->oy1 = s->y1;
+    s->ox2 = s->x1 + s->dx;
+    s->oy2 = s->y1 + s->dy;
     
     return s;
 }
 
+// CRIAR_PEDACO_SEGMENTO
+Segmento* criar_pedaco_segmento(Segmento* s, Ponto* inicio, Ponto* fim) {
+    if (!s) return NULL;
+    
+    Segmento* pedaco = criar_segmento(s->id, inicio, fim, NULL);
+    if (pedaco == NULL) return NULL;
+    
+    pedaco->cor = s->cor;
+    pedaco->grupo = s->grupo;
+    pedaco->lado = s->lado;
+    
+    // a reta suporte e as pontas continuam as do original, para que todos os
+    // pedaços sejam cortados pela mesma conta
+    pedaco->a = s->a;
+    pedaco->b = s->b;
+    pedaco->c = s->c;
+    pedaco->ox1 = s->ox1;
+    pedaco->oy1 = s->oy1;
+    pedaco->ox2 = s->ox2;
+    pedaco->oy2 = s->oy2;
+    
+    return pedaco;
+}
+
 // DESTRUIR_SEGMENTO
 void destruir_segmento(Segmento* s) {
     if (s != NULL) { 
@@ -68,48 +130,183 @@ Ponto* segmento_get_fim(Segmento* s) {
 }
 
 // SEGMENTO_GET_COR
-char* segmento_get_cor(Segmento* s) {
-    return s ? s->cor : NULL;
+const char* segmento_get_cor(Segmento* s) {
+    return s ? paleta_cor(s->cor) : NULL;
+}
+
+// SEGMENTO_GET_ID_COR
+IdCor segmento_get_id_cor(Segmento* s) {
+    return s ? s->cor : 0;
+}
+
+// SEGMENTO_GET_BBOX
+void segmento_get_bbox(Segmento* s, double* min_x, double* min_y, double* max_x, double* max_y) {
+    *min_x = s->min_x; *min_y = s->min_y;
+    *max_x = s->max_x; *max_y = s->max_y;
+}
+
+// SEGMENTO_GET_ORIGINAL
+void segmento_get_original(Segmento* s, Ponto* inicio, Ponto* fim) {
+    *inicio = ponto_xy(s->ox1, s->oy1);
+    *fim = ponto_xy(s->ox2, s->oy2);
+}
+
+// SEGMENTO_PONTA_ORIGINAL
+bool segmento_ponta_original(Segmento* s, Ponto p) {
+    return (p.x == s->ox1 && p.y == s->oy1) || (p.x == s->ox2 && p.y == s->oy2);
+}
+
+// SEGMENTO_GET_GRUPO
+int segmento_get_grupo(Segmento* s) {
+    return s ? s->grupo : -1;
+}
+
+// SEGMENTO_GET_LADO
+int segmento_get_lado(Segmento* s) {
+    return s ? s->lado : 0;
+}
+
+// SEGMENTO_GET_MARCA
+int segmento_get_marca(Segmento* s) {
+    return s ? s->marca : 0;
+}
+
+// ---------------
+// FUNÇÕES SETTER
+// ---------------
+
+// SEGMENTO_SET_GRUPO
+void segmento_set_grupo(Segmento* s, int grupo, int lado) {
+    if (!s) return;
+    
+    s->grupo = (lado != 0) ? grupo : -1;
+    s->lado = (lado > 0) ? 1 : (lado < 0) ? -1 : 0;
+}
+
+// SEGMENTO_SET_MARCA
+void segmento_set_marca(Segmento* s, int marca) {
+    if (s) s->marca = (unsigned char) marca;
 }
 
 // ----------------------
 // OPERAÇÕES GEOMÉTRICAS
 // ----------------------
 
+// DISTANCIA_ALINHADA
+// um segmento horizontal ou vertical é o próprio retângulo envolvente, e a
+// distância até ele é a de um ponto a uma caixa. o quanto o ponto passa da
+// caixa em cada eixo é cortado em 0 com (f + |f|) / 2, sem desvios (o fmax e
+// a comparação com NaN virariam chamada de função ou salto)
+static double distancia_alinhada(Segmento* s, double x, double y) {
+    double cx = 0.5 * (s->min_x + s->max_x), meia_x = 0.5 * (s->max_x - s->min_x);
+    double cy = 0.5 * (s->min_y + s->max_y), meia_y = 0.5 * (s->max_y - s->min_y);
+    
+    double fx = fabs(x - cx) - meia_x;
+    double fy = fabs(y - cy) - meia_y;
+    fx = 0.5 * (fx + fabs(fx));
+    fy = 0.5 * (fy + fabs(fy));
+    
+    return sqrt(fx * fx + fy * fy);
+}
+
 // SEGMENTO_DISTANCIA_PONTO
 double segmento_distancia_ponto(Segmento* s, Ponto* p) {
     if (!s || !p) return 0.0;
-    return distancia_ponto_segmento(p, s->inicio, s->fim);
+    
+    if (s->orientacao != 'g') return distancia_alinhada(s, get_x(p), get_y(p));
+    
+    double px = get_x(p) - s->x1;
+    double py = get_y(p) - s->y1;
+    
+    // projeção sobre o segmento (degenerado: inv_comp2 = 0, fica no início)
+    double t = (px * s->dx + py * s->dy) * s->inv_comp2;
+    
+    if (t <= 0.0) return sqrt(px * px + py * py);
+    
+    if (t >= 1.0) {
+        double fx = px - s->dx, fy = py - s->dy;
+        return sqrt(fx * fx + fy * fy);
+    }
+    
+    // no meio do segmento a distância é a da reta suporte
+    return fabs(s->a * get_x(p) + s->b * get_y(p) + s->c);
+}
+
+// SEGMENTO_PARAMETRO
+double segmento_parametro(Segmento* s, Ponto p) {
+    if (!s) return 0.0;
+    
+    double dx = s->ox2 - s->ox1;
+    double dy = s->oy2 - s->oy1;
+    double comp2 = dx * dx + dy * dy;
+    if (comp2 < EPSILON) return 0.0;
+    
+    return ((p.x - s->ox1) * dx + (p.y - s->oy1) * dy) / comp2;
+}
+
+// SEGMENTO_FACE
+int segmento_face(Segmento* s, Ponto p) {
+    if (!s || s->lado == 0) return 0;
+    
+    double o = orientacao_v(ponto_xy(s->x1, s->y1), ponto_xy(s->x1 + s->dx, s->y1 + s->dy), p);
+    if (o == 0) return 0;
+    
+    return ((o > 0) == (s->lado > 0)) ? 1 : -1;
 }
 
 // SEGMENTO_INTERSECTA_RAIO
-bool segmento_intersecta_raio(Segmento* s, Ponto* origem, double angulo) {
+bool segmento_intersecta_raio(Segmento* s, Ponto* origem, double dx, double dy) {
     if (!s || !origem) return false;
     
-    double dist_max = 1e6;
-    double px = get_x(origem) + dist_max * cos(angulo);
-    double py = get_y(origem) + dist_max * sin(angulo);
-    Ponto* p_raio = criar_ponto(px, py);
+    double ox = get_x(origem), oy = get_y(origem);
+    
+    // lados do raio em que ficam as pontas do segmento
+    double lado_ini = dx * (s->y1 - oy) - dy * (s->x1 - ox);
+    double lado_fim = dx * (s->y1 + s->dy - oy) - dy * (s->x1 + s->dx - ox);
+    if ((lado_ini > 0 && lado_fim > 0) || (lado_ini < 0 && lado_fim < 0)) return false;
+    
+    // a origem precisa estar do lado da reta suporte oposto ao sentido do raio
+    double lado_origem = s->a * ox + s->b * oy + s->c;
+    double aproximacao = s->a * dx + s->b * dy;
+    
+    if (aproximacao == 0.0) {
+        // paralelo: só acerta se for colinear e alguma ponta estiver à frente
+        if (lado_origem != 0.0) return false;
+        return (s->x1 - ox) * dx + (s->y1 - oy) * dy >= 0.0 ||
+               (s->x1 + s->dx - ox) * dx + (s->y1 + s->dy - oy) * dy >= 0.0;
+    }
+    return lado_origem * aproximacao <= 0.0;
+}
+
+// SEGMENTO_INTERSECAO_RAIO_V
+// interseção da reta suporte do segmento com a reta do raio
+bool segmento_intersecao_raio_v(Segmento* s, Ponto origem, double dx, double dy, Ponto* saida) {
+    if (!s) return false;
+    
+    // raios horizontais e verticais saem com a direção unitária: qualquer
+    // vértice alinhado com a origem dá o mesmo corte
+    if (dy == 0 && dx != 0) dx = dx > 0 ? 1.0 : -1.0;
+    if (dx == 0 && dy != 0) dy = dy > 0 ? 1.0 : -1.0;
     
-    bool intersecta = segmentos_intersectam(origem, p_raio, s->inicio, s->fim);
+    // paralelos: mesmo critério de antes, com o raio normalizado
+    double denom = dx * s->dy - dy * s->dx;
+    if (denom * denom < 1e-30 * (dx * dx + dy * dy)) return false;
     
-    destruir_ponto(p_raio);
-    return intersecta;
+    double t = ((s->x1 - origem.x) * s->dy - (s->y1 - origem.y) * s->dx) / denom;
+    
+    saida->x = origem.x + t * dx;
+    saida->y = origem.y + t * dy;
+    return true;
 }
 
 // SEGMENTO_INTERSECAO_RAIO
-Ponto* segmento_intersecao_raio(Segmento* s, Ponto* origem, double angulo) {
+Ponto* segmento_intersecao_raio(Segmento* s, Ponto* origem, double dx, double dy) {
     if (!s || !origem) return NULL;
     
-    double dist_max = 1e6;
-    double px = get_x(origem) + dist_max * cos(angulo);
-    double py = get_y(origem) + dist_max * sin(angulo);
-    Ponto* p_raio = criar_ponto(px, py);
-    
-    Ponto* intersecao = intersecao_segmentos(origem, p_raio, s->inicio, s->fim);
+    Ponto i;
+    if (!segmento_intersecao_raio_v(s, *origem, dx, dy, &i)) return NULL;
     
-    destruir_ponto(p_raio);
-    return intersecao;
+    return criar_ponto(i.x, i.y);
 }
 
 // ----------------------------------
@@ -153,26 +350,32 @@ Lista* forma_para_segmentos(Forma* forma, char orientacao, int* id_base) {
         double x, y, w, h;
         forma_get_retangulo_dados(forma, &x, &y, &w, &h);
         
+        // os cantos são compartilhados pelas arestas vizinhas
         Ponto* p1 = criar_ponto(x, y);
         Ponto* p2 = criar_ponto(x + w, y);
+        Ponto* p3 = criar_ponto(x + w, y + h);
+        Ponto* p4 = criar_ponto(x, y + h);
+        
         Segmento* s1 = criar_segmento((*id_base)++, p1, p2, (char*)cor_borda);
         if (s1) inserir_fim_lista(segmentos, s1);
         
-        Ponto* p3 = criar_ponto(x + w, y);
-        Ponto* p4 = criar_ponto(x + w, y + h);
-        Segmento* s2 = criar_segmento((*id_base)++, p3, p4, (char*)cor_borda);
+        Segmento* s2 = criar_segmento((*id_base)++, p2, p3, (char*)cor_borda);
         if (s2) inserir_fim_lista(segmentos, s2);
         
-        Ponto* p5 = criar_ponto(x + w, y + h);
-        Ponto* p6 = criar_ponto(x, y + h);
-        Segmento* s3 = criar_segmento((*id_base)++, p5, p6, (char*)cor_borda);
+        Segmento* s3 = criar_segmento((*id_base)++, p3, p4, (char*)cor_borda);
         if (s3) inserir_fim_lista(segmentos, s3);
         
-        Ponto* p7 = criar_ponto(x, y + h);
-        Ponto* p8 = criar_ponto(x, y);
-        Segmento* s4 = criar_segmento((*id_base)++, p7, p8, (char*)cor_borda);
+        Segmento* s4 = criar_segmento((*id_base)++, p4, p1, (char*)cor_borda);
         if (s4) inserir_fim_lista(segmentos, s4);
         
+        // as arestas vão de (x, y) a (x + w, y) e seguem o contorno, então o interior
+        // fica à esquerda quando w * h > 0 e à direita quando w * h < 0
+        int lado = (w * h > 0) ? 1 : (w * h < 0) ? -1 : 0;
+        segmento_set_grupo(s1, id_forma, lado);
+        segmento_set_grupo(s2, id_forma, lado);
+        segmento_set_grupo(s3, id_forma, lado);
+        segmento_set_grupo(s4, id_forma, lado);
+        
     }
     else if (tipo == 'l') {
         // LINHA -> 1 segmento 
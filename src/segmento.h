@@ -34,6 +34,15 @@ Segmento* criar_segmento(int id, Ponto* inicio, Ponto* fim, char* cor);
 */
 void destruir_segmento(Segmento* s);
 
+/* -> criar_pedaco_segmento
+    FUNÇÃO: cria um pedaço de um segmento dividido, com o mesmo id, cor, grupo e
+    reta suporte do anteparo original
+    RECEBE: o segmento que está sendo dividido e as pontas do pedaço (sobre ele,
+    na mesma ordem do original)
+    RETORNA: um ponteiro para o pedaço
+*/
+Segmento* criar_pedaco_segmento(Segmento* s, Ponto* inicio, Ponto* fim);
+
 // ---------------
 // FUNÇÕES GETTER
 // ---------------
@@ -62,34 +71,124 @@ Ponto* segmento_get_fim(Segmento* s);
 /* -> segmento_get_cor
     FUNÇÃO: consegue a cor do segmento 
     RECEBE: o segmento
-    RETORNA: ponteiro para a cor
+    RETORNA: ponteiro para a cor (guardada na paleta)
+*/
+const char* segmento_get_cor(Segmento* s);
+
+/* -> segmento_get_id_cor
+    FUNÇÃO: consegue o índice da cor do segmento na paleta
+    RECEBE: o segmento
+    RETORNA: o índice da cor
+*/
+IdCor segmento_get_id_cor(Segmento* s);
+
+/* -> segmento_get_bbox
+    FUNÇÃO: consegue o retângulo envolvente do segmento (calculado na criação)
+    RECEBE: o segmento e onde devolver min_x, min_y, max_x e max_y
+*/
+void segmento_get_bbox(Segmento* s, double* min_x, double* min_y, double* max_x, double* max_y);
+
+/* -> segmento_get_grupo
+    FUNÇÃO: consegue o grupo do segmento (o id da forma fechada de onde ele veio)
+    RECEBE: o segmento
+    RETORNA: o grupo, ou -1 se o segmento não faz parte de uma forma fechada
+*/
+int segmento_get_grupo(Segmento* s);
+
+/* -> segmento_get_lado
+    FUNÇÃO: consegue de que lado do segmento fica o interior da sua forma
+    RECEBE: o segmento
+    RETORNA: 1 se o interior fica à esquerda de início->fim, -1 à direita e 0 sem grupo
+*/
+int segmento_get_lado(Segmento* s);
+
+/* -> segmento_get_marca
+    FUNÇÃO: consegue as marcas temporárias do segmento (bits postos por uma consulta em andamento)
+    RECEBE: o segmento
+    RETORNA: as marcas, 0 fora de uma consulta
+*/
+int segmento_get_marca(Segmento* s);
+
+/* -> segmento_get_original
+    FUNÇÃO: consegue as pontas do anteparo original (iguais às do segmento se ele não foi dividido)
+    RECEBE: o segmento e onde guardar o início e o fim
 */
-char* segmento_get_cor(Segmento* s);
+void segmento_get_original(Segmento* s, Ponto* inicio, Ponto* fim);
+
+/* -> segmento_ponta_original
+    FUNÇÃO: ver se p é uma das pontas do anteparo original. um raio que passa
+    por ela corta o anteparo exatamente ali, sem precisar da conta
+    RECEBE: o segmento e o ponto
+    RETORNA: verdadeiro se p for uma das pontas
+*/
+bool segmento_ponta_original(Segmento* s, Ponto p);
+
+// ---------------
+// FUNÇÕES SETTER
+// ---------------
+
+/* -> segmento_set_grupo
+    FUNÇÃO: marca o segmento como aresta de uma forma fechada e convexa
+    RECEBE: o segmento, o grupo (id da forma) e o lado do interior (1 esquerda, -1 direita)
+*/
+void segmento_set_grupo(Segmento* s, int grupo, int lado);
+
+/* -> segmento_set_marca
+    FUNÇÃO: troca as marcas temporárias do segmento; quem marca tem que voltar a 0
+    antes de terminar, para a próxima consulta achar os segmentos limpos
+    RECEBE: o segmento e as marcas (0 a 255)
+*/
+void segmento_set_marca(Segmento* s, int marca);
 
 // ----------------------
 // OPERAÇÕES GEOMÉTRICAS
 // ----------------------
 
 /* -> segmento_distancia_ponto
-    FUNÇÃO: calcula distância de um ponto até um segmento 
+    FUNÇÃO: calcula distância de um ponto até um segmento (os horizontais e
+    verticais, marcados na criação, usam a conta do retângulo envolvente). é a
+    chave das comparações da árvore de anteparos e do corte por alcance
     RECEBE: o segmento e o ponto
     RETORNA: a distância
 */
 double segmento_distancia_ponto(Segmento* s, Ponto* p);
 
+/* -> segmento_parametro
+    FUNÇÃO: calcula a posição de um ponto ao longo do anteparo original
+    RECEBE: o segmento e o ponto
+    RETORNA: o parâmetro t da projeção (0 no início do original, 1 no fim)
+*/
+double segmento_parametro(Segmento* s, Ponto p);
+
+/* -> segmento_face
+    FUNÇÃO: diz para que lado a aresta de uma forma fechada está virada em relação a um ponto
+    RECEBE: o segmento e o ponto
+    RETORNA: 1 se o ponto está estritamente do lado do interior (aresta de costas),
+    -1 se está estritamente do lado de fora (aresta de frente) e 0 se está sobre a reta
+    suporte ou o segmento não tem grupo
+*/
+int segmento_face(Segmento* s, Ponto p);
+
 /* -> segmento_intersecta_raio
-    FUNÇÃO: verifica se um raio (origem + ângulo) intersecta um segmento
-    RECEBE: o segmento, o ponto de origem e o ângulo
+    FUNÇÃO: verifica se um raio (origem + direção) intersecta um segmento
+    RECEBE: o segmento, o ponto de origem e a direção (dx, dy), que não precisa ser unitária
     RETORNA: verdadeiro caso intercepte e falso para caso não
 */
-bool segmento_intersecta_raio(Segmento* s, Ponto* origem, double angulo);
+bool segmento_intersecta_raio(Segmento* s, Ponto* origem, double dx, double dy);
 
 /* -> segmento_intersecao_raio
     FUNÇÃO: calcula qual é o ponto de interseção entre um segmento e um raio
-    RECEBE: o segmento, o ponto de origem e o ângulo do raio
-    RETORNA: o ponto de interseção
+    RECEBE: o segmento, o ponto de origem e a direção (dx, dy) do raio
+    RETORNA: o ponto de interseção (NULL se forem paralelos)
+*/
+Ponto* segmento_intersecao_raio(Segmento* s, Ponto* origem, double dx, double dy);
+
+/* -> segmento_intersecao_raio_v
+    FUNÇÃO: mesma conta de segmento_intersecao_raio, com a origem por valor e sem alocação
+    RECEBE: o segmento, o ponto de origem, a direção (dx, dy) do raio e onde guardar a interseção
+    RETORNA: verdadeiro se houver interseção (falso se forem paralelos)
 */
-Ponto* segmento_intersecao_raio(Segmento* s, Ponto* origem, double angulo);
+bool segmento_intersecao_raio_v(Segmento* s, Ponto origem, double dx, double dy, Ponto* saida);
 
 // ----------------------------------
 // CONVERSÃO DE FORMAS PARA SEGMENTOS
@@ -0,0 +1,291 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "snapshot.h"
+#include "formas.h"
+#include "lista.h"
+#include "paleta.h"
+
+#define MAGICA_SNAPSHOT "TEDSNAP"
+#define VERSAO_SNAPSHOT 2
+#define TAM_COR 24 // TAM_MAX_COR arredondado para 8, mantendo os registros alinhados
+
+// CABEÇALHO DO ARQUIVO
+typedef struct {
+    char magica[8];
+    uint32_t versao;
+    uint32_t n_formas;
+    uint32_t n_cores;
+    uint32_t tamanho_textos;
+    int64_t tamanho_geo;
+    int64_t mtime_geo;
+} CabecalhoSnapshot;
+
+// REGISTRO DE UMA FORMA (tamanho fixo)
+// v[]: círculo (x, y, r), retângulo (x, y, w, h), linha (x1, y1, x2, y2), texto (x, y)
+typedef struct {
+    int32_t id;
+    char tipo;
+    char ancora;
+    uint16_t cor_borda;
+    uint16_t cor_preenchimento;
+    uint16_t reservado;
+    uint32_t texto;
+    double v[4];
+} RegistroForma;
+
+// ===================
+// FUNÇÕES AUXILIARES
+// ===================
+
+// ESTADO_GEO (tamanho e data de modificação do .geo)
+static int estado_geo(char* caminho_geo, int64_t* tamanho, int64_t* mtime) {
+    struct stat st;
+    if (stat(caminho_geo, &st) != 0) return -1;
+
+    *tamanho = (int64_t) st.st_size;
+    *mtime = (int64_t) st.st_mtime;
+    return 0;
+}
+
+// CRIAR_FORMA_REGISTRO
+// as cores do arquivo já foram passadas para a paleta; mapa_cores leva do índice gravado ao atual
+static Forma* criar_forma_registro(const RegistroForma* r, const IdCor* mapa_cores, const char* textos) {
+    const char* corb = paleta_cor(mapa_cores[r->cor_borda]);
+    const char* corp = paleta_cor(mapa_cores[r->cor_preenchimento]);
+
+    switch (r->tipo) {
+        case 'c':
+            return criar_circulo(r->id, r->v[0], r->v[1], r->v[2], corb, corp);
+        case 'r':
+            return criar_retangulo(r->id, r->v[0], r->v[1], r->v[2], r->v[3], corb, corp);
+        case 'l':
+            return criar_linha(r->id, r->v[0], r->v[1], r->v[2], r->v[3], corb);
+        case 't': {
+            char ancora_str[2] = {r->ancora, '\0'};
+            return criar_texto(r->id, r->v[0], r->v[1], textos + r->texto, ancora_str, corb, corp);
+        }
+    }
+
+    return NULL;
+}
+
+// -----------------------
+// LEITURA DO SNAPSHOT
+// -----------------------
+
+// CARREGAR_SNAPSHOT
+int carregar_snapshot(char* caminho_snapshot, char* caminho_geo, Lista* formas) {
+    if (caminho_snapshot == NULL || formas == NULL) return -1;
+
+    int64_t tamanho_geo, mtime_geo;
+    if (estado_geo(caminho_geo, &tamanho_geo, &mtime_geo) != 0) return -1;
+
+    int fd = open(caminho_snapshot, O_RDONLY);
+    if (fd < 0) return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(CabecalhoSnapshot)) {
+        close(fd);
+        return -1;
+    }
+
+    size_t tamanho = (size_t) st.st_size;
+    void* mapa = mmap(NULL, tamanho, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapa == MAP_FAILED) return -1;
+
+    const CabecalhoSnapshot* cab = (const CabecalhoSnapshot*) mapa;
+    const char (*cores)[TAM_COR] = (const char (*)[TAM_COR]) (cab + 1);
+    const RegistroForma* registros = (const RegistroForma*) (cores + cab->n_cores);
+    const char* textos = (const char*) (registros + cab->n_formas);
+
+    size_t esperado = sizeof(CabecalhoSnapshot) + (size_t) cab->n_cores * TAM_COR +
+                      (size_t) cab->n_formas * sizeof(RegistroForma) + cab->tamanho_textos;
+
+    if (memcmp(cab->magica, MAGICA_SNAPSHOT, sizeof(MAGICA_SNAPSHOT)) != 0 ||
+        cab->versao != VERSAO_SNAPSHOT || esperado != tamanho) {
+        fprintf(stderr, "snapshot inválido, ignorando: %s\n", caminho_snapshot);
+        munmap(mapa, tamanho);
+        return -1;
+    }
+
+    if (cab->tamanho_geo != tamanho_geo || cab->mtime_geo != mtime_geo) {
+        munmap(mapa, tamanho);
+        return -1;
+    }
+
+    // valida tudo antes de criar qualquer forma
+    bool valido = cab->tamanho_textos == 0 || textos[cab->tamanho_textos - 1] == '\0';
+
+    for (uint32_t i = 0; valido && i < cab->n_cores; i++) {
+        if (cores[i][TAM_COR - 1] != '\0') valido = false;
+    }
+
+    for (uint32_t i = 0; valido && i < cab->n_formas; i++) {
+        const RegistroForma* r = &registros[i];
+        if (r->cor_borda >= cab->n_cores || r->cor_preenchimento >= cab->n_cores) valido = false;
+        if (r->tipo == 't' && r->texto >= cab->tamanho_textos) valido = false;
+    }
+
+    if (!valido) {
+        fprintf(stderr, "snapshot corrompido, ignorando: %s\n", caminho_snapshot);
+        munmap(mapa, tamanho);
+        return -1;
+    }
+
+    IdCor* mapa_cores = (IdCor*) malloc((cab->n_cores > 0 ? cab->n_cores : 1) * sizeof(IdCor));
+    if (mapa_cores == NULL) {
+        munmap(mapa, tamanho);
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < cab->n_cores; i++) {
+        mapa_cores[i] = paleta_internar(cores[i]);
+    }
+
+    for (uint32_t i = 0; i < cab->n_formas; i++) {
+        Forma* f = criar_forma_registro(&registros[i], mapa_cores, textos);
+        if (f) inserir_fim_lista(formas, f);
+    }
+
+    free(mapa_cores);
+    munmap(mapa, tamanho);
+    return 0;
+}
+
+// -----------------------
+// GRAVAÇÃO DO SNAPSHOT
+// -----------------------
+
+// SALVAR_SNAPSHOT
+int salvar_snapshot(char* caminho_snapshot, char* caminho_geo, Lista* formas) {
+    if (caminho_snapshot == NULL || formas == NULL) return -1;
+
+    CabecalhoSnapshot cab;
+    memset(&cab, 0, sizeof(cab));
+    memcpy(cab.magica, MAGICA_SNAPSHOT, sizeof(MAGICA_SNAPSHOT));
+    cab.versao = VERSAO_SNAPSHOT;
+
+    if (estado_geo(caminho_geo, &cab.tamanho_geo, &cab.mtime_geo) != 0) return -1;
+
+    int n = lista_tamanho(formas);
+    RegistroForma* registros = (RegistroForma*) calloc(n > 0 ? n : 1, sizeof(RegistroForma));
+    char* textos = NULL;
+    size_t tamanho_textos = 0, cap_textos = 0;
+
+    if (registros == NULL) return -1;
+
+    int i = 0;
+    Elemento* elem = get_primeiro_elemento(formas);
+    while (elem != NULL) {
+        Forma* f = (Forma*) get_elemento(formas, elem);
+        RegistroForma* r = &registros[i++];
+
+        r->id = forma_get_id(f);
+        r->tipo = forma_get_tipo(f);
+        r->cor_borda = forma_get_id_cor_borda(f);
+        r->cor_preenchimento = forma_get_id_cor_preenchimento(f);
+
+        switch (r->tipo) {
+            case 'c':
+                forma_get_circulo_dados(f, &r->v[0], &r->v[1], &r->v[2]);
+                break;
+            case 'r':
+                forma_get_retangulo_dados(f, &r->v[0], &r->v[1], &r->v[2], &r->v[3]);
+                break;
+            case 'l':
+                forma_get_linha_dados(f, &r->v[0], &r->v[1], &r->v[2], &r->v[3]);
+                break;
+            case 't': {
+                const char* texto = forma_get_texto(f);
+                size_t len = strlen(texto) + 1;
+
+                if (tamanho_textos + len > cap_textos) {
+                    size_t nova_cap = cap_textos ? cap_textos * 2 : 1024;
+                    while (nova_cap < tamanho_textos + len) nova_cap *= 2;
+                    char* novo = (char*) realloc(textos, nova_cap);
+                    if (novo == NULL) {
+                        fprintf(stderr, "erro ao gravar snapshot: memória insuficiente\n");
+                        free(registros);
+                        free(textos);
+                        return -1;
+                    }
+                    textos = novo;
+                    cap_textos = nova_cap;
+                }
+
+                r->v[0] = forma_get_x(f);
+                r->v[1] = forma_get_y(f);
+                r->ancora = forma_get_ancora(f)[0];
+                r->texto = (uint32_t) tamanho_textos;
+                memcpy(textos + tamanho_textos, texto, len);
+                tamanho_textos += len;
+                break;
+            }
+        }
+
+        elem = get_proximo_elemento(elem);
+    }
+
+    // a paleta inteira vai para o arquivo; os índices das formas já apontam para ela
+    int n_cores = paleta_tamanho();
+    char (*cores)[TAM_COR] = calloc(n_cores > 0 ? n_cores : 1, TAM_COR);
+    if (cores == NULL) {
+        free(registros);
+        free(textos);
+        return -1;
+    }
+
+    for (int c = 0; c < n_cores; c++) {
+        strncpy(cores[c], paleta_cor((IdCor) c), TAM_COR - 1);
+    }
+
+    cab.n_formas = (uint32_t) n;
+    cab.n_cores = (uint32_t) n_cores;
+    cab.tamanho_textos = (uint32_t) tamanho_textos;
+
+    // grava num temporário e renomeia, para nunca deixar um snapshot pela metade
+    size_t len_tmp = strlen(caminho_snapshot) + 5;
+    char* caminho_tmp = (char*) malloc(len_tmp);
+    int resultado = -1;
+
+    if (caminho_tmp != NULL) {
+        snprintf(caminho_tmp, len_tmp, "%s.tmp", caminho_snapshot);
+        FILE* arquivo = fopen(caminho_tmp, "wb");
+
+        if (arquivo != NULL) {
+            bool ok = fwrite(&cab, sizeof(cab), 1, arquivo) == 1;
+            if (ok && n_cores > 0) ok = fwrite(cores, TAM_COR, n_cores, arquivo) == (size_t) n_cores;
+            if (ok && n > 0) ok = fwrite(registros, sizeof(RegistroForma), n, arquivo) == (size_t) n;
+            if (ok && tamanho_textos > 0) ok = fwrite(textos, 1, tamanho_textos, arquivo) == tamanho_textos;
+
+            if (fclose(arquivo) == 0 && ok && rename(caminho_tmp, caminho_snapshot) == 0) {
+                resultado = 0;
+            }
+            else {
+                remove(caminho_tmp);
+            }
+        }
+
+        free(caminho_tmp);
+    }
+
+    if (resultado != 0) {
+        fprintf(stderr, "erro ao gravar snapshot: %s\n", caminho_snapshot);
+    }
+
+    free(registros);
+    free(cores);
+    free(textos);
+    return resultado;
+}
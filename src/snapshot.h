@@ -0,0 +1,32 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "lista.h"
+#include "formas.h"
+
+// ===============================================
+// SNAPSHOT
+// ----------------------------------------------
+// cópia binária compacta das formas carregadas de
+// um .geo: registros de tamanho fixo, tabela de
+// cores sem repetição e um bloco com os textos.
+// é lida com mmap, evitando refazer o parse do
+// .geo a cada execução.
+// ===============================================
+
+/* -> carregar_snapshot
+    FUNÇÃO: preenche a lista de formas a partir de um snapshot, desde que ele
+    tenha sido gerado a partir da versão atual do .geo
+    RECEBE: caminho do snapshot, caminho do .geo de origem e a lista de formas
+    RETORNA: 0 se o snapshot foi usado, -1 se ele não existe, é inválido ou está desatualizado
+ */
+int carregar_snapshot(char* caminho_snapshot, char* caminho_geo, Lista* formas);
+
+/* -> salvar_snapshot
+    FUNÇÃO: grava o snapshot das formas carregadas de um .geo
+    RECEBE: caminho do snapshot, caminho do .geo de origem e a lista de formas
+    RETORNA: 0 se for executada com sucesso
+ */
+int salvar_snapshot(char* caminho_snapshot, char* caminho_geo, Lista* formas);
+
+#endif
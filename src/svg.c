@@ -19,6 +19,18 @@ FILE* criar_svg(char* nome_arquivo) {
     return svg;
 }
 
+// CRIAR_SVG_VIEWBOX
+FILE* criar_svg_viewbox(char* nome_arquivo, double x, double y, double largura, double altura) {
+    FILE* svg = fopen(nome_arquivo, "w");
+    if (svg == NULL) return NULL;
+    
+    fprintf(svg, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    fprintf(svg, "<svg width=\"%.2f\" height=\"%.2f\" viewBox=\"%.2f %.2f %.2f %.2f\" xmlns=\"http://www.w3.org/2000/svg\">\n",
+            largura, altura, x, y, largura, altura);
+    
+    return svg;
+}
+
 // FECHAR_SVG
 void fechar_svg(FILE* svg) {
     if (svg == NULL) return;
@@ -87,6 +99,26 @@ static void desenhar_texto(FILE* svg, Forma* f) {
     fprintf(svg, "%s</text>\n", texto);
 }
 
+// DESENHAR_FORMA
+void desenhar_forma(FILE* svg, Forma* f) {
+    if (svg == NULL || f == NULL) return;
+    
+    switch (forma_get_tipo(f)) {
+        case 'c':
+            desenhar_circulo(svg, f);
+            break;
+        case 'r':
+            desenhar_retangulo(svg, f);
+            break;
+        case 'l':
+            desenhar_linha(svg, f);
+            break;
+        case 't':
+            desenhar_texto(svg, f);
+            break;
+    }
+}
+
 // DESENHAR_FORMAS
 void desenhar_formas(FILE* svg, Lista* formas) {
     if (svg == NULL || formas == NULL) return;
@@ -97,22 +129,7 @@ void desenhar_formas(FILE* svg, Lista* formas) {
         Forma* f = (Forma*) get_elemento(formas, elem);
         
         if (f != NULL) {
-            char tipo = forma_get_tipo(f);
-            
-            switch (tipo) {
-                case 'c':
-                    desenhar_circulo(svg, f);
-                    break;
-                case 'r':
-                    desenhar_retangulo(svg, f);
-                    break;
-                case 'l':
-                    desenhar_linha(svg, f);
-                    break;
-                case 't':
-                    desenhar_texto(svg, f);
-                    break;
-            }
+            desenhar_forma(svg, f);
         }
         
         elem = get_proximo_elemento(elem);
@@ -120,21 +137,15 @@ void desenhar_formas(FILE* svg, Lista* formas) {
 }
 
 // DESENHAR_POLIGONO
-void desenhar_poligono(FILE* svg, Lista* vertices, char* corBorda, char* corPreench, double opacidade) {
-    if (svg == NULL || vertices == NULL || lista_vazia(vertices)) return;
+void desenhar_poligono(FILE* svg, Poligono* poligono, char* corBorda, char* corPreench, double opacidade) {
+    int n = poligono_tamanho(poligono);
+    if (svg == NULL || n == 0) return;
     
     fprintf(svg, "<polygon points=\"");
     
-    Elemento* elem = get_primeiro_elemento(vertices);
-    
-    while (elem != NULL) {
-        Ponto* p = (Ponto*) get_elemento(vertices, elem);
-        
-        if (p != NULL) {
-            fprintf(svg, "%.2f,%.2f ", get_x(p), get_y(p));
-        }
-        
-        elem = get_proximo_elemento(elem);
+    const double* xy = poligono_coordenadas(poligono);
+    for (int i = 0; i < n; i++) {
+        fprintf(svg, "%.2f,%.2f ", xy[2 * i], xy[2 * i + 1]);
     }
     
     fprintf(svg, "\" ");
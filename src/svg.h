@@ -7,6 +7,7 @@
 #include "lista.h"
 #include "formas.h"
 #include "geometria.h"
+#include "poligono.h"
 
 // ===========================================
 // SVG
@@ -25,6 +26,13 @@
  */
 FILE* criar_svg(char* nome_arquivo);
 
+/* -> criar_svg_viewbox
+    FUNÇÃO: criar arquivo SVG com cabeçalho limitado a uma janela de visualização
+    RECEBE: o nome do arquivo e a janela (x, y, largura, altura)
+    RETORNA: ponteiro para o arquivo aberto
+ */
+FILE* criar_svg_viewbox(char* nome_arquivo, double x, double y, double largura, double altura);
+
 /* -> fechar_svg
     FUNÇÃO: fechar arquivo SVG (escreve tag de fechamento)
     RECEBE: o arquivo
@@ -35,6 +43,12 @@ void fechar_svg(FILE* svg);
 //             DESENHO DE FORMAS
 // -----------------------------------------
 
+/* -> desenhar_forma
+    FUNÇÃO: desenhar uma forma no SVG
+    RECEBE: o arquivo e a forma
+ */
+void desenhar_forma(FILE* svg, Forma* f);
+
 /* -> desenhar_formas
     FUNÇÃO: desenhar todas as formas de uma lista no SVG
     RECEBE: o arquivo e a lista de formas
@@ -43,9 +57,9 @@ void desenhar_formas(FILE* svg, Lista* formas);
 
 /* -> desenhar_poligono
     FUNÇÃO: desenhar um polígono no SVG 
-    RECEBE: o arquivo, lista de vértices do polígono, cor da borda e de preenchimento e opacidade
+    RECEBE: o arquivo, o polígono, cor da borda e de preenchimento e opacidade
  */
-void desenhar_poligono(FILE* svg, Lista* vertices, char* corBorda, char* corPreench, double opacidade);
+void desenhar_poligono(FILE* svg, Poligono* poligono, char* corBorda, char* corPreench, double opacidade);
 
 /* -> desenhar_segmento
     FUNÇÃO: desenhar segmento no SVG
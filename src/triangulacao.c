@@ -0,0 +1,1033 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "triangulacao.h"
+#include "geometria.h"
+#include "segmento.h"
+#include "lista.h"
+#include "poligono.h"
+
+#define NULO -1
+#define EPSILON 1e-9
+#define LIMITE_PASSOS_BUSCA 100000
+#define LIMITE_RODADAS 1000
+
+#define PROX(i) (((i) + 1) % 3)
+#define ANT(i) (((i) + 2) % 3)
+
+// ESTRUTURA DE UM TRIÂNGULO
+// vértices em sentido anti-horário; a aresta i é a oposta ao vértice v[i],
+// que vai de v[i+1] a v[i+2]
+typedef struct {
+    int v[3];
+    int viz[3];     // triângulo do outro lado da aresta i (NULO na borda)
+    bool fixa[3];   // a aresta i é um anteparo ou a borda
+} Triangulo;
+
+// ARESTA (par de vértices)
+typedef struct {
+    int a, b;
+} Aresta;
+
+// LISTA DE ARESTAS
+typedef struct {
+    Aresta* v;
+    int n;
+    int cap;
+} ListaArestas;
+
+// TAREFA DA EXPANSÃO
+// o cone entre os raios que saem da origem pelos vértices dir e esq (NULO é a
+// direção (1, 0)) deixa o triângulo t pela aresta k
+typedef struct {
+    int t, k;
+    int dir, esq;
+} Tarefa;
+
+// PEDAÇO VISÍVEL DE UMA ARESTA FIXA (a < b são os vértices da aresta)
+typedef struct {
+    int a, b;
+    Ponto p1, p2;
+} Pedaco;
+
+// ANTEPARO DE UMA ARESTA FIXA (a < b são os vértices da aresta)
+// os pedaços de um anteparo dividido nos vértices que caem sobre ele apontam
+// todos para o anteparo inteiro
+typedef struct {
+    int a, b;
+    Segmento* s;
+} ArestaFixa;
+
+// RESULTADO DA BUSCA DE UM PONTO
+typedef enum {
+    LOCAL_DENTRO,
+    LOCAL_ARESTA,
+    LOCAL_VERTICE,
+    LOCAL_FORA
+} Local;
+
+// ESTRUTURA DA TRIANGULAÇÃO
+struct Triangulacao {
+    Ponto* pontos;
+    int* triangulo_do_ponto;   // algum triângulo que tem o vértice
+    int n_pontos;
+
+    Triangulo* tri;
+    int n_tri;
+    int cap_tri;
+
+    int ultimo;                // onde a última busca terminou
+    unsigned int semente;
+    double min_x, min_y, max_x, max_y;  // região dos anteparos
+
+    // os anteparos das arestas fixas (ordenados por vértices) e os lados do
+    // retângulo envolvente, para cortar os raios com a mesma conta da varredura
+    ArestaFixa* fixas;
+    int n_fixas;
+    int cap_fixas;
+    Segmento* borda[4];
+
+    // buffers reaproveitados entre as consultas
+    Tarefa* pilha;
+    int cap_pilha;
+    Pedaco* pedacos;
+    int n_pedacos;
+    int cap_pedacos;
+};
+
+// ===================
+// FUNÇÕES AUXILIARES
+// ===================
+
+// ORIENT
+static double orient(Triangulacao* T, int a, int b, int c) {
+    return orientacao_v(T->pontos[a], T->pontos[b], T->pontos[c]);
+}
+
+// NO_CIRCULO
+// positivo se d está dentro do círculo que passa por a, b e c (anti-horário)
+static double no_circulo(Ponto a, Ponto b, Ponto c, Ponto d) {
+    double adx = a.x - d.x, ady = a.y - d.y;
+    double bdx = b.x - d.x, bdy = b.y - d.y;
+    double cdx = c.x - d.x, cdy = c.y - d.y;
+
+    return (adx * adx + ady * ady) * (bdx * cdy - cdx * bdy) +
+           (bdx * bdx + bdy * bdy) * (cdx * ady - adx * cdy) +
+           (cdx * cdx + cdy * cdy) * (adx * bdy - bdx * ady);
+}
+
+// SORTEAR
+// xorshift: a busca escolhe por qual aresta começar, o que evita ciclos
+static unsigned int sortear(Triangulacao* T) {
+    unsigned int x = T->semente;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    T->semente = x;
+    return x;
+}
+
+// NOVO_TRIANGULO
+static int novo_triangulo(Triangulacao* T) {
+    if (T->n_tri == T->cap_tri) {
+        int nova_cap = T->cap_tri ? T->cap_tri * 2 : 64;
+        Triangulo* novo = (Triangulo*) realloc(T->tri, nova_cap * sizeof(Triangulo));
+        if (novo == NULL) return NULO;
+        T->tri = novo;
+        T->cap_tri = nova_cap;
+    }
+    return T->n_tri++;
+}
+
+// GRAVAR_TRIANGULO
+// escreve o triângulo t = (a, b, c) com os vizinhos e as marcas de cada aresta
+static void gravar_triangulo(Triangulacao* T, int t, int a, int b, int c,
+                             int viz_a, int viz_b, int viz_c, bool fixa_a, bool fixa_b, bool fixa_c) {
+    Triangulo* tr = &T->tri[t];
+    tr->v[0] = a;
+    tr->v[1] = b;
+    tr->v[2] = c;
+    tr->viz[0] = viz_a;
+    tr->viz[1] = viz_b;
+    tr->viz[2] = viz_c;
+    tr->fixa[0] = fixa_a;
+    tr->fixa[1] = fixa_b;
+    tr->fixa[2] = fixa_c;
+
+    T->triangulo_do_ponto[a] = t;
+    T->triangulo_do_ponto[b] = t;
+    T->triangulo_do_ponto[c] = t;
+}
+
+// TROCAR_VIZINHO
+static void trocar_vizinho(Triangulacao* T, int t, int antigo, int novo) {
+    if (t == NULO) return;
+
+    for (int k = 0; k < 3; k++) {
+        if (T->tri[t].viz[k] == antigo) {
+            T->tri[t].viz[k] = novo;
+            return;
+        }
+    }
+}
+
+// INDICE_VIZINHO
+// aresta de u que faz divisa com t
+static int indice_vizinho(Triangulacao* T, int u, int t) {
+    for (int k = 0; k < 3; k++) {
+        if (T->tri[u].viz[k] == t) return k;
+    }
+    return NULO;
+}
+
+// INDICE_VERTICE
+static int indice_vertice(Triangulacao* T, int t, int v) {
+    for (int k = 0; k < 3; k++) {
+        if (T->tri[t].v[k] == v) return k;
+    }
+    return NULO;
+}
+
+// ---------------------------
+// BUSCA E INSERÇÃO DE PONTOS
+// ---------------------------
+
+// LOCALIZAR
+// anda de triângulo em triângulo na direção de p, a partir do último visitado;
+// se a caminhada demorar demais, procura em todos
+static Local localizar(Triangulacao* T, Ponto p, int* tri, int* indice) {
+    int t = T->ultimo;
+    int passos = 0;
+
+    while (passos++ < LIMITE_PASSOS_BUSCA) {
+        Triangulo* tr = &T->tri[t];
+        int inicio = sortear(T) % 3;
+        int proximo = t;
+
+        for (int j = 0; j < 3; j++) {
+            int i = (inicio + j) % 3;
+            if (orientacao_v(T->pontos[tr->v[PROX(i)]], T->pontos[tr->v[ANT(i)]], p) < 0) {
+                if (tr->viz[i] == NULO) return LOCAL_FORA;
+                proximo = tr->viz[i];
+                break;
+            }
+        }
+
+        if (proximo == t) break;
+        t = proximo;
+    }
+
+    if (passos > LIMITE_PASSOS_BUSCA) {
+        for (t = 0; t < T->n_tri; t++) {
+            Triangulo* tr = &T->tri[t];
+            int k = 0;
+            while (k < 3 && orientacao_v(T->pontos[tr->v[PROX(k)]], T->pontos[tr->v[ANT(k)]], p) >= 0) k++;
+            if (k == 3) break;
+        }
+        if (t == T->n_tri) return LOCAL_FORA;
+    }
+
+    T->ultimo = t;
+    *tri = t;
+
+    Triangulo* tr = &T->tri[t];
+    for (int k = 0; k < 3; k++) {
+        Ponto v = T->pontos[tr->v[k]];
+        if (v.x == p.x && v.y == p.y) {
+            *indice = k;
+            return LOCAL_VERTICE;
+        }
+    }
+
+    for (int k = 0; k < 3; k++) {
+        if (orientacao_v(T->pontos[tr->v[PROX(k)]], T->pontos[tr->v[ANT(k)]], p) == 0) {
+            *indice = k;
+            return LOCAL_ARESTA;
+        }
+    }
+
+    return LOCAL_DENTRO;
+}
+
+// VIRAR
+// troca a aresta i de t pela outra diagonal do quadrilátero formado com o
+// vizinho; só vira se o quadrilátero for estritamente convexo. depois, o
+// vértice que era t.v[i] fica na posição 0 dos dois triângulos
+static bool virar(Triangulacao* T, int t, int i) {
+    Triangulo tt = T->tri[t];
+    int u = tt.viz[i];
+    if (u == NULO || tt.fixa[i]) return false;
+
+    Triangulo uu = T->tri[u];
+    int j = indice_vizinho(T, u, t);
+
+    int p = tt.v[i], a = tt.v[PROX(i)], b = tt.v[ANT(i)];
+    int d = uu.v[j];
+
+    if (orient(T, p, a, d) <= 0 || orient(T, p, d, b) <= 0) return false;
+
+    // em u: v[j] = d, v[j+1] = b, v[j+2] = a
+    int viz_na = tt.viz[PROX(i)], viz_nb = tt.viz[ANT(i)];
+    bool fixa_na = tt.fixa[PROX(i)], fixa_nb = tt.fixa[ANT(i)];
+    int viz_mb = uu.viz[PROX(j)], viz_ma = uu.viz[ANT(j)];
+    bool fixa_mb = uu.fixa[PROX(j)], fixa_ma = uu.fixa[ANT(j)];
+
+    gravar_triangulo(T, t, p, a, d, viz_mb, u, viz_nb, fixa_mb, false, fixa_nb);
+    gravar_triangulo(T, u, p, d, b, viz_ma, viz_na, t, fixa_ma, fixa_na, false);
+
+    trocar_vizinho(T, viz_mb, u, t);
+    trocar_vizinho(T, viz_na, t, u);
+    return true;
+}
+
+// LEGALIZAR
+// o ponto novo está em v[0] de t; se o vértice do outro lado da aresta oposta
+// cair no círculo de t, a aresta vira e os dois triângulos novos são testados
+static void legalizar(Triangulacao* T, int t) {
+    Triangulo* tr = &T->tri[t];
+    int u = tr->viz[0];
+    if (u == NULO || tr->fixa[0]) return;
+
+    int d = T->tri[u].v[indice_vizinho(T, u, t)];
+    if (no_circulo(T->pontos[tr->v[0]], T->pontos[tr->v[1]], T->pontos[tr->v[2]], T->pontos[d]) <= 0) return;
+    if (!virar(T, t, 0)) return;
+
+    legalizar(T, t);
+    legalizar(T, u);
+}
+
+// DIVIDIR_TRIANGULO
+// p cai dentro de t = (a, b, c): t vira (p, b, c) e surgem (p, c, a) e (p, a, b)
+static bool dividir_triangulo(Triangulacao* T, int t, int p) {
+    int t2 = novo_triangulo(T);
+    int t3 = novo_triangulo(T);
+    if (t2 == NULO || t3 == NULO) return false;
+
+    Triangulo tt = T->tri[t];
+    int a = tt.v[0], b = tt.v[1], c = tt.v[2];
+
+    gravar_triangulo(T, t,  p, b, c, tt.viz[0], t2, t3, tt.fixa[0], false, false);
+    gravar_triangulo(T, t2, p, c, a, tt.viz[1], t3, t,  tt.fixa[1], false, false);
+    gravar_triangulo(T, t3, p, a, b, tt.viz[2], t,  t2, tt.fixa[2], false, false);
+
+    trocar_vizinho(T, tt.viz[1], t, t2);
+    trocar_vizinho(T, tt.viz[2], t, t3);
+
+    legalizar(T, t);
+    legalizar(T, t2);
+    legalizar(T, t3);
+    return true;
+}
+
+// DIVIDIR_ARESTA
+// p cai sobre a aresta i de t = (a, b, c), com a = v[i]; o vizinho do outro
+// lado é u = (d, c, b). os dois viram quatro triângulos em volta de p
+static bool dividir_aresta(Triangulacao* T, int t, int i, int p) {
+    int u = T->tri[t].viz[i];
+    if (u == NULO) return false;
+
+    int t2 = novo_triangulo(T);
+    int t4 = novo_triangulo(T);
+    if (t2 == NULO || t4 == NULO) return false;
+
+    Triangulo tt = T->tri[t];
+    Triangulo uu = T->tri[u];
+    int j = indice_vizinho(T, u, t);
+
+    int a = tt.v[i], b = tt.v[PROX(i)], c = tt.v[ANT(i)];
+    int d = uu.v[j];
+
+    int viz_nb = tt.viz[PROX(i)], viz_nc = tt.viz[ANT(i)];
+    bool fixa_nb = tt.fixa[PROX(i)], fixa_nc = tt.fixa[ANT(i)];
+    int viz_mc = uu.viz[PROX(j)], viz_mb = uu.viz[ANT(j)];
+    bool fixa_mc = uu.fixa[PROX(j)], fixa_mb = uu.fixa[ANT(j)];
+    bool fixa_bc = tt.fixa[i];
+
+    gravar_triangulo(T, t,  p, c, a, viz_nb, t2, t4, fixa_nb, false, fixa_bc);
+    gravar_triangulo(T, t2, p, a, b, viz_nc, u,  t,  fixa_nc, fixa_bc, false);
+    gravar_triangulo(T, u,  p, b, d, viz_mc, t4, t2, fixa_mc, false, fixa_bc);
+    gravar_triangulo(T, t4, p, d, c, viz_mb, t,  u,  fixa_mb, fixa_bc, false);
+
+    trocar_vizinho(T, viz_nc, t, t2);
+    trocar_vizinho(T, viz_mb, u, t4);
+
+    legalizar(T, t);
+    legalizar(T, t2);
+    legalizar(T, u);
+    legalizar(T, t4);
+    return true;
+}
+
+// INSERIR_PONTO
+// retorna o índice do vértice (o que já existia, se o ponto se repete) ou NULO
+static int inserir_ponto(Triangulacao* T, Ponto p) {
+    int t, i;
+    Local onde = localizar(T, p, &t, &i);
+
+    if (onde == LOCAL_VERTICE) return T->tri[t].v[i];
+    if (onde == LOCAL_FORA) return NULO;
+
+    int novo = T->n_pontos++;
+    T->pontos[novo] = p;
+
+    bool ok = (onde == LOCAL_DENTRO) ? dividir_triangulo(T, t, novo) : dividir_aresta(T, t, i, novo);
+    if (!ok) {
+        T->n_pontos--;
+        return NULO;
+    }
+
+    T->ultimo = T->triangulo_do_ponto[novo];
+    return novo;
+}
+
+// ---------------------------
+// ARESTAS FIXAS (ANTEPAROS)
+// ---------------------------
+
+// ACHAR_ARESTA
+// gira em volta de x até achar o triângulo com a aresta (x, y); i é o índice
+// dela no triângulo
+static bool achar_aresta(Triangulacao* T, int x, int y, int* tri, int* indice) {
+    int inicio = T->triangulo_do_ponto[x];
+
+    // primeiro no sentido anti-horário; se bater na borda, no outro sentido
+    for (int sentido = 0; sentido < 2; sentido++) {
+        int t = inicio;
+
+        while (t != NULO) {
+            Triangulo* tr = &T->tri[t];
+            int k = indice_vertice(T, t, x);
+
+            if (tr->v[PROX(k)] == y) {
+                *tri = t;
+                *indice = ANT(k);
+                return true;
+            }
+            if (tr->v[ANT(k)] == y) {
+                *tri = t;
+                *indice = PROX(k);
+                return true;
+            }
+
+            t = (sentido == 0) ? tr->viz[PROX(k)] : tr->viz[ANT(k)];
+            if (t == inicio) return false;
+        }
+    }
+
+    return false;
+}
+
+// GUARDAR_ANTEPARO
+// anota que a aresta (x, y) pertence ao anteparo s
+static bool guardar_anteparo(Triangulacao* T, int x, int y, Segmento* s) {
+    if (T->n_fixas == T->cap_fixas) {
+        int nova_cap = T->cap_fixas ? T->cap_fixas * 2 : 64;
+        ArestaFixa* novo = (ArestaFixa*) realloc(T->fixas, nova_cap * sizeof(ArestaFixa));
+        if (novo == NULL) return false;
+        T->fixas = novo;
+        T->cap_fixas = nova_cap;
+    }
+
+    ArestaFixa* af = &T->fixas[T->n_fixas++];
+    af->a = x < y ? x : y;
+    af->b = x < y ? y : x;
+    af->s = s;
+    return true;
+}
+
+// COMPARAR_FIXAS
+static int comparar_fixas(const void* p1, const void* p2) {
+    const ArestaFixa* f1 = (const ArestaFixa*) p1;
+    const ArestaFixa* f2 = (const ArestaFixa*) p2;
+
+    if (f1->a != f2->a) return f1->a < f2->a ? -1 : 1;
+    if (f1->b != f2->b) return f1->b < f2->b ? -1 : 1;
+    return 0;
+}
+
+// ANTEPARO_DA_ARESTA
+// o anteparo da aresta fixa (x, y), ou NULL se ela não foi anotada
+static Segmento* anteparo_da_aresta(Triangulacao* T, int x, int y) {
+    ArestaFixa chave = { x < y ? x : y, x < y ? y : x, NULL };
+    ArestaFixa* af = (ArestaFixa*) bsearch(&chave, T->fixas, T->n_fixas, sizeof(ArestaFixa), comparar_fixas);
+
+    return af ? af->s : NULL;
+}
+
+// FIXAR_ARESTA
+static bool fixar_aresta(Triangulacao* T, int x, int y, Segmento* s) {
+    int t, i;
+    if (!achar_aresta(T, x, y, &t, &i)) return false;
+
+    T->tri[t].fixa[i] = true;
+    int u = T->tri[t].viz[i];
+    if (u != NULO) T->tri[u].fixa[indice_vizinho(T, u, t)] = true;
+
+    return guardar_anteparo(T, x, y, s);
+}
+
+// CRUZA
+// o segmento (c, d) cruza (a, b) fora das pontas
+static bool cruza(Triangulacao* T, int a, int b, int c, int d) {
+    if (c == a || c == b || d == a || d == b) return false;
+
+    double o1 = orient(T, a, b, c), o2 = orient(T, a, b, d);
+    if (!((o1 > 0 && o2 < 0) || (o1 < 0 && o2 > 0))) return false;
+
+    double o3 = orient(T, c, d, a), o4 = orient(T, c, d, b);
+    return (o3 > 0 && o4 < 0) || (o3 < 0 && o4 > 0);
+}
+
+// ADICIONAR_ARESTA
+static bool adicionar_aresta(ListaArestas* l, int a, int b) {
+    if (l->n == l->cap) {
+        int nova_cap = l->cap ? l->cap * 2 : 16;
+        Aresta* novo = (Aresta*) realloc(l->v, nova_cap * sizeof(Aresta));
+        if (novo == NULL) return false;
+        l->v = novo;
+        l->cap = nova_cap;
+    }
+
+    l->v[l->n].a = a;
+    l->v[l->n].b = b;
+    l->n++;
+    return true;
+}
+
+// CUNHA_NA_DIRECAO
+// procura, em volta de a, o triângulo cuja cunha contém a direção de b.
+// retorna 1 se a aresta (a, b) já existe, 2 se um vértice v fica no caminho
+// (sobre o segmento), 0 se achou a cunha (t, com a em v[k]) e -1 se não achou
+static int cunha_na_direcao(Triangulacao* T, int a, int b, int* tri, int* indice, int* v) {
+    int inicio = T->triangulo_do_ponto[a];
+    Ponto pa = T->pontos[a], pb = T->pontos[b];
+
+    for (int sentido = 0; sentido < 2; sentido++) {
+        int t = inicio;
+
+        while (t != NULO) {
+            Triangulo* tr = &T->tri[t];
+            int k = indice_vertice(T, t, a);
+            int x = tr->v[PROX(k)], y = tr->v[ANT(k)];
+
+            if (x == b || y == b) return 1;
+
+            double ox = orient(T, a, x, b);
+            double oy = orient(T, a, y, b);
+            Ponto px = T->pontos[x], py = T->pontos[y];
+
+            if (ox == 0 && (px.x - pa.x) * (pb.x - pa.x) + (px.y - pa.y) * (pb.y - pa.y) > 0) {
+                *v = x;
+                return 2;
+            }
+            if (oy == 0 && (py.x - pa.x) * (pb.x - pa.x) + (py.y - pa.y) * (pb.y - pa.y) > 0) {
+                *v = y;
+                return 2;
+            }
+            if (ox > 0 && oy < 0) {
+                *tri = t;
+                *indice = k;
+                return 0;
+            }
+
+            t = (sentido == 0) ? tr->viz[PROX(k)] : tr->viz[ANT(k)];
+            if (t == inicio) return -1;
+        }
+    }
+
+    return -1;
+}
+
+// COLETAR_CRUZAMENTOS
+// anda de a na direção de b guardando as arestas cruzadas. para no vértice b
+// ou no primeiro vértice que cair sobre o segmento (fim); falha se cruzar uma
+// aresta fixa (dois anteparos se cruzando)
+static bool coletar_cruzamentos(Triangulacao* T, int a, int b, int t, int k, ListaArestas* cruzadas, int* fim) {
+    int dir = T->tri[t].v[PROX(k)];
+    int esq = T->tri[t].v[ANT(k)];
+    int atual = t, saida = k;
+
+    while (true) {
+        Triangulo* tr = &T->tri[atual];
+        if (tr->fixa[saida] || tr->viz[saida] == NULO) return false;
+        if (!adicionar_aresta(cruzadas, tr->v[PROX(saida)], tr->v[ANT(saida)])) return false;
+
+        int u = tr->viz[saida];
+        int c = T->tri[u].v[indice_vizinho(T, u, atual)];
+
+        if (c == b) {
+            *fim = b;
+            return true;
+        }
+
+        double oc = orient(T, a, b, c);
+        if (oc == 0) {
+            *fim = c;
+            return true;
+        }
+
+        // sai pela aresta que liga c ao vértice do lado oposto
+        if (oc > 0) {
+            saida = indice_vertice(T, u, esq);
+            esq = c;
+        }
+        else {
+            saida = indice_vertice(T, u, dir);
+            dir = c;
+        }
+        atual = u;
+    }
+}
+
+// VERTICE_OPOSTO
+static int vertice_oposto(Triangulacao* T, int t, int i) {
+    int u = T->tri[t].viz[i];
+    return T->tri[u].v[indice_vizinho(T, u, t)];
+}
+
+// FORCAR_ARESTA
+// vira as arestas que cruzam (a, fim) até ela aparecer (Sloan): um
+// quadrilátero não convexo volta para o fim da fila. depois, as diagonais
+// novas que não são de Delaunay são viradas de novo
+static bool forcar_aresta(Triangulacao* T, int a, int fim, ListaArestas* cruzadas, Segmento* s) {
+    ListaArestas fila = { NULL, 0, 0 };
+    ListaArestas novas = { NULL, 0, 0 };
+    bool ok = true;
+    int rodadas = 0;
+
+    while (ok && cruzadas->n > 0) {
+        bool virou = false;
+        fila.n = 0;
+
+        for (int e = 0; ok && e < cruzadas->n; e++) {
+            Aresta ar = cruzadas->v[e];
+            int t, i;
+
+            if (!achar_aresta(T, ar.a, ar.b, &t, &i)) {
+                ok = false;
+                break;
+            }
+
+            if (!virar(T, t, i)) {
+                ok = adicionar_aresta(&fila, ar.a, ar.b);
+                continue;
+            }
+
+            virou = true;
+            int p = T->tri[t].v[0], d = T->tri[t].v[2];
+            ok = cruza(T, a, fim, p, d) ? adicionar_aresta(&fila, p, d) : adicionar_aresta(&novas, p, d);
+        }
+
+        if (!virou || ++rodadas > LIMITE_RODADAS) ok = false;
+
+        ListaArestas aux = *cruzadas;
+        *cruzadas = fila;
+        fila = aux;
+    }
+
+    ok = ok && fixar_aresta(T, a, fim, s);
+
+    // restaura a propriedade de Delaunay em volta da aresta nova
+    for (int rodada = 0; ok && rodada < LIMITE_RODADAS; rodada++) {
+        bool virou = false;
+
+        for (int e = 0; e < novas.n; e++) {
+            int t, i;
+            if (!achar_aresta(T, novas.v[e].a, novas.v[e].b, &t, &i)) continue;
+
+            Triangulo* tr = &T->tri[t];
+            if (tr->fixa[i] || tr->viz[i] == NULO) continue;
+
+            int d = vertice_oposto(T, t, i);
+            if (no_circulo(T->pontos[tr->v[0]], T->pontos[tr->v[1]], T->pontos[tr->v[2]], T->pontos[d]) <= 0) continue;
+            if (!virar(T, t, i)) continue;
+
+            novas.v[e].a = T->tri[t].v[0];
+            novas.v[e].b = T->tri[t].v[2];
+            virou = true;
+        }
+
+        if (!virou) break;
+    }
+
+    free(fila.v);
+    free(novas.v);
+    return ok;
+}
+
+// INSERIR_RESTRICAO
+// torna o anteparo s, de a até b, uma aresta fixa, dividindo-o nos vértices
+// que estiverem exatamente sobre ele
+static bool inserir_restricao(Triangulacao* T, int a, int b, Segmento* s) {
+    ListaArestas cruzadas = { NULL, 0, 0 };
+    bool ok = true;
+
+    while (ok && a != b) {
+        int t = NULO, k = 0, v = NULO;
+        int caso = cunha_na_direcao(T, a, b, &t, &k, &v);
+
+        if (caso == 1) {
+            ok = fixar_aresta(T, a, b, s);
+            break;
+        }
+        if (caso == 2) {
+            ok = fixar_aresta(T, a, v, s);
+            a = v;
+            continue;
+        }
+        if (caso < 0) {
+            ok = false;
+            break;
+        }
+
+        int fim = b;
+        cruzadas.n = 0;
+        ok = coletar_cruzamentos(T, a, b, t, k, &cruzadas, &fim) && forcar_aresta(T, a, fim, &cruzadas, s);
+        a = fim;
+    }
+
+    free(cruzadas.v);
+    return ok;
+}
+
+// ------------------------------
+// EXPANSÃO DA VISIBILIDADE
+// ------------------------------
+
+// PONTO_LIMITE
+static Ponto ponto_limite(Triangulacao* T, int v, Ponto x) {
+    return (v == NULO) ? x : T->pontos[v];
+}
+
+// CRUZAR_RAIO
+// ponto em que o raio da origem q pelo vértice v (NULO é a direção (1, 0))
+// encontra a aresta fixa (a, b), ou padrao se o raio corre ao longo dela. o
+// corte é feito como na varredura: no anteparo inteiro e com a mesma conta, ou
+// a própria ponta do anteparo quando o raio passa por ela
+static Ponto cruzar_raio(Triangulacao* T, Ponto q, int v, int a, int b, Ponto padrao) {
+    Segmento* s = anteparo_da_aresta(T, a, b);
+    if (s == NULL) return padrao;
+
+    Ponto alvo = (v == NULO) ? ponto_xy(q.x + 1.0, q.y) : T->pontos[v];
+    double dx = alvo.x - q.x;
+    double dy = alvo.y - q.y;
+
+    Ponto pontas[2];
+    segmento_get_original(s, &pontas[0], &pontas[1]);
+    for (int k = 0; k < 2; k++) {
+        double frente = (pontas[k].x - q.x) * dx + (pontas[k].y - q.y) * dy;
+        if (frente > 0 && orientacao_v(q, alvo, pontas[k]) == 0) return pontas[k];
+    }
+
+    Ponto p;
+    if (!segmento_intersecao_raio_v(s, q, dx, dy, &p)) return padrao;
+
+    return p;
+}
+
+// EMPILHAR
+static bool empilhar(Triangulacao* T, int* n, int t, int k, int dir, int esq) {
+    if (*n == T->cap_pilha) {
+        int nova_cap = T->cap_pilha ? T->cap_pilha * 2 : 64;
+        Tarefa* novo = (Tarefa*) realloc(T->pilha, nova_cap * sizeof(Tarefa));
+        if (novo == NULL) return false;
+        T->pilha = novo;
+        T->cap_pilha = nova_cap;
+    }
+
+    Tarefa* tf = &T->pilha[(*n)++];
+    tf->t = t;
+    tf->k = k;
+    tf->dir = dir;
+    tf->esq = esq;
+    return true;
+}
+
+// EMITIR_PEDACO
+// guarda o trecho visível de uma aresta fixa; trechos seguidos da mesma aresta
+// (o cone passou por triângulos diferentes) viram um só
+static bool emitir_pedaco(Triangulacao* T, int a, int b, Ponto p1, Ponto p2) {
+    int menor = a < b ? a : b, maior = a < b ? b : a;
+
+    if (T->n_pedacos > 0) {
+        Pedaco* ultimo = &T->pedacos[T->n_pedacos - 1];
+        if (ultimo->a == menor && ultimo->b == maior && distancia_pontos_v(ultimo->p2, p1) <= EPSILON) {
+            ultimo->p2 = p2;
+            return true;
+        }
+    }
+
+    if (T->n_pedacos == T->cap_pedacos) {
+        int nova_cap = T->cap_pedacos ? T->cap_pedacos * 2 : 64;
+        Pedaco* novo = (Pedaco*) realloc(T->pedacos, nova_cap * sizeof(Pedaco));
+        if (novo == NULL) return false;
+        T->pedacos = novo;
+        T->cap_pedacos = nova_cap;
+    }
+
+    Pedaco* pd = &T->pedacos[T->n_pedacos++];
+    pd->a = menor;
+    pd->b = maior;
+    pd->p1 = p1;
+    pd->p2 = p2;
+    return true;
+}
+
+// EMITIR_VERTICE
+// um vértice que divide cones é visto e fica no contorno entre os pedaços dos
+// dois lados, como na varredura. se um anteparo sai dele ao longo do raio,
+// nenhum pedaço passa por ali e só ele marca a ponta da fenda
+static bool emitir_vertice(Triangulacao* T, int v) {
+    return emitir_pedaco(T, v, v, T->pontos[v], T->pontos[v]);
+}
+
+// EXPANDIR
+// segue o cone (dir, esq) que sai de t pela aresta k. cada triângulo
+// atravessado divide o cone no vértice oposto, se ele cair dentro; o lado
+// direito é resolvido antes, então os pedaços saem em sentido anti-horário.
+// a tarefa com t NULO emite o vértice dir entre os dois lados
+static bool expandir(Triangulacao* T, Ponto q, Ponto x, int t, int k, int dir, int esq) {
+    int n = 0;
+    if (!empilhar(T, &n, t, k, dir, esq)) return false;
+
+    while (n > 0) {
+        Tarefa tf = T->pilha[--n];
+        if (tf.t == NULO) {
+            if (!emitir_vertice(T, tf.dir)) return false;
+            continue;
+        }
+
+        Triangulo* tr = &T->tri[tf.t];
+        int e_dir = tr->v[PROX(tf.k)], e_esq = tr->v[ANT(tf.k)];
+
+        if (tr->fixa[tf.k] || tr->viz[tf.k] == NULO) {
+            Ponto a = T->pontos[e_dir], b = T->pontos[e_esq];
+            Ponto p1 = cruzar_raio(T, q, tf.dir, e_dir, e_esq, a);
+            Ponto p2 = cruzar_raio(T, q, tf.esq, e_dir, e_esq, b);
+
+            if (!emitir_pedaco(T, e_dir, e_esq, p1, p2)) return false;
+            continue;
+        }
+
+        // no vizinho u, a aresta de entrada é m e o vértice oposto é c; a
+        // aresta da direita (m+1) vai até c e a da esquerda (m+2) sai dele
+        int u = tr->viz[tf.k];
+        int m = indice_vizinho(T, u, tf.t);
+        int c = T->tri[u].v[m];
+
+        double o_dir = orientacao_v(q, ponto_limite(T, tf.dir, x), T->pontos[c]);
+        double o_esq = orientacao_v(q, ponto_limite(T, tf.esq, x), T->pontos[c]);
+        bool ok;
+
+        if (o_dir <= 0) {
+            // no raio da direita, c vem logo depois do vértice que abriu o cone
+            ok = (o_dir < 0 || emitir_vertice(T, c)) && empilhar(T, &n, u, ANT(m), tf.dir, tf.esq);
+        }
+        else if (o_esq >= 0) {
+            ok = empilhar(T, &n, u, PROX(m), tf.dir, tf.esq);
+        }
+        else {
+            ok = empilhar(T, &n, u, ANT(m), c, tf.esq) && empilhar(T, &n, NULO, 0, c, c) &&
+                 empilhar(T, &n, u, PROX(m), tf.dir, c);
+        }
+
+        if (!ok) return false;
+    }
+
+    return true;
+}
+
+// ACRESCENTAR_PONTO
+// como na varredura, um ponto igual ao último acrescentado é descartado
+static void acrescentar_ponto(Poligono* poligono, Ponto p) {
+    int n = poligono_tamanho(poligono);
+    if (n > 0 && distancia_pontos_v(poligono_vertice(poligono, n - 1), p) <= EPSILON) return;
+
+    poligono_adicionar(poligono, p.x, p.y);
+}
+
+// --------------------------------
+// FUNÇÕES DE CRIAÇÃO E DESTRUIÇÃO
+// --------------------------------
+
+// CRIAR_TRIANGULACAO
+Triangulacao* criar_triangulacao(Lista* anteparos) {
+    int n_seg = anteparos ? lista_tamanho(anteparos) : 0;
+    if (n_seg == 0) return NULL;
+
+    Triangulacao* T = (Triangulacao*) calloc(1, sizeof(Triangulacao));
+    int* extremos = (int*) malloc(2 * n_seg * sizeof(int));
+    if (T == NULL || extremos == NULL) {
+        free(T);
+        free(extremos);
+        return NULL;
+    }
+
+    int cap_pontos = 2 * n_seg + 4;
+    T->pontos = (Ponto*) malloc(cap_pontos * sizeof(Ponto));
+    T->triangulo_do_ponto = (int*) malloc(cap_pontos * sizeof(int));
+    T->tri = (Triangulo*) malloc(2 * cap_pontos * sizeof(Triangulo));
+    T->cap_tri = 2 * cap_pontos;
+    T->semente = 2463534242u;
+
+    if (!T->pontos || !T->triangulo_do_ponto || !T->tri) {
+        free(extremos);
+        destruir_triangulacao(T);
+        return NULL;
+    }
+
+    // região dos anteparos e o mesmo retângulo envolvente da varredura
+    T->min_x = T->min_y = 1e18;
+    T->max_x = T->max_y = -1e18;
+
+    Elemento* elem = get_primeiro_elemento(anteparos);
+    while (elem != NULL) {
+        double min_x, min_y, max_x, max_y;
+        segmento_get_bbox((Segmento*) get_elemento(anteparos, elem), &min_x, &min_y, &max_x, &max_y);
+        if (min_x < T->min_x) T->min_x = min_x;
+        if (min_y < T->min_y) T->min_y = min_y;
+        if (max_x > T->max_x) T->max_x = max_x;
+        if (max_y > T->max_y) T->max_y = max_y;
+        elem = get_proximo_elemento(elem);
+    }
+
+    double delta = fmax(T->max_x - T->min_x, T->max_y - T->min_y) * 0.5 + 500;
+    T->pontos[0] = ponto_xy(T->min_x - delta, T->min_y - delta);
+    T->pontos[1] = ponto_xy(T->max_x + delta, T->min_y - delta);
+    T->pontos[2] = ponto_xy(T->max_x + delta, T->max_y + delta);
+    T->pontos[3] = ponto_xy(T->min_x - delta, T->max_y + delta);
+    T->n_pontos = 4;
+
+    // os lados do retângulo, na ordem e no sentido dos lados da varredura
+    bool ok = true;
+    for (int k = 0; k < 4; k++) {
+        T->borda[k] = criar_segmento(-(k + 1), &T->pontos[k], &T->pontos[(k + 1) % 4], NULL);
+        ok = ok && T->borda[k] != NULL && guardar_anteparo(T, k, (k + 1) % 4, T->borda[k]);
+    }
+
+    T->n_tri = 2;
+    gravar_triangulo(T, 0, 0, 1, 2, NULO, 1, NULO, true, false, true);
+    gravar_triangulo(T, 1, 0, 2, 3, NULO, NULO, 0, true, true, false);
+    T->ultimo = 0;
+
+    // primeiro todos os vértices, depois as arestas fixas
+    int n_extremos = 0;
+
+    elem = get_primeiro_elemento(anteparos);
+    while (ok && elem != NULL) {
+        Segmento* s = (Segmento*) get_elemento(anteparos, elem);
+        int a = inserir_ponto(T, *segmento_get_inicio(s));
+        int b = inserir_ponto(T, *segmento_get_fim(s));
+
+        ok = (a != NULO && b != NULO);
+        extremos[n_extremos++] = a;
+        extremos[n_extremos++] = b;
+        elem = get_proximo_elemento(elem);
+    }
+
+    elem = get_primeiro_elemento(anteparos);
+    for (int i = 0; ok && i < n_extremos; i += 2) {
+        ok = inserir_restricao(T, extremos[i], extremos[i + 1], (Segmento*) get_elemento(anteparos, elem));
+        elem = get_proximo_elemento(elem);
+    }
+
+    free(extremos);
+    if (ok) qsort(T->fixas, T->n_fixas, sizeof(ArestaFixa), comparar_fixas);
+
+    if (!ok) {
+        fprintf(stderr, "não foi possível triangular os anteparos\n");
+        destruir_triangulacao(T);
+        return NULL;
+    }
+
+    return T;
+}
+
+// DESTRUIR_TRIANGULACAO
+void destruir_triangulacao(Triangulacao* t) {
+    if (t == NULL) return;
+
+    free(t->pontos);
+    free(t->triangulo_do_ponto);
+    free(t->tri);
+    free(t->pilha);
+    free(t->pedacos);
+    free(t->fixas);
+    for (int k = 0; k < 4; k++) destruir_segmento(t->borda[k]);
+    free(t);
+}
+
+// --------------
+// FUNÇÕES BUSCA
+// --------------
+
+// TRIANGULACAO_VISIBILIDADE
+Poligono* triangulacao_visibilidade(Triangulacao* T, Ponto* origem) {
+    if (T == NULL || origem == NULL) return NULL;
+
+    Ponto q = *origem;
+    if (q.x < T->min_x || q.x > T->max_x || q.y < T->min_y || q.y > T->max_y) return NULL;
+
+    int t, i;
+    if (localizar(T, q, &t, &i) != LOCAL_DENTRO) return NULL;
+
+    // a volta começa e termina na direção (1, 0), representada por x
+    Ponto x = ponto_xy(q.x + 1.0, q.y);
+    if (x.x <= q.x) return NULL;
+
+    Triangulo tr = T->tri[t];
+    int k0 = 0;
+    double o_ini = 0.0;
+
+    for (int k = 0; k < 3; k++) {
+        Ponto dir = T->pontos[tr.v[PROX(k)]];
+        Ponto esq = T->pontos[tr.v[ANT(k)]];
+        double o = orientacao_v(q, dir, x);
+
+        if ((o > 0 || (o == 0 && dir.x > q.x)) && orientacao_v(q, x, esq) > 0) {
+            k0 = k;
+            o_ini = o;
+            break;
+        }
+    }
+
+    T->n_pedacos = 0;
+    int k1 = PROX(k0), k2 = ANT(k0);
+
+    bool ok = (o_ini != 0 || emitir_vertice(T, tr.v[PROX(k0)])) &&
+              expandir(T, q, x, t, k0, NULO, tr.v[ANT(k0)]) && emitir_vertice(T, tr.v[ANT(k0)]) &&
+              expandir(T, q, x, t, k1, tr.v[PROX(k1)], tr.v[ANT(k1)]) && emitir_vertice(T, tr.v[ANT(k1)]) &&
+              expandir(T, q, x, t, k2, tr.v[PROX(k2)], tr.v[ANT(k2)]) &&
+              (o_ini == 0 || (emitir_vertice(T, tr.v[PROX(k0)]) && expandir(T, q, x, t, k0, tr.v[PROX(k0)], NULO)));
+
+    if (!ok) return NULL;
+
+    Poligono* poligono = criar_poligono(2 * T->n_pedacos);
+    if (poligono == NULL) return NULL;
+
+    // o primeiro e o último pedaço podem ser a mesma aresta cortada em (1, 0);
+    // como na varredura, o polígono começa no primeiro evento depois dessa direção
+    int n = T->n_pedacos;
+    Pedaco* pd = T->pedacos;
+    bool volta = n >= 2 && pd[0].a == pd[n - 1].a && pd[0].b == pd[n - 1].b &&
+                 distancia_pontos_v(pd[n - 1].p2, pd[0].p1) <= EPSILON;
+
+    if (volta) {
+        acrescentar_ponto(poligono, pd[0].p2);
+        for (int j = 1; j < n - 1; j++) {
+            acrescentar_ponto(poligono, pd[j].p1);
+            acrescentar_ponto(poligono, pd[j].p2);
+        }
+        acrescentar_ponto(poligono, pd[n - 1].p1);
+    }
+    else {
+        for (int j = 0; j < n; j++) {
+            acrescentar_ponto(poligono, pd[j].p1);
+            acrescentar_ponto(poligono, pd[j].p2);
+        }
+    }
+
+    return poligono;
+}
@@ -0,0 +1,61 @@
+#ifndef TRIANGULACAO_H
+#define TRIANGULACAO_H
+
+#include "geometria.h"
+#include "lista.h"
+#include "poligono.h"
+
+// ===============================================
+// TRIANGULAÇÃO DOS ANTEPAROS
+// ----------------------------------------------
+// triangulação de Delaunay restrita: os extremos
+// dos anteparos (já sem cruzamentos) são os
+// vértices e cada anteparo vira uma aresta fixa.
+// é montada uma vez por conjunto de anteparos;
+// depois, a visibilidade de uma origem é achada
+// expandindo a partir do triângulo que a contém,
+// de vizinho em vizinho, até bater em arestas
+// fixas. o custo acompanha o tamanho da resposta,
+// não o total de anteparos.
+// ===============================================
+
+// ESTRUTURA DA TRIANGULAÇÃO
+typedef struct Triangulacao Triangulacao;
+
+// --------------------------------
+// FUNÇÕES DE CRIAÇÃO E DESTRUIÇÃO
+// --------------------------------
+
+/* -> criar_triangulacao
+    FUNÇÃO: triangula os anteparos dentro do mesmo retângulo envolvente que a
+    varredura usa para origens dentro da região dos anteparos
+    RECEBE: lista de segmentos sem cruzamentos (só se tocam pelas pontas). as
+    arestas fixas guardam os segmentos, para cortar os raios como a varredura,
+    então eles precisam durar tanto quanto a triangulação
+    RETORNA: ponteiro para a triangulação, ou NULL se a lista estiver vazia,
+    faltar memória ou dois anteparos se cruzarem
+*/
+Triangulacao* criar_triangulacao(Lista* anteparos);
+
+/* -> destruir_triangulacao
+    FUNÇÃO: destrói a triangulação (os anteparos não são tocados)
+    RECEBE: a triangulação
+*/
+void destruir_triangulacao(Triangulacao* t);
+
+// --------------
+// FUNÇÕES BUSCA
+// --------------
+
+/* -> triangulacao_visibilidade
+    FUNÇÃO: calcula a região de visibilidade de uma origem por expansão nos
+    triângulos. os pontos saem no mesmo sentido e a partir da mesma direção
+    (1, 0) que os de calcular_visibilidade
+    RECEBE: a triangulação e a origem
+    RETORNA: o polígono de visibilidade, ou NULL se a origem estiver fora da
+    região dos anteparos, sobre uma aresta ou vértice da triangulação, ou se
+    faltar memória (nesses casos a varredura deve ser usada)
+*/
+Poligono* triangulacao_visibilidade(Triangulacao* t, Ponto* origem);
+
+#endif
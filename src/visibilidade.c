@@ -3,6 +3,7 @@
 #include <math.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "visibilidade.h"
 #include "ordenacao.h"
@@ -10,12 +11,15 @@
 #include "segmento.h"
 #include "arvore.h"
 #include "lista.h"
+#include "poligono.h"
 
 #ifndef M_PI
     #define M_PI 3.14159265358979323846
 #endif
 
 #define EPSILON 1e-9
+#define JANELA_REPARO 16
+#define PASSOS_CIRCULO 64   // lados do polígono que aproxima o círculo de alcance
 
 // TIPOS DE VÉRTICE
 typedef enum {
@@ -23,123 +27,304 @@ typedef enum {
     TIPO_FIM
 } TipoVertice;
 
+// INCIDÊNCIA DE UM SEGMENTO NUM VÉRTICE
+typedef struct {
+    Segmento* segmento;
+    TipoVertice tipo;
+} Incidencia;
+
 // ESTRUTURA DO VERTICE
+// um extremo de segmento sem repetição: cantos compartilhados por vários
+// segmentos viram um único evento, que sabe quais segmentos começam e quais
+// terminam nele (incidências consecutivas na tabela)
 struct Vertice {
-    TipoVertice tipo;
-    Segmento* segmento;
     Ponto* ponto;
-    double angulo;
+    double dx, dy;       // direção da origem até o ponto (ordenada sem atan2)
     double distancia;
+    int primeira;        // índice da primeira incidência do vértice
+    int n_incidencias;
 };
 
-// ORIGEM GLOBAL (usada em comparação)
-static Ponto* ponto_origem_global = NULL;
+// TABELA DE VÉRTICES
+typedef struct {
+    Vertice* vertices;
+    int n_vertices;
+    Incidencia* incidencias; // duas por segmento, agrupadas por vértice
+    int n_incidencias;
+} TabelaVertices;
+
+// ORDEM DA ÚLTIMA VARREDURA
+// coordenadas dos vértices na ordem em que a chamada anterior os deixou:
+// bombas próximas umas das outras geram quase a mesma ordem angular, que
+// então só precisa ser reparada
+static Ponto* ordem_anterior = NULL;
+static int n_ordem_anterior = 0;
+static int cap_ordem_anterior = 0;
+
+// DIREÇÃO DO RAIO INICIAL
+// a varredura começa no eixo x; a de um setor começa na borda dele, e os
+// ângulos dos vértices passam a ser medidos a partir dela
+static double inicio_dx = 1.0;
+static double inicio_dy = 0.0;
 
 // ===================
 // FUNÇÕES AUXILIARES
 // ===================
 
-// CRIAR_VERTICE
-static Vertice* criar_vertice(TipoVertice tipo, Segmento* seg, Ponto* p, Ponto* origem) {
-    Vertice* v = (Vertice*) malloc(sizeof(Vertice));
-    if (!v) return NULL;
-    
-    v->tipo = tipo;
-    v->segmento = seg;
+// COMPARAR_NA_VARREDURA
+static int comparar_na_varredura(double dx1, double dy1, double dx2, double dy2) {
+    return comparar_direcoes_a_partir(inicio_dx, inicio_dy, dx1, dy1, dx2, dy2);
+}
+
+// INICIAR_VERTICE
+static void iniciar_vertice(Vertice* v, Ponto* p, Ponto* origem) {
     v->ponto = p;
-    v->angulo = atan2(get_y(p) - get_y(origem), get_x(p) - get_x(origem));
+    v->dx = get_x(p) - get_x(origem);
+    v->dy = get_y(p) - get_y(origem);
     v->distancia = distancia_pontos(origem, p);
-    
-    while (v->angulo < 0) v->angulo += 2 * M_PI;
-    
-    return v;
+    v->primeira = 0;
+    v->n_incidencias = 0;
 }
 
-// DESTRUIR_VERTICE
-static void destruir_vertice(Vertice* v) {
-    if (v) free(v);
+// HASH_PONTO
+// espalha os bits das duas coordenadas (-0.0 e 0.0 caem no mesmo lugar)
+static uint64_t hash_ponto(double x, double y) {
+    uint64_t a, b;
+    x += 0.0;
+    y += 0.0;
+    memcpy(&a, &x, sizeof(a));
+    memcpy(&b, &y, sizeof(b));
+    
+    uint64_t h = a * 0x9E3779B97F4A7C15ULL ^ (b + 0x632BE59BD9B4E019ULL + (a << 6) + (a >> 2));
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    return h;
 }
 
-// VERTICE_ENCOBERTO
-static bool vertice_encoberto(Vertice* v, Arvore* segs_ativos) { 
-    if (!v || arvore_vazia(segs_ativos)) return false;
-
-    Segmento* seg_proximo = segmento_mais_proximo(segs_ativos, v->angulo); 
-    if (!seg_proximo || seg_proximo == v->segmento) return false;
+// BUSCAR_OU_INSERIR_VERTICE
+// endereçamento aberto sobre os índices dos vértices (-1 marca posição livre)
+static int buscar_ou_inserir_vertice(TabelaVertices* t, int* posicoes, uint64_t mascara, Ponto* p, Ponto* origem) {
+    double x = get_x(p), y = get_y(p);
+    uint64_t i = hash_ponto(x, y) & mascara;
+    
+    while (posicoes[i] >= 0) {
+        Ponto* q = t->vertices[posicoes[i]].ponto;
+        if (get_x(q) == x && get_y(q) == y) return posicoes[i];
+        i = (i + 1) & mascara;
+    }
+    
+    int novo = t->n_vertices++;
+    iniciar_vertice(&t->vertices[novo], p, origem);
+    posicoes[i] = novo;
+    return novo;
+}
 
-    Ponto* origem = ponto_origem_global;
-    Ponto* p_int = segmento_intersecao_raio(seg_proximo, origem, v->angulo);
+// LIBERAR_TABELA_VERTICES
+static void liberar_tabela_vertices(TabelaVertices* t) {
+    free(t->vertices);
+    free(t->incidencias);
+    t->vertices = NULL;
+    t->incidencias = NULL;
+}
 
-    if (p_int) {
-        double dist_int = distancia_pontos(origem, p_int);
-        destruir_ponto(p_int);
+// ADICIONAR_AO_POLIGONO
+// acrescenta o ponto ao polígono, a menos que coincida com o último vértice
+static void adicionar_ao_poligono(Poligono* poligono, Ponto p) {
+    int n = poligono_tamanho(poligono);
+    if (n > 0 && distancia_pontos_v(poligono_vertice(poligono, n - 1), p) <= EPSILON) return;
+    
+    poligono_adicionar(poligono, p.x, p.y);
+}
 
-        return dist_int < v->distancia - EPSILON;
+// CORTAR_NO_GRUPO
+// ponto em que o raio do grupo de vértices [ini, fim) corta o segmento. se
+// uma ponta do anteparo está no grupo o corte é ela mesma: a conta daria
+// pontos diferentes conforme o anteparo escolhido entre os que se encontram ali
+static bool cortar_no_grupo(Segmento* s, Ponto o, Vertice** grupo, int ini, int fim, Ponto* saida) {
+    for (int k = ini; k < fim; k++) {
+        if (segmento_ponta_original(s, *grupo[k]->ponto)) {
+            *saida = *grupo[k]->ponto;
+            return true;
+        }
     }
     
-    return false;
+    return segmento_intersecao_raio_v(s, o, grupo[ini]->dx, grupo[ini]->dy, saida);
+}
+
+// CRUZA_RAIO_INICIAL
+// o raio inicial sai da origem na direção (inicio_dx, inicio_dy), em geral (1, 0).
+// um segmento o cruza quando vai de um ponto abaixo dele (lado < 0) para um
+// ponto acima ou sobre ele (lado >= 0) passando à frente da origem, isto é,
+// girando no sentido anti-horário
+static bool cruza_raio_inicial(Vertice* a, Vertice* b) {
+    double lado_a = inicio_dx * a->dy - inicio_dy * a->dx;
+    double lado_b = inicio_dx * b->dy - inicio_dy * b->dx;
+    
+    if ((lado_a < 0) == (lado_b < 0)) return false;
+    
+    Vertice* abaixo = (lado_a < 0) ? a : b;
+    Vertice* outro = (lado_a < 0) ? b : a;
+    
+    return orientacao_v(ponto_xy(0.0, 0.0), ponto_xy(abaixo->dx, abaixo->dy),
+                        ponto_xy(outro->dx, outro->dy)) > 0;
 }
 
 // EXTRAIR_VERTICES
-static Lista* extrair_vertices(Lista* segmentos, Ponto* origem) { 
-    Lista* vertices = criar_lista();
-    if (!vertices) return NULL;
+// monta a tabela com os extremos dos segmentos sem repetição e, para cada um,
+// os segmentos que começam e terminam nele. além disso, devolve em iniciais os
+// segmentos que cruzam o raio inicial; neles o intervalo angular dá a volta por 0,
+// então o início e o fim são trocados e o segmento já começa ativo
+static bool extrair_vertices(Lista* segmentos, Ponto* origem, TabelaVertices* t, Segmento** iniciais, int* n_iniciais) { 
+    int m = lista_tamanho(segmentos);
+    
+    t->n_vertices = 0;
+    t->n_incidencias = 0;
+    t->vertices = (Vertice*) malloc(2 * m * sizeof(Vertice));
+    t->incidencias = (Incidencia*) malloc(2 * m * sizeof(Incidencia));
+    
+    uint64_t cap = 16;
+    while (cap < (uint64_t) 4 * m) cap <<= 1;
+    int* posicoes = (int*) malloc(cap * sizeof(int));
+    
+    // incidências na ordem dos segmentos, com o vértice de cada uma
+    Incidencia* ocorrencias = (Incidencia*) malloc(2 * m * sizeof(Incidencia));
+    int* vertice_da_ocorrencia = (int*) malloc(2 * m * sizeof(int));
+    
+    if (!t->vertices || !t->incidencias || !posicoes || !ocorrencias || !vertice_da_ocorrencia) {
+        free(posicoes);
+        free(ocorrencias);
+        free(vertice_da_ocorrencia);
+        liberar_tabela_vertices(t);
+        return false;
+    }
+    
+    memset(posicoes, 0xFF, cap * sizeof(int));
+    *n_iniciais = 0;
+    int n_ocorrencias = 0;
     
     Elemento* elem = get_primeiro_elemento(segmentos);
     while (elem != NULL) {
         Segmento* seg = (Segmento*) get_elemento(segmentos, elem); 
         
         if (seg) {
-            Ponto* ini = segmento_get_inicio(seg); 
-            Ponto* fim = segmento_get_fim(seg); 
+            int i_ini = buscar_ou_inserir_vertice(t, posicoes, cap - 1, segmento_get_inicio(seg), origem);
+            int i_fim = buscar_ou_inserir_vertice(t, posicoes, cap - 1, segmento_get_fim(seg), origem);
+            Vertice* v_ini = &t->vertices[i_ini];
+            Vertice* v_fim = &t->vertices[i_fim];
             
-            Vertice* v_ini = criar_vertice(TIPO_INICIO, seg, ini, origem);
-            Vertice* v_fim = criar_vertice(TIPO_FIM, seg, fim, origem);
+            bool primeiro_ini = comparar_na_varredura(v_ini->dx, v_ini->dy, v_fim->dx, v_fim->dy) < 0;
             
-            if (v_ini->angulo < v_fim->angulo) { 
-                v_ini->tipo = TIPO_INICIO;
-                v_fim->tipo = TIPO_FIM;
-            }
-            else { 
-                v_fim->tipo = TIPO_INICIO;
-                v_ini->tipo = TIPO_FIM;
+            if (cruza_raio_inicial(v_ini, v_fim)) {
+                primeiro_ini = !primeiro_ini;
+                iniciais[(*n_iniciais)++] = seg;
             }
+            
+            ocorrencias[n_ocorrencias].segmento = seg;
+            ocorrencias[n_ocorrencias].tipo = primeiro_ini ? TIPO_INICIO : TIPO_FIM;
+            vertice_da_ocorrencia[n_ocorrencias++] = i_ini;
+            
+            ocorrencias[n_ocorrencias].segmento = seg;
+            ocorrencias[n_ocorrencias].tipo = primeiro_ini ? TIPO_FIM : TIPO_INICIO;
+            vertice_da_ocorrencia[n_ocorrencias++] = i_fim;
+        }
+        
+        elem = get_proximo_elemento(elem);
+    }
+    
+    // agrupa as incidências por vértice (contagem + soma de prefixos)
+    for (int k = 0; k < n_ocorrencias; k++) {
+        t->vertices[vertice_da_ocorrencia[k]].n_incidencias++;
+    }
+    
+    int acumulado = 0;
+    for (int v = 0; v < t->n_vertices; v++) {
+        t->vertices[v].primeira = acumulado;
+        acumulado += t->vertices[v].n_incidencias;
+        t->vertices[v].n_incidencias = 0;
+    }
+    
+    for (int k = 0; k < n_ocorrencias; k++) {
+        Vertice* v = &t->vertices[vertice_da_ocorrencia[k]];
+        t->incidencias[v->primeira + v->n_incidencias++] = ocorrencias[k];
+    }
+    t->n_incidencias = n_ocorrencias;
+    
+    free(posicoes);
+    free(ocorrencias);
+    free(vertice_da_ocorrencia);
+    return true;
+}
+
+// COMPARAR_GRUPOS
+static int comparar_grupos(const void* a, const void* b) {
+    int g1 = *(const int*) a, g2 = *(const int*) b;
+    return (g1 > g2) - (g1 < g2);
+}
 
-            if (v_ini) inserir_fim_lista(vertices, v_ini);
-            if (v_fim) inserir_fim_lista(vertices, v_fim);
+// COPIAR_ARESTAS_DE_FRENTE
+// copia os segmentos para destino, descartando as arestas de formas fechadas
+// que estão de costas para a origem: numa forma convexa vista de fora elas ficam
+// sempre atrás das arestas de frente. se nenhuma aresta do grupo está de frente
+// (origem dentro ou sobre a forma), o grupo é mantido inteiro. os grupos são
+// reconhecidos pelo id guardado no segmento, em qualquer posição da lista
+static void copiar_arestas_de_frente(Lista* segmentos, Lista* destino, Ponto origem) {
+    int n = 0;
+    Elemento* elem = get_primeiro_elemento(segmentos);
+    while (elem != NULL) {
+        if (segmento_get_grupo((Segmento*) get_elemento(segmentos, elem)) >= 0) n++;
+        elem = get_proximo_elemento(elem);
+    }
+    
+    // primeira passada: os grupos com alguma aresta de frente
+    int* de_fora = (n > 0) ? (int*) malloc(n * sizeof(int)) : NULL;
+    int n_de_fora = 0;
+    
+    elem = get_primeiro_elemento(segmentos);
+    while (de_fora != NULL && elem != NULL) {
+        Segmento* seg = (Segmento*) get_elemento(segmentos, elem);
+        if (segmento_get_grupo(seg) >= 0 && segmento_face(seg, origem) < 0) {
+            de_fora[n_de_fora++] = segmento_get_grupo(seg);
         }
+        elem = get_proximo_elemento(elem);
+    }
+    if (n_de_fora > 1) qsort(de_fora, n_de_fora, sizeof(int), comparar_grupos);
+    
+    // segunda passada: copia, sem as de costas dos grupos vistos de fora (sem
+    // memória para a tabela, copia tudo: só perde o descarte)
+    elem = get_primeiro_elemento(segmentos);
+    while (elem != NULL) {
+        Segmento* seg = (Segmento*) get_elemento(segmentos, elem);
+        int grupo = segmento_get_grupo(seg);
+        
+        bool descartar = grupo >= 0 && n_de_fora > 0 && segmento_face(seg, origem) > 0 &&
+                         bsearch(&grupo, de_fora, n_de_fora, sizeof(int), comparar_grupos) != NULL;
+        if (!descartar) inserir_fim_lista(destino, seg);
         
         elem = get_proximo_elemento(elem);
     }
     
-    return vertices;
+    free(de_fora);
 }
 
 // CRIAR_RETANGULO_ENVOLVENTE
-static void criar_retangulo_envolvente(Lista* segmentos, Ponto* origem) { 
-    double min_x = get_x(origem), max_x = get_x(origem);
-    double min_y = get_y(origem), max_y = get_y(origem);
+// o retângulo sempre contém o círculo de alcance (raio 0 = só a origem)
+static void criar_retangulo_envolvente(Lista* segmentos, Ponto* origem, double raio) { 
+    double min_x = get_x(origem) - raio, max_x = get_x(origem) + raio;
+    double min_y = get_y(origem) - raio, max_y = get_y(origem) + raio;
     
     Elemento* elem = get_primeiro_elemento(segmentos);
     while (elem != NULL) {
         Segmento* seg = (Segmento*) get_elemento(segmentos, elem); 
         
         if (seg) {
-            Ponto* ini = segmento_get_inicio(seg); 
-            Ponto* fim = segmento_get_fim(seg); 
-            
-            double x1 = get_x(ini), y1 = get_y(ini);
-            double x2 = get_x(fim), y2 = get_y(fim);
-            
-            if (x1 < min_x) min_x = x1;
-            if (x1 > max_x) max_x = x1;
-            if (x2 < min_x) min_x = x2;
-            if (x2 > max_x) max_x = x2;
+            double s_min_x, s_min_y, s_max_x, s_max_y;
+            segmento_get_bbox(seg, &s_min_x, &s_min_y, &s_max_x, &s_max_y);
             
-            if (y1 < min_y) min_y = y1;
-            if (y1 > max_y) max_y = y1;
-            if (y2 < min_y) min_y = y2;
-            if (y2 > max_y) max_y = y2;
+            if (s_min_x < min_x) min_x = s_min_x;
+            if (s_max_x > max_x) max_x = s_max_x;
+            if (s_min_y < min_y) min_y = s_min_y;
+            if (s_max_y > max_y) max_y = s_max_y;
         }
         
         elem = get_proximo_elemento(elem);
@@ -175,46 +360,289 @@ static void criar_retangulo_envolvente(Lista* segmentos, Ponto* origem) {
 int comparar_vertices(Vertice* v1, Vertice* v2) {
     if (!v1 || !v2) return 0;
     
-    if (fabs(v1->angulo - v2->angulo) > EPSILON) {
-        return (v1->angulo < v2->angulo) ? -1 : 1;
-    }
+    int direcao = comparar_na_varredura(v1->dx, v1->dy, v2->dx, v2->dy);
+    if (direcao != 0) return direcao;
     
     if (fabs(v1->distancia - v2->distancia) > EPSILON) {
         return (v1->distancia < v2->distancia) ? -1 : 1;
     }
     
-    if (v1->tipo != v2->tipo) {
-        return (v1->tipo == TIPO_INICIO) ? -1 : 1;
+    return 0;
+}
+
+// LEMBRAR_ORDEM
+static void lembrar_ordem(Vertice** vertices, int n) {
+    if (n > cap_ordem_anterior) {
+        Ponto* novo = (Ponto*) realloc(ordem_anterior, n * sizeof(Ponto));
+        if (novo == NULL) {
+            n_ordem_anterior = 0;
+            return;
+        }
+        ordem_anterior = novo;
+        cap_ordem_anterior = n;
     }
     
-    return 0;
+    for (int i = 0; i < n; i++) {
+        ordem_anterior[i] = *vertices[i]->ponto;
+    }
+    n_ordem_anterior = n;
+}
+
+// APLICAR_ORDEM_ANTERIOR
+// arruma o array na ordem da chamada anterior (os vértices que não estavam lá
+// vão para o fim); retorna falso se não houver ordem anterior ou faltar memória
+static bool aplicar_ordem_anterior(Vertice** vertices, TabelaVertices* t) {
+    int n = t->n_vertices;
+    if (n_ordem_anterior == 0 || n == 0) return false;
+    
+    int cap = 1;
+    while (cap < 2 * n) cap <<= 1;
+    uint64_t mascara = (uint64_t) cap - 1;
+    
+    int* posicoes = (int*) malloc(cap * sizeof(int));
+    bool* usado = (bool*) calloc(n, sizeof(bool));
+    if (!posicoes || !usado) {
+        free(posicoes);
+        free(usado);
+        return false;
+    }
+    
+    // os vértices da tabela já são distintos: basta achar uma posição livre
+    memset(posicoes, -1, cap * sizeof(int));
+    for (int i = 0; i < n; i++) {
+        Ponto* p = t->vertices[i].ponto;
+        uint64_t h = hash_ponto(get_x(p), get_y(p)) & mascara;
+        while (posicoes[h] >= 0) h = (h + 1) & mascara;
+        posicoes[h] = i;
+    }
+    
+    int k = 0;
+    for (int i = 0; i < n_ordem_anterior; i++) {
+        double x = ordem_anterior[i].x, y = ordem_anterior[i].y;
+        uint64_t h = hash_ponto(x, y) & mascara;
+        
+        while (posicoes[h] >= 0) {
+            Ponto* q = t->vertices[posicoes[h]].ponto;
+            if (get_x(q) == x && get_y(q) == y) break;
+            h = (h + 1) & mascara;
+        }
+        
+        int idx = posicoes[h];
+        if (idx >= 0 && !usado[idx]) {
+            usado[idx] = true;
+            vertices[k++] = &t->vertices[idx];
+        }
+    }
+    
+    for (int i = 0; i < n; i++) {
+        if (!usado[i]) vertices[k++] = &t->vertices[i];
+    }
+    
+    free(posicoes);
+    free(usado);
+    return true;
+}
+
+// ORDENAR_DO_ZERO
+static void ordenar_do_zero(Vertice** vertices, int n, char tipoOrdenacao, int limiteInsert) {
+    if (tipoOrdenacao == 'q') {
+        ordena_com_qsort((void**)vertices, n);
+    } 
+    else {
+        mergesort((void**)vertices, n, limiteInsert);
+    }
+}
+
+// ORDENAR_VERTICES
+// com uma ordem anterior, a ordenação custa O(n + deslocamentos locais) mais a
+// dos poucos vértices que mudaram muito de lugar (ou que são novos)
+static void ordenar_vertices(Vertice** vertices, TabelaVertices* t, char tipoOrdenacao, int limiteInsert) {
+    int n = t->n_vertices;
+    
+    if (aplicar_ordem_anterior(vertices, t)) {
+        ordenacao_adaptativa((void**)vertices, n, JANELA_REPARO, tipoOrdenacao, limiteInsert);
+    }
+    else {
+        ordenar_do_zero(vertices, n, tipoOrdenacao, limiteInsert);
+    }
+    
+    lembrar_ordem(vertices, n);
+}
+
+// DESCARTAR_FORA_DO_SETOR
+// deixa no começo do array só os vértices até a borda final do setor (fim_dx,
+// fim_dy), na ordem angular que começa na borda inicial; retorna quantos ficaram
+static int descartar_fora_do_setor(Vertice** vertices, int n, double fim_dx, double fim_dy) {
+    int k = 0;
+    
+    for (int i = 0; i < n; i++) {
+        if (comparar_na_varredura(vertices[i]->dx, vertices[i]->dy, fim_dx, fim_dy) <= 0) {
+            vertices[k++] = vertices[i];
+        }
+    }
+    
+    return k;
+}
+
+// ESQUECER_ORDEM_VISIBILIDADE
+void esquecer_ordem_visibilidade(void) {
+    free(ordem_anterior);
+    ordem_anterior = NULL;
+    n_ordem_anterior = 0;
+    cap_ordem_anterior = 0;
+}
+
+// ---------------------------
+// RECORTE NO CÍRCULO DE ALCANCE
+// ---------------------------
+
+// PONTO DO CONTORNO RECORTADO
+// 'v' = vértice do polígono dentro do círculo, 'e' e 's' = onde o contorno
+// entra e sai do círculo
+typedef struct {
+    Ponto p;
+    char tipo;
+} PontoRecorte;
+
+// ACRESCENTAR_ARCO
+// pontos do círculo entre os ângulos de a e b, no sentido anti-horário (sem
+// as pontas)
+static void acrescentar_arco(Poligono* poligono, Ponto o, double raio, Ponto a, Ponto b) {
+    if (distancia_pontos_v(a, b) <= EPSILON) return;
+    
+    double ang_a = atan2(a.y - o.y, a.x - o.x);
+    double delta = atan2(b.y - o.y, b.x - o.x) - ang_a;
+    while (delta <= 0.0) delta += 2.0 * M_PI;
+    
+    int passos = (int) ceil(delta / (2.0 * M_PI / PASSOS_CIRCULO));
+    for (int k = 1; k < passos; k++) {
+        double ang = ang_a + delta * k / passos;
+        adicionar_ao_poligono(poligono, ponto_xy(o.x + raio * cos(ang), o.y + raio * sin(ang)));
+    }
+}
+
+// RECORTAR_NO_CIRCULO
+// intersecção do polígono de visibilidade (estrelado em volta da origem, em
+// sentido anti-horário) com o círculo de alcance: os trechos do contorno fora
+// do círculo viram arcos. destrói o polígono recebido
+static Poligono* recortar_no_circulo(Poligono* poligono, Ponto o, double raio) {
+    int n = poligono_tamanho(poligono);
+    if (n < 3) return poligono;
+    
+    PontoRecorte* contorno = (PontoRecorte*) malloc(3 * n * sizeof(PontoRecorte));
+    Poligono* recortado = criar_poligono(n + PASSOS_CIRCULO);
+    if (!contorno || !recortado) {
+        free(contorno);
+        destruir_poligono(recortado);
+        return poligono;
+    }
+    
+    // cada aresta cruza o círculo no máximo duas vezes; o estado dentro/fora
+    // das pontas decide quais cruzamentos existem, então entradas e saídas
+    // sempre se alternam
+    double r2 = raio * raio;
+    int m = 0;
+    bool algum_fora = false;
+    
+    for (int i = 0; i < n; i++) {
+        Ponto p = poligono_vertice(poligono, i), q = poligono_vertice(poligono, (i + 1) % n);
+        double fx = p.x - o.x, fy = p.y - o.y;
+        double dx = q.x - p.x, dy = q.y - p.y;
+        
+        bool dentro_p = fx * fx + fy * fy <= r2;
+        bool dentro_q = (q.x - o.x) * (q.x - o.x) + (q.y - o.y) * (q.y - o.y) <= r2;
+        if (!dentro_p) algum_fora = true;
+        if (dentro_p) contorno[m++] = (PontoRecorte) { p, 'v' };
+        if (dentro_p && dentro_q) continue;
+        
+        double a = dx * dx + dy * dy;
+        double b = 2.0 * (fx * dx + fy * dy);
+        double c = fx * fx + fy * fy - r2;
+        double disc = b * b - 4.0 * a * c;
+        if (a <= 0.0 || disc < 0.0) continue;
+        
+        double raiz = sqrt(disc);
+        double t1 = fmin(fmax((-b - raiz) / (2.0 * a), 0.0), 1.0);
+        double t2 = fmin(fmax((-b + raiz) / (2.0 * a), 0.0), 1.0);
+        
+        if (dentro_p) {
+            contorno[m++] = (PontoRecorte) { ponto_xy(p.x + t2 * dx, p.y + t2 * dy), 's' };
+        }
+        else if (dentro_q) {
+            contorno[m++] = (PontoRecorte) { ponto_xy(p.x + t1 * dx, p.y + t1 * dy), 'e' };
+        }
+        else if (disc > 0.0 && t1 > 0.0 && t2 < 1.0) {
+            contorno[m++] = (PontoRecorte) { ponto_xy(p.x + t1 * dx, p.y + t1 * dy), 'e' };
+            contorno[m++] = (PontoRecorte) { ponto_xy(p.x + t2 * dx, p.y + t2 * dy), 's' };
+        }
+    }
+    
+    if (!algum_fora) {
+        // o polígono inteiro está dentro do alcance
+        free(contorno);
+        destruir_poligono(recortado);
+        return poligono;
+    }
+    
+    if (m == 0) {
+        // o contorno não chega no círculo: sobra o círculo inteiro
+        for (int k = 0; k < PASSOS_CIRCULO; k++) {
+            double ang = 2.0 * M_PI * k / PASSOS_CIRCULO;
+            adicionar_ao_poligono(recortado, ponto_xy(o.x + raio * cos(ang), o.y + raio * sin(ang)));
+        }
+    }
+    else {
+        for (int k = 0; k < m; k++) {
+            adicionar_ao_poligono(recortado, contorno[k].p);
+            if (contorno[k].tipo == 's') {
+                acrescentar_arco(recortado, o, raio, contorno[k].p, contorno[(k + 1) % m].p);
+            }
+        }
+    }
+    
+    free(contorno);
+    destruir_poligono(poligono);
+    return recortado;
 }
 
 // ==========================
 // ALGORITMO DE VISIBILIDADE
 // ==========================
 
-// CALCULAR_VISIBILIDADE
-Lista* calcular_visibilidade(Ponto* origem, Lista* segmentos, char tipoOrdenacao, int limiteInsert) { 
+// VARRER
+// varredura angular; com raio > 0, o retângulo envolvente cobre o círculo de
+// alcance e o polígono é recortado nele; no fim, os pontos repetidos e os do
+// meio de trechos retos saem do polígono. com abertura entre 0 e 360 graus, a
+// varredura cobre só o setor centrado em direcao (graus, a partir do eixo x):
+// começa na borda inicial com os segmentos que a cruzam já ativos, os vértices
+// fora do setor nem entram na ordenação, e o polígono sai fechado pela origem
+static Poligono* varrer(Ponto* origem, Lista* segmentos, char tipoOrdenacao, int limiteInsert, double raio, double direcao, double abertura) { 
     if (!origem || !segmentos) return NULL;
     
-    ponto_origem_global = origem;
+    bool setor = abertura > 0.0 && abertura < 360.0;
+    double fim_dx = 1.0, fim_dy = 0.0;
+    if (setor) {
+        double inicio = (direcao - abertura / 2.0) * M_PI / 180.0;
+        double fim = inicio + abertura * M_PI / 180.0;
+        inicio_dx = cos(inicio);
+        inicio_dy = sin(inicio);
+        fim_dx = cos(fim);
+        fim_dy = sin(fim);
+    }
     
-    // adiciona retangulo envolvente
+    // copia os anteparos (sem as arestas de costas) e adiciona retangulo envolvente
     Lista* segmentos_temp = criar_lista();
-    Elemento* s_elem = get_primeiro_elemento(segmentos);
-    while (s_elem != NULL) {
-        Segmento* s = (Segmento*) get_elemento(segmentos, s_elem);
-        inserir_fim_lista(segmentos_temp, s);
-        s_elem = get_proximo_elemento(s_elem);
-    }
+    copiar_arestas_de_frente(segmentos, segmentos_temp, *origem);
     
     int tamanho_original = lista_tamanho(segmentos_temp);
-    criar_retangulo_envolvente(segmentos_temp, origem);
-    
-    // extrai vertices
-    Lista* vertices_lista = extrair_vertices(segmentos_temp, origem);
-    if (!vertices_lista) {
+    criar_retangulo_envolvente(segmentos_temp, origem, raio);
+    
+    // extrai vertices (e os segmentos que já cruzam o raio inicial)
+    Segmento** iniciais = (Segmento**) malloc(lista_tamanho(segmentos_temp) * sizeof(Segmento*));
+    int n_iniciais = 0;
+    TabelaVertices tabela;
+    if (!iniciais || !extrair_vertices(segmentos_temp, origem, &tabela, iniciais, &n_iniciais)) {
+        free(iniciais);
         
         Elemento* temp_elem = get_primeiro_elemento(segmentos_temp);
         for(int i=0; i<tamanho_original; i++) {
@@ -224,10 +652,7 @@ Lista* calcular_visibilidade(Ponto* origem, Lista* segmentos, char tipoOrdenacao
         for(int k=0; k<4; k++) {
             if(temp_elem) {
                 Segmento* s = (Segmento*) remover_posicao_lista(segmentos_temp, temp_elem); 
-                Ponto* p1 = segmento_get_inicio(s);
-                Ponto* p2 = segmento_get_fim(s);
-                destruir_ponto(p1);
-                destruir_ponto(p2);
+                destruir_ponto(segmento_get_inicio(s)); // cantos compartilhados
                 destruir_segmento(s); 
                 
                 temp_elem = get_primeiro_elemento(segmentos_temp);
@@ -238,114 +663,151 @@ Lista* calcular_visibilidade(Ponto* origem, Lista* segmentos, char tipoOrdenacao
         }
         
         destruir_lista(segmentos_temp);
+        inicio_dx = 1.0;
+        inicio_dy = 0.0;
         return NULL;
     }
     
-    int n = lista_tamanho(vertices_lista);
-    Vertice** vertices_array = (Vertice**) malloc(n * sizeof(Vertice*));
+    int n = tabela.n_vertices;
+    Vertice** vertices_array = (Vertice**) malloc((n > 0 ? n : 1) * sizeof(Vertice*));
     
-    Elemento* elem = get_primeiro_elemento(vertices_lista);
-    int i = 0;
-    while (elem != NULL) {
-        vertices_array[i++] = (Vertice*) get_elemento(vertices_lista, elem);
-        elem = get_proximo_elemento(elem);
+    for (int i = 0; vertices_array && i < n; i++) {
+        vertices_array[i] = &tabela.vertices[i];
     }
     
-    // ordena vertices
-    if (tipoOrdenacao == 'q') {
-        ordena_com_qsort((void**)vertices_array, n);
-    } 
+    // ordena vertices (reparando a ordem da chamada anterior, se houver). a
+    // ordem de um setor começa em outro ângulo e não serve para a próxima
+    // bomba, então ela é ordenada do zero e não é lembrada
+    if (!vertices_array) {
+        n = 0;
+    }
+    else if (setor) {
+        n = descartar_fora_do_setor(vertices_array, n, fim_dx, fim_dy);
+        ordenar_do_zero(vertices_array, n, tipoOrdenacao, limiteInsert);
+    }
     else {
-        mergesort((void**)vertices_array, n, limiteInsert);
+        ordenar_vertices(vertices_array, &tabela, tipoOrdenacao, limiteInsert);
     }
     
-    // inicializa estruturas
-    Arvore* segs_ativos = criar_arvore(origem); 
-    Lista* poligono = criar_lista();
+    // inicializa estruturas: a árvore já nasce com os segmentos que cruzam o
+    // raio inicial, montada de uma vez e balanceada
+    Arvore* segs_ativos = criar_arvore_com_segmentos(origem, iniciais, n_iniciais); 
+    free(iniciais);
+    Poligono* poligono = criar_poligono(n + 8);
     
-    Segmento* seg_inicial = NULL; 
-    double min_dist = 1e9;
+    // as interseções são calculadas por valor e vão direto para o array de
+    // coordenadas do polígono
+    Ponto o = *origem;
+    Ponto p_int;
     
-    s_elem = get_primeiro_elemento(segmentos_temp);
-    while (s_elem != NULL) {
-        Segmento* seg = (Segmento*) get_elemento(segmentos_temp, s_elem); 
-        if (seg) {
-            double dist = segmento_distancia_ponto(seg, origem); 
-            if (dist < min_dist) {
-                min_dist = dist;
-                seg_inicial = seg; 
-            }
+    // o setor começa na origem e no anteparo mais próximo da borda inicial
+    if (setor) {
+        adicionar_ao_poligono(poligono, o);
+        
+        Segmento* seg_borda = segmento_mais_proximo(segs_ativos, inicio_dx, inicio_dy);
+        if (seg_borda && segmento_intersecao_raio_v(seg_borda, o, inicio_dx, inicio_dy, &p_int)) {
+            adicionar_ao_poligono(poligono, p_int);
         }
-        s_elem = get_proximo_elemento(s_elem);
-    }
-    
-    Ponto* biombo = NULL;
-    if (seg_inicial) {
-        inserir_segmento(segs_ativos, seg_inicial); 
     }
     
-    for (int j = 0; j < n; j++) {
-        Vertice* v = vertices_array[j];
+    // buffers dos segmentos que entram e saem em cada grupo de eventos
+    int max_grupo = tabela.n_incidencias > 0 ? tabela.n_incidencias : 1;
+    Segmento** entram = (Segmento**) malloc(max_grupo * sizeof(Segmento*));
+    Segmento** saem = (Segmento**) malloc(max_grupo * sizeof(Segmento*));
+    
+    int j = 0;
+    while (entram && saem && j < n) {
+        // eventos na mesma direção formam um grupo: todos os que entram são
+        // inseridos, uma única descida acha o segmento mais próximo antes e
+        // depois do grupo, e só então os que saem são removidos
+        int fim_grupo = j + 1;
+        while (fim_grupo < n && comparar_na_varredura(vertices_array[j]->dx, vertices_array[j]->dy,
+                                                 vertices_array[fim_grupo]->dx, vertices_array[fim_grupo]->dy) == 0) {
+            fim_grupo++;
+        }
+        
+        double dx = vertices_array[j]->dx;
+        double dy = vertices_array[j]->dy;
+        int n_entram = 0, n_saem = 0;
         
-        Segmento* seg_antigo = segmento_mais_proximo(segs_ativos, v->angulo); 
-        Ponto* p_int_antigo = NULL;
-        if (seg_antigo) {
-            p_int_antigo = segmento_intersecao_raio(seg_antigo, origem, v->angulo);
+        for (int k = j; k < fim_grupo; k++) {
+            Vertice* v = vertices_array[k];
+            Incidencia* inc = &tabela.incidencias[v->primeira];
+            
+            for (int q = 0; q < v->n_incidencias; q++) {
+                if (inc[q].tipo == TIPO_INICIO) {
+                    inserir_segmento(segs_ativos, inc[q].segmento);
+                    entram[n_entram++] = inc[q].segmento;
+                }
+                else {
+                    saem[n_saem++] = inc[q].segmento;
+                }
+            }
         }
-
-        if (v->tipo == TIPO_INICIO) {
-            inserir_segmento(segs_ativos, v->segmento); 
-        } 
-        else {
-            remover_segmento(segs_ativos, v->segmento); 
+        
+        Segmento* seg_antigo;
+        Segmento* seg_novo;
+        double dist_int_novo;
+        segmentos_mais_proximos(segs_ativos, dx, dy, entram, n_entram, saem, n_saem,
+                                &seg_antigo, NULL, &seg_novo, &dist_int_novo);
+        
+        for (int k = 0; k < n_saem; k++) {
+            remover_segmento(segs_ativos, saem[k]);
         }
         
-        Segmento* seg_novo = segmento_mais_proximo(segs_ativos, v->angulo);
-        Ponto* p_int_novo = NULL;
-        if (seg_novo) {
-            p_int_novo = segmento_intersecao_raio(seg_novo, origem, v->angulo); 
+        // um grupo só de vértices escondidos não muda o anteparo visto: os
+        // cortes dele no mesmo anteparo só entortariam o contorno (e a
+        // triangulação, que não passa por esses vértices, não os teria)
+        bool algum_visivel = false;
+        for (int k = j; k < fim_grupo; k++) {
+            if (vertices_array[k]->distancia < dist_int_novo - EPSILON) algum_visivel = true;
         }
         
-        if (p_int_antigo) {
-            if (!biombo || distancia_pontos(biombo, p_int_antigo) > EPSILON) {
-                Ponto* copia = criar_ponto(get_x(p_int_antigo), get_y(p_int_antigo));
-                inserir_fim_lista(poligono, copia);
-                biombo = copia; 
-            }
+        if (!algum_visivel && seg_antigo == seg_novo) {
+            j = fim_grupo;
+            continue;
         }
-
-        double dist_int_novo = p_int_novo ? distancia_pontos(origem, p_int_novo) : 1e18;
         
-        if (v->distancia < dist_int_novo - EPSILON) {
-            if (!vertice_encoberto(v, segs_ativos)) {
-                if (!biombo || distancia_pontos(biombo, v->ponto) > EPSILON) {
-                    Ponto* copia = criar_ponto(get_x(v->ponto), get_y(v->ponto));
-                    inserir_fim_lista(poligono, copia);
-                    biombo = copia;
-                }
-            }
+        if (seg_antigo && cortar_no_grupo(seg_antigo, o, vertices_array, j, fim_grupo, &p_int)) {
+            adicionar_ao_poligono(poligono, p_int);
         }
-
-        if (p_int_novo) {
-            if (!biombo || distancia_pontos(biombo, p_int_novo) > EPSILON) {
-                Ponto* copia = criar_ponto(get_x(p_int_novo), get_y(p_int_novo));
-                inserir_fim_lista(poligono, copia);
-                biombo = copia;
+        
+        // um vértice aparece se estiver antes do segmento mais próximo depois do
+        // grupo; no grupo os vértices já estão em ordem de distância
+        for (int k = j; k < fim_grupo; k++) {
+            Vertice* v = vertices_array[k];
+            if (v->distancia < dist_int_novo - EPSILON) {
+                adicionar_ao_poligono(poligono, *v->ponto);
             }
         }
         
-        if (p_int_antigo) destruir_ponto(p_int_antigo);
-        if (p_int_novo) destruir_ponto(p_int_novo);
+        if (seg_novo && cortar_no_grupo(seg_novo, o, vertices_array, j, fim_grupo, &p_int)) {
+            adicionar_ao_poligono(poligono, p_int);
+        }
+        
+        j = fim_grupo;
+    }
+    
+    free(entram);
+    free(saem);
+    
+    // e termina no anteparo mais próximo da borda final (os que saem depois
+    // dela continuam na árvore)
+    if (setor) {
+        Segmento* seg_borda = segmento_mais_proximo(segs_ativos, fim_dx, fim_dy);
+        if (seg_borda && segmento_intersecao_raio_v(seg_borda, o, fim_dx, fim_dy, &p_int)) {
+            adicionar_ao_poligono(poligono, p_int);
+        }
+        
+        inicio_dx = 1.0;
+        inicio_dy = 0.0;
     }
     
     // limpeza! :D
     destruir_arvore(segs_ativos);
     
-    for (int j = 0; j < n; j++) {
-        destruir_vertice(vertices_array[j]);
-    }
     free(vertices_array);
-    destruir_lista(vertices_lista);
+    liberar_tabela_vertices(&tabela);
     
     Elemento* temp_elem = get_primeiro_elemento(segmentos_temp);
     for(int i=0; i<tamanho_original; i++) {
@@ -355,10 +817,7 @@ Lista* calcular_visibilidade(Ponto* origem, Lista* segmentos, char tipoOrdenacao
     for(int k=0; k<4; k++) {
         if(temp_elem) {
             Segmento* s = (Segmento*) remover_posicao_lista(segmentos_temp, temp_elem); 
-            Ponto* p1 = segmento_get_inicio(s);
-            Ponto* p2 = segmento_get_fim(s);
-            destruir_ponto(p1);
-            destruir_ponto(p2);
+            destruir_ponto(segmento_get_inicio(s)); // cantos compartilhados
             destruir_segmento(s); 
             
             temp_elem = get_primeiro_elemento(segmentos_temp);
@@ -370,5 +829,23 @@ Lista* calcular_visibilidade(Ponto* origem, Lista* segmentos, char tipoOrdenacao
     
     destruir_lista(segmentos_temp);
     
+    if (raio > 0.0) poligono = recortar_no_circulo(poligono, o, raio);
+    poligono_simplificar(poligono, EPSILON);
+    
     return poligono;
+}
+
+// CALCULAR_VISIBILIDADE
+Poligono* calcular_visibilidade(Ponto* origem, Lista* segmentos, char tipoOrdenacao, int limiteInsert) { 
+    return varrer(origem, segmentos, tipoOrdenacao, limiteInsert, 0.0, 0.0, 0.0);
+}
+
+// CALCULAR_VISIBILIDADE_RAIO
+Poligono* calcular_visibilidade_raio(Ponto* origem, Lista* segmentos, char tipoOrdenacao, int limiteInsert, double raio) { 
+    return varrer(origem, segmentos, tipoOrdenacao, limiteInsert, raio > 0.0 ? raio : 0.0, 0.0, 0.0);
+}
+
+// CALCULAR_VISIBILIDADE_SETOR
+Poligono* calcular_visibilidade_setor(Ponto* origem, Lista* segmentos, char tipoOrdenacao, int limiteInsert, double raio, double direcao, double abertura) { 
+    return varrer(origem, segmentos, tipoOrdenacao, limiteInsert, raio > 0.0 ? raio : 0.0, direcao, abertura);
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include "lista.h"
 #include "segmento.h"
 #include "arvore.h"
+#include "poligono.h"
 
 // ===============================================
 // VISIBILIDADE
@@ -39,8 +40,44 @@ int comparar_vertices(Vertice* v1, Vertice* v2);
     - segmentos
     - tipo de ordenação
     - limite para insertionsort
-    RETORNA: lista de pontos formando o polígono de visibilidade
+    RETORNA: o polígono de visibilidade
 */
-Lista* calcular_visibilidade(Ponto* origem, Lista* segmentos, char tipoOrdenacao, int limiteInsert);
+Poligono* calcular_visibilidade(Ponto* origem, Lista* segmentos, char tipoOrdenacao, int limiteInsert);
+
+/* -> calcular_visibilidade_raio
+    FUNÇÃO: calcula a região de visibilidade limitada a um círculo de alcance em
+    volta da origem; basta passar os anteparos que chegam no círculo
+    RECEBE: 
+    - origem (onde a bomba explode)
+    - segmentos
+    - tipo de ordenação
+    - limite para insertionsort
+    - raio do alcance (0 = sem limite, como calcular_visibilidade)
+    RETORNA: o polígono de visibilidade, com os
+    trechos fora do alcance trocados por arcos do círculo
+*/
+Poligono* calcular_visibilidade_raio(Ponto* origem, Lista* segmentos, char tipoOrdenacao, int limiteInsert, double raio);
+
+/* -> calcular_visibilidade_setor
+    FUNÇÃO: calcula a região de visibilidade dentro de um setor (cone) com
+    vértice na origem; só os vértices dentro do setor são ordenados e varridos
+    RECEBE: 
+    - origem (onde a bomba explode)
+    - segmentos
+    - tipo de ordenação
+    - limite para insertionsort
+    - raio do alcance (0 = sem limite)
+    - direção do eixo do setor, em graus a partir do eixo x (sentido de y crescente)
+    - abertura total do setor, em graus (fora de (0, 360) = volta inteira)
+    RETORNA: o polígono de visibilidade, que começa
+    na origem e segue pela borda inicial do setor até a final
+*/
+Poligono* calcular_visibilidade_setor(Ponto* origem, Lista* segmentos, char tipoOrdenacao, int limiteInsert, double raio, double direcao, double abertura);
+
+/* -> esquecer_ordem_visibilidade
+    FUNÇÃO: descarta a ordem de vértices guardada da última chamada (a próxima
+    calcular_visibilidade ordena do zero)
+*/
+void esquecer_ordem_visibilidade(void);
 
 #endif
\ No newline at end of file
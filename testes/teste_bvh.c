@@ -0,0 +1,245 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "../src/bvh.h"
+#include "../src/segmento.h"
+#include "../src/geometria.h"
+#include "../src/lista.h"
+
+// ===============================================
+// TESTE DA BVH
+// ----------------------------------------------
+// inserções e remoções (em ordem sorteada e em
+// ordem crescente, que sem as rotações deixaria
+// a árvore virar uma lista) conferidas contra a
+// força bruta: a consulta por região e o
+// primeiro segmento atingido por um raio.
+// ===============================================
+
+#define N_SEGMENTOS 600
+#define N_RAIOS 400
+#define N_REGIOES 200
+#define LADO 1000.0
+
+static unsigned int semente = 2024u;
+static int falhas = 0;
+
+// SORTEAR
+static double sortear(double min, double max) {
+    semente = semente * 1103515245u + 12345u;
+    return min + (max - min) * ((semente >> 8) & 0xFFFF) / 65535.0;
+}
+
+// FALHAR
+static void falhar(const char* teste, const char* detalhe) {
+    if (falhas < 10) fprintf(stderr, "FALHOU %s: %s\n", teste, detalhe);
+    falhas++;
+}
+
+// CRIAR_SEGMENTOS
+// segmentos curtos sorteados no quadrado; em ordem, cada um fica à direita do
+// anterior
+static Segmento** criar_segmentos(int n, bool em_ordem) {
+    Segmento** segs = (Segmento**) malloc(n * sizeof(Segmento*));
+    if (segs == NULL) {
+        fprintf(stderr, "erro ao alocar os segmentos\n");
+        exit(1);
+    }
+
+    for (int i = 0; i < n; i++) {
+        double x = em_ordem ? i * LADO / n : sortear(0.0, LADO);
+        double y = sortear(0.0, LADO);
+        Ponto* a = criar_ponto(x, y);
+        Ponto* b = criar_ponto(x + sortear(-40.0, 40.0), y + sortear(-40.0, 40.0));
+
+        segs[i] = criar_segmento(i + 1, a, b, NULL);
+        if (segs[i] == NULL) {
+            fprintf(stderr, "erro ao criar o segmento\n");
+            exit(1);
+        }
+    }
+
+    return segs;
+}
+
+// DESTRUIR_SEGMENTOS
+static void destruir_segmentos(Segmento** segs, int n) {
+    for (int i = 0; i < n; i++) {
+        destruir_ponto(segmento_get_inicio(segs[i]));
+        destruir_ponto(segmento_get_fim(segs[i]));
+        destruir_segmento(segs[i]);
+    }
+    free(segs);
+}
+
+// IGNORAR_IMPARES (filtro: o raio atravessa os segmentos de id ímpar)
+static bool ignorar_impares(Segmento* s, void* contexto) {
+    (void) contexto;
+    return segmento_get_id(s) % 2 == 1;
+}
+
+// DISTANCIA_BRUTA
+// mesma conta da BVH, segmento por segmento
+static double distancia_bruta(Segmento** segs, bool* dentro, int n, Ponto o, double dx, double dy, FiltroBvh ignorar) {
+    double melhor = 1e18;
+
+    for (int i = 0; i < n; i++) {
+        Segmento* s = segs[i];
+        if (!dentro[i] || (ignorar && ignorar(s, NULL))) continue;
+        if (!segmento_intersecta_raio(s, &o, dx, dy)) continue;
+
+        Ponto p;
+        if (!segmento_intersecao_raio_v(s, o, dx, dy, &p)) continue;
+        if ((p.x - o.x) * dx + (p.y - o.y) * dy < 0.0) continue;
+
+        double d = distancia_pontos_v(o, p);
+        if (d < melhor) melhor = d;
+    }
+
+    return melhor;
+}
+
+// CONFERIR_RAIOS
+static void conferir_raios(Bvh* b, Segmento** segs, bool* dentro, int n, const char* etapa) {
+    for (int k = 0; k < N_RAIOS; k++) {
+        Ponto o = ponto_xy(sortear(-100.0, LADO + 100.0), sortear(-100.0, LADO + 100.0));
+        double ang = sortear(0.0, 2.0 * 3.14159265358979323846);
+        double dx = cos(ang) * sortear(0.5, 3.0), dy = sin(ang) * sortear(0.5, 3.0);
+
+        // um quarto dos raios mira numa ponta, onde o raio só encosta
+        if (k % 4 == 0) {
+            int alvo = (int) sortear(0.0, n - 1);
+            Ponto* p = segmento_get_inicio(segs[alvo]);
+            dx = get_x(p) - o.x;
+            dy = get_y(p) - o.y;
+        }
+
+        FiltroBvh filtro = (k % 2 == 0) ? NULL : ignorar_impares;
+        double d_bvh;
+        Segmento* s = bvh_raio_mais_proximo(b, o, dx, dy, filtro, NULL, &d_bvh);
+        double d_bruta = distancia_bruta(segs, dentro, n, o, dx, dy, filtro);
+
+        if ((s == NULL) != (d_bruta >= 1e18) || (s != NULL && d_bvh != d_bruta)) {
+            char detalhe[128];
+            snprintf(detalhe, sizeof(detalhe), "%s, raio %d: bvh %.17g, força bruta %.17g", etapa, k, s ? d_bvh : -1.0, d_bruta);
+            falhar("raio", detalhe);
+        }
+
+        if (s != NULL) {
+            int id = segmento_get_id(s);
+            if (!dentro[id - 1] || (filtro && filtro(s, NULL))) falhar("raio", "segmento removido ou filtrado atingido");
+        }
+    }
+}
+
+// CONFERIR_REGIOES
+static void conferir_regioes(Bvh* b, Segmento** segs, bool* dentro, int n, const char* etapa) {
+    for (int k = 0; k < N_REGIOES; k++) {
+        double x = sortear(-50.0, LADO), y = sortear(-50.0, LADO);
+        double min_x = x, min_y = y, max_x = x + sortear(0.0, 200.0), max_y = y + sortear(0.0, 200.0);
+
+        Lista* saida = criar_lista();
+        int achados = bvh_consultar(b, min_x, min_y, max_x, max_y, saida);
+
+        int esperados = 0;
+        for (int i = 0; i < n; i++) {
+            double s_min_x, s_min_y, s_max_x, s_max_y;
+            segmento_get_bbox(segs[i], &s_min_x, &s_min_y, &s_max_x, &s_max_y);
+            if (dentro[i] && s_min_x <= max_x && s_max_x >= min_x && s_min_y <= max_y && s_max_y >= min_y) esperados++;
+        }
+
+        bool ok = achados == esperados && lista_tamanho(saida) == achados;
+        Elemento* elem = get_primeiro_elemento(saida);
+        while (ok && elem != NULL) {
+            ok = dentro[segmento_get_id((Segmento*) get_elemento(saida, elem)) - 1];
+            elem = get_proximo_elemento(elem);
+        }
+
+        if (!ok) {
+            char detalhe[96];
+            snprintf(detalhe, sizeof(detalhe), "%s, região %d: %d achados, %d esperados", etapa, k, achados, esperados);
+            falhar("região", detalhe);
+        }
+
+        destruir_lista(saida);
+    }
+}
+
+// TESTE_INSERIR_REMOVER
+// insere tudo, remove metade e devolve parte dela, conferindo a cada etapa
+static void teste_inserir_remover(bool em_ordem) {
+    const char* nome = em_ordem ? "em ordem" : "sorteados";
+    Segmento** segs = criar_segmentos(N_SEGMENTOS, em_ordem);
+    bool* dentro = (bool*) calloc(N_SEGMENTOS, sizeof(bool));
+    Bvh* b = criar_bvh();
+    if (dentro == NULL || b == NULL) {
+        fprintf(stderr, "erro ao alocar a BVH\n");
+        exit(1);
+    }
+
+    for (int i = 0; i < N_SEGMENTOS; i++) {
+        if (!bvh_inserir(b, segs[i])) falhar("inserir", nome);
+        dentro[i] = true;
+    }
+    if (bvh_tamanho(b) != N_SEGMENTOS) falhar("tamanho depois das inserções", nome);
+
+    conferir_raios(b, segs, dentro, N_SEGMENTOS, nome);
+    conferir_regioes(b, segs, dentro, N_SEGMENTOS, nome);
+
+    // remove os da primeira metade (em ordem, um lado inteiro da árvore) e um
+    // a cada três do resto
+    int restantes = N_SEGMENTOS;
+    for (int i = 0; i < N_SEGMENTOS; i++) {
+        if (i < N_SEGMENTOS / 2 || i % 3 == 0) {
+            if (!bvh_remover(b, segs[i])) falhar("remover", nome);
+            dentro[i] = false;
+            restantes--;
+        }
+    }
+    if (bvh_tamanho(b) != restantes) falhar("tamanho depois das remoções", nome);
+    if (bvh_remover(b, segs[0])) falhar("remover de novo", nome);
+
+    conferir_raios(b, segs, dentro, N_SEGMENTOS, nome);
+    conferir_regioes(b, segs, dentro, N_SEGMENTOS, nome);
+
+    // devolve os pares removidos
+    for (int i = 0; i < N_SEGMENTOS; i += 2) {
+        if (!dentro[i]) {
+            if (!bvh_inserir(b, segs[i])) falhar("reinserir", nome);
+            dentro[i] = true;
+            restantes++;
+        }
+    }
+    if (bvh_tamanho(b) != restantes) falhar("tamanho depois das reinserções", nome);
+
+    conferir_raios(b, segs, dentro, N_SEGMENTOS, nome);
+    conferir_regioes(b, segs, dentro, N_SEGMENTOS, nome);
+
+    // esvazia
+    for (int i = 0; i < N_SEGMENTOS; i++) {
+        if (dentro[i] && !bvh_remover(b, segs[i])) falhar("esvaziar", nome);
+        dentro[i] = false;
+    }
+    if (bvh_tamanho(b) != 0) falhar("tamanho da BVH vazia", nome);
+    if (bvh_raio_mais_proximo(b, ponto_xy(0.0, 0.0), 1.0, 1.0, NULL, NULL, NULL) != NULL) falhar("raio na BVH vazia", nome);
+
+    destruir_bvh(b);
+    free(dentro);
+    destruir_segmentos(segs, N_SEGMENTOS);
+}
+
+// MAIN
+int main(void) {
+    teste_inserir_remover(false);
+    teste_inserir_remover(true);
+
+    if (falhas > 0) {
+        printf("%d falha(s)\n", falhas);
+        return 1;
+    }
+
+    printf("teste_bvh: ok\n");
+    return 0;
+}
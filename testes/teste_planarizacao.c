@@ -0,0 +1,353 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../src/planarizacao.h"
+#include "../src/segmento.h"
+#include "../src/geometria.h"
+#include "../src/lista.h"
+#include "../src/grade.h"
+#include "../src/bvh.h"
+
+// ===============================================
+// TESTE DA PLANARIZAÇÃO
+// ----------------------------------------------
+// casos pequenos (cruzamento, ponta no meio de
+// outro, sobreposição colinear) com os pedaços
+// esperados, e anteparos sorteados planarizados
+// de uma vez e em lotes de vários tamanhos, que
+// têm que dar a mesma lista, sem cruzamentos, com
+// a grade e a BVH em dia.
+// ===============================================
+
+#define N_SEGMENTOS 300
+#define LADO 400
+
+static unsigned int semente = 4242u;
+static int falhas = 0;
+
+// SORTEAR
+static double sortear(double min, double max) {
+    semente = semente * 1103515245u + 12345u;
+    return min + (max - min) * ((semente >> 8) & 0xFFFF) / 65535.0;
+}
+
+// FALHAR
+static void falhar(const char* teste, const char* detalhe) {
+    if (falhas < 10) fprintf(stderr, "FALHOU %s: %s\n", teste, detalhe);
+    falhas++;
+}
+
+// NOVO_SEGMENTO
+static Segmento* novo_segmento(int id, double x1, double y1, double x2, double y2) {
+    Segmento* s = criar_segmento(id, criar_ponto(x1, y1), criar_ponto(x2, y2), NULL);
+    if (s == NULL) {
+        fprintf(stderr, "erro ao criar o segmento\n");
+        exit(1);
+    }
+    return s;
+}
+
+// COMPARAR_ENDERECOS
+static int comparar_enderecos(const void* a, const void* b) {
+    uintptr_t p = (uintptr_t) *(void* const*) a, q = (uintptr_t) *(void* const*) b;
+    return (p > q) - (p < q);
+}
+
+// DESTRUIR_ANTEPAROS
+// os pedaços dividem as pontas entre si: cada ponto é destruído uma vez só
+static void destruir_anteparos(Lista* anteparos) {
+    int n = lista_tamanho(anteparos);
+    Ponto** pontos = (Ponto**) malloc(2 * (n + 1) * sizeof(Ponto*));
+    if (pontos == NULL) {
+        fprintf(stderr, "erro ao alocar os pontos\n");
+        exit(1);
+    }
+
+    int k = 0;
+    while (!lista_vazia(anteparos)) {
+        Segmento* s = (Segmento*) remover_inicio_lista(anteparos);
+        pontos[k++] = segmento_get_inicio(s);
+        pontos[k++] = segmento_get_fim(s);
+        destruir_segmento(s);
+    }
+
+    qsort(pontos, k, sizeof(Ponto*), comparar_enderecos);
+    for (int i = 0; i < k; i++) {
+        if (i == 0 || pontos[i] != pontos[i - 1]) destruir_ponto(pontos[i]);
+    }
+
+    free(pontos);
+    destruir_lista(anteparos);
+}
+
+// CONFERIR_PEDACOS
+// a lista tem que ter exatamente os pedaços esperados, na ordem: {id, x1, y1, x2, y2}
+static void conferir_pedacos(const char* teste, Lista* anteparos, const double (*esperados)[5], int n) {
+    char detalhe[160];
+
+    if (lista_tamanho(anteparos) != n) {
+        snprintf(detalhe, sizeof(detalhe), "%d pedaços, esperados %d", lista_tamanho(anteparos), n);
+        falhar(teste, detalhe);
+        return;
+    }
+
+    int i = 0;
+    Elemento* elem = get_primeiro_elemento(anteparos);
+    while (elem != NULL) {
+        Segmento* s = (Segmento*) get_elemento(anteparos, elem);
+        Ponto* a = segmento_get_inicio(s);
+        Ponto* b = segmento_get_fim(s);
+
+        if (segmento_get_id(s) != (int) esperados[i][0] || get_x(a) != esperados[i][1] || get_y(a) != esperados[i][2] ||
+            get_x(b) != esperados[i][3] || get_y(b) != esperados[i][4]) {
+            snprintf(detalhe, sizeof(detalhe), "pedaço %d: id %d (%g, %g) - (%g, %g)", i, segmento_get_id(s), get_x(a), get_y(a), get_x(b), get_y(b));
+            falhar(teste, detalhe);
+        }
+
+        i++;
+        elem = get_proximo_elemento(elem);
+    }
+}
+
+// PLANARIZAR_CASO
+// planariza os segmentos dados num lote só e confere os pedaços e os cortes
+static void planarizar_caso(const char* teste, const double (*segs)[4], int n_segs, const double (*esperados)[5], int n_esperados, int cortes) {
+    Lista* anteparos = criar_lista();
+    Lista* novos = criar_lista();
+
+    for (int i = 0; i < n_segs; i++) {
+        inserir_fim_lista(novos, novo_segmento(i + 1, segs[i][0], segs[i][1], segs[i][2], segs[i][3]));
+    }
+
+    int feitos = planarizar_anteparos(anteparos, novos, NULL, NULL);
+    if (feitos != cortes) {
+        char detalhe[64];
+        snprintf(detalhe, sizeof(detalhe), "%d cortes, esperados %d", feitos, cortes);
+        falhar(teste, detalhe);
+    }
+    if (!lista_vazia(novos)) falhar(teste, "o lote não ficou vazio");
+
+    conferir_pedacos(teste, anteparos, esperados, n_esperados);
+
+    destruir_lista(novos);
+    destruir_anteparos(anteparos);
+}
+
+// TESTE_CASOS
+static void teste_casos(void) {
+    // cruzamento: os dois viram dois pedaços que se encontram no meio
+    const double cruz[][4] = { { 0, 0, 10, 10 }, { 0, 10, 10, 0 } };
+    const double cruz_esperados[][5] = { { 1, 0, 0, 5, 5 }, { 1, 5, 5, 10, 10 }, { 2, 0, 10, 5, 5 }, { 2, 5, 5, 10, 0 } };
+    planarizar_caso("cruzamento", cruz, 2, cruz_esperados, 4, 2);
+
+    // T: a ponta do segundo divide o primeiro, e ele mesmo fica inteiro
+    const double t[][4] = { { 0, 0, 10, 0 }, { 5, 0, 5, 5 } };
+    const double t_esperados[][5] = { { 1, 0, 0, 5, 0 }, { 1, 5, 0, 10, 0 }, { 2, 5, 0, 5, 5 } };
+    planarizar_caso("T", t, 2, t_esperados, 3, 1);
+
+    // sobreposição colinear: cada um é dividido na ponta do outro
+    const double sobre[][4] = { { 0, 0, 10, 0 }, { 15, 0, 5, 0 } };
+    const double sobre_esperados[][5] = { { 1, 0, 0, 5, 0 }, { 1, 5, 0, 10, 0 }, { 2, 15, 0, 10, 0 }, { 2, 10, 0, 5, 0 } };
+    planarizar_caso("sobreposição", sobre, 2, sobre_esperados, 4, 2);
+
+    // só encostando pelas pontas: nada muda
+    const double pontas[][4] = { { 0, 0, 10, 0 }, { 10, 0, 10, 10 } };
+    const double pontas_esperados[][5] = { { 1, 0, 0, 10, 0 }, { 2, 10, 0, 10, 10 } };
+    planarizar_caso("pontas", pontas, 2, pontas_esperados, 2, 0);
+}
+
+// SORTEAR_COORDENADAS
+// segmentos de pontas inteiras: soltos, horizontais e verticais sobre poucas
+// retas (para haver sobreposições colineares) e saindo de pontas de outros
+static void sortear_coordenadas(double (*segs)[4], int n) {
+    for (int i = 0; i < n; i++) {
+        double x = (int) sortear(0, LADO), y = (int) sortear(0, LADO);
+        double tam = (int) sortear(10, 120);
+
+        switch (i % 5) {
+            case 0: // horizontal numa das retas y = 100, 200, 300
+                y = 100 * (1 + i % 3);
+                segs[i][0] = x; segs[i][1] = y; segs[i][2] = x + tam; segs[i][3] = y;
+                break;
+            case 1: // vertical numa das retas x = 100, 200, 300
+                x = 100 * (1 + i % 3);
+                segs[i][0] = x; segs[i][1] = y; segs[i][2] = x; segs[i][3] = y + tam;
+                break;
+            case 2: // saindo da ponta de um anterior
+                if (i > 0) {
+                    int j = (int) sortear(0, i - 1);
+                    x = segs[j][2];
+                    y = segs[j][3];
+                }
+                segs[i][0] = x; segs[i][1] = y; segs[i][2] = x + (int) sortear(-80, 80); segs[i][3] = y + (int) sortear(-80, 80);
+                break;
+            default: // solto
+                segs[i][0] = x; segs[i][1] = y; segs[i][2] = x + (int) sortear(-120, 120); segs[i][3] = y + (int) sortear(-120, 120);
+                break;
+        }
+
+        // sem segmentos de um ponto só
+        if (segs[i][0] == segs[i][2] && segs[i][1] == segs[i][3]) segs[i][2] += 1;
+    }
+}
+
+// PLANARIZAR_EM_LOTES
+// planariza os segmentos na ordem dada, em lotes de tamanho fixo (0 sorteia o
+// tamanho de cada lote), conferindo a grade e a BVH depois de cada um
+static Lista* planarizar_em_lotes(const double (*segs)[4], int n, int tamanho_lote, const char* nome) {
+    Lista* anteparos = criar_lista();
+    Lista* novos = criar_lista();
+    Lista* consulta = criar_lista();
+    Grade* grade = criar_grade(40.0);
+    Bvh* bvh = criar_bvh();
+    if (anteparos == NULL || novos == NULL || consulta == NULL || grade == NULL || bvh == NULL) {
+        fprintf(stderr, "erro ao alocar a planarização\n");
+        exit(1);
+    }
+
+    int i = 0;
+    while (i < n) {
+        int lote = tamanho_lote > 0 ? tamanho_lote : 1 + (int) sortear(0, 40);
+        for (int k = 0; k < lote && i < n; k++, i++) {
+            inserir_fim_lista(novos, novo_segmento(i + 1, segs[i][0], segs[i][1], segs[i][2], segs[i][3]));
+        }
+
+        if (planarizar_anteparos(anteparos, novos, grade, bvh) < 0) falhar("lotes", nome);
+
+        int total = lista_tamanho(anteparos);
+        if (bvh_tamanho(bvh) != total) falhar("BVH em dia", nome);
+        if (grade_consultar(grade, -1e9, -1e9, 1e9, 1e9, consulta) != total) falhar("grade em dia", nome);
+        while (!lista_vazia(consulta)) remover_inicio_lista(consulta);
+    }
+
+    destruir_lista(novos);
+    destruir_lista(consulta);
+    destruir_grade(grade);
+    destruir_bvh(bvh);
+    return anteparos;
+}
+
+// MESMA_LISTA
+static bool mesma_lista(Lista* l1, Lista* l2) {
+    if (lista_tamanho(l1) != lista_tamanho(l2)) return false;
+
+    Elemento* e1 = get_primeiro_elemento(l1);
+    Elemento* e2 = get_primeiro_elemento(l2);
+    while (e1 != NULL) {
+        Segmento* s1 = (Segmento*) get_elemento(l1, e1);
+        Segmento* s2 = (Segmento*) get_elemento(l2, e2);
+        Ponto* a1 = segmento_get_inicio(s1);
+        Ponto* b1 = segmento_get_fim(s1);
+        Ponto* a2 = segmento_get_inicio(s2);
+        Ponto* b2 = segmento_get_fim(s2);
+
+        if (segmento_get_id(s1) != segmento_get_id(s2) || get_x(a1) != get_x(a2) || get_y(a1) != get_y(a2) ||
+            get_x(b1) != get_x(b2) || get_y(b1) != get_y(b2)) return false;
+
+        e1 = get_proximo_elemento(e1);
+        e2 = get_proximo_elemento(e2);
+    }
+
+    return true;
+}
+
+// PONTA_DENTRO
+// p é uma ponta de entrada (coordenadas inteiras) sobre o interior de a-b. os
+// pontos de cruzamento ficam de fora: cada par é arredondado à parte, então três
+// anteparos quase concorrentes podem deixar lascas de poucos ulps entre si
+static bool ponta_dentro(Ponto* p, Ponto* a, Ponto* b) {
+    if (get_x(p) != (int) get_x(p) || get_y(p) != (int) get_y(p)) return false;
+    if (orientacao(a, b, p) != 0) return false;
+    if ((get_x(p) == get_x(a) && get_y(p) == get_y(a)) || (get_x(p) == get_x(b) && get_y(p) == get_y(b))) return false;
+
+    double min_x = get_x(a) < get_x(b) ? get_x(a) : get_x(b), max_x = get_x(a) < get_x(b) ? get_x(b) : get_x(a);
+    double min_y = get_y(a) < get_y(b) ? get_y(a) : get_y(b), max_y = get_y(a) < get_y(b) ? get_y(b) : get_y(a);
+    return get_x(p) >= min_x && get_x(p) <= max_x && get_y(p) >= min_y && get_y(p) <= max_y;
+}
+
+// CONFERIR_PLANAR
+// dois pedaços de anteparos diferentes não se cruzam, e nenhuma ponta de entrada
+// fica no meio de um pedaço
+static void conferir_planar(Lista* anteparos) {
+    int n = lista_tamanho(anteparos);
+    Segmento** v = (Segmento**) malloc(n * sizeof(Segmento*));
+    if (v == NULL) {
+        fprintf(stderr, "erro ao alocar os pedaços\n");
+        exit(1);
+    }
+
+    int k = 0;
+    Elemento* elem = get_primeiro_elemento(anteparos);
+    while (elem != NULL) {
+        v[k++] = (Segmento*) get_elemento(anteparos, elem);
+        elem = get_proximo_elemento(elem);
+    }
+
+    for (int i = 0; i < n; i++) {
+        for (int j = i + 1; j < n; j++) {
+            if (segmento_get_id(v[i]) == segmento_get_id(v[j])) continue;
+
+            Ponto* a1 = segmento_get_inicio(v[i]);
+            Ponto* a2 = segmento_get_fim(v[i]);
+            Ponto* b1 = segmento_get_inicio(v[j]);
+            Ponto* b2 = segmento_get_fim(v[j]);
+
+            double d1 = orientacao(b1, b2, a1), d2 = orientacao(b1, b2, a2);
+            double d3 = orientacao(a1, a2, b1), d4 = orientacao(a1, a2, b2);
+            bool cruzam = d1 * d2 < 0 && d3 * d4 < 0;
+            bool tocam = ponta_dentro(a1, b1, b2) || ponta_dentro(a2, b1, b2) || ponta_dentro(b1, a1, a2) || ponta_dentro(b2, a1, a2);
+
+            if (cruzam || tocam) {
+                char detalhe[96];
+                snprintf(detalhe, sizeof(detalhe), "anteparos %d e %d %s", segmento_get_id(v[i]), segmento_get_id(v[j]), cruzam ? "se cruzam" : "se tocam no meio");
+                falhar("sem cruzamentos", detalhe);
+            }
+        }
+    }
+
+    free(v);
+}
+
+// TESTE_LOTES
+// o resultado não pode depender de como os segmentos foram agrupados
+static void teste_lotes(void) {
+    double (*segs)[4] = malloc(N_SEGMENTOS * sizeof(*segs));
+    if (segs == NULL) {
+        fprintf(stderr, "erro ao alocar os segmentos\n");
+        exit(1);
+    }
+    sortear_coordenadas(segs, N_SEGMENTOS);
+
+    Lista* inteiro = planarizar_em_lotes((const double (*)[4]) segs, N_SEGMENTOS, N_SEGMENTOS, "lote único");
+    if (lista_tamanho(inteiro) <= N_SEGMENTOS) falhar("lotes", "nenhum anteparo foi dividido");
+    conferir_planar(inteiro);
+
+    const int tamanhos[] = { 1, 2, 7, 64, 0, 0 };
+    for (int i = 0; i < (int) (sizeof(tamanhos) / sizeof(tamanhos[0])); i++) {
+        char nome[32];
+        snprintf(nome, sizeof(nome), "lotes de %d", tamanhos[i]);
+
+        Lista* lotes = planarizar_em_lotes((const double (*)[4]) segs, N_SEGMENTOS, tamanhos[i], nome);
+        if (!mesma_lista(inteiro, lotes)) falhar("mesmo resultado", nome);
+        destruir_anteparos(lotes);
+    }
+
+    destruir_anteparos(inteiro);
+    free(segs);
+}
+
+// MAIN
+int main(void) {
+    teste_casos();
+    teste_lotes();
+
+    if (falhas > 0) {
+        printf("%d falha(s)\n", falhas);
+        return 1;
+    }
+
+    printf("teste_planarizacao: ok\n");
+    return 0;
+}
@@ -0,0 +1,249 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "../src/poligono.h"
+#include "../src/geometria.h"
+
+// ===============================================
+// TESTE DOS ACERTOS DO POLÍGONO
+// ----------------------------------------------
+// polígonos com 64 vértices ou mais respondem
+// poligono_intersecta_segmento pela grade de
+// arestas; os menores, percorrendo todas. as
+// duas respostas têm que ser iguais, inclusive
+// para segmentos nas bordas das células, sobre
+// arestas horizontais e verticais e em vértices.
+// ===============================================
+
+#define N_POLIGONOS 40
+#define N_CONSULTAS 2000
+
+static unsigned int semente = 777u;
+static int falhas = 0;
+
+// SORTEAR
+static double sortear(double min, double max) {
+    semente = semente * 1103515245u + 12345u;
+    return min + (max - min) * ((semente >> 8) & 0xFFFF) / 65535.0;
+}
+
+// SORTEAR_INTEIRO
+static int sortear_inteiro(int min, int max) {
+    return min + (int) floor(sortear(0.0, 0.999999) * (max - min + 1));
+}
+
+// FALHAR
+static void falhar(const char* teste, int poligono, Ponto a, Ponto b) {
+    if (falhas < 10) fprintf(stderr, "FALHOU %s: polígono %d, segmento (%.17g, %.17g) - (%.17g, %.17g)\n", teste, poligono, a.x, a.y, b.x, b.y);
+    falhas++;
+}
+
+// CRIAR_DENTES
+// contorno retilíneo em pente: dentes de largura e altura sorteadas sobre uma
+// base, só com arestas horizontais e verticais e coordenadas inteiras
+static Poligono* criar_dentes(int n_dentes) {
+    Poligono* p = criar_poligono(4 * n_dentes + 4);
+    if (p == NULL) return NULL;
+
+    int x = 0;
+    poligono_adicionar(p, 0, 0);
+    for (int i = 0; i < n_dentes; i++) {
+        int largura = sortear_inteiro(2, 20), altura = sortear_inteiro(10, 200);
+        poligono_adicionar(p, x, altura);
+        poligono_adicionar(p, x + largura, altura);
+        x += largura;
+        poligono_adicionar(p, x, sortear_inteiro(1, 9));
+        x += sortear_inteiro(1, 10);
+        poligono_adicionar(p, x, sortear_inteiro(1, 9));
+    }
+    poligono_adicionar(p, x, 0);
+
+    return p;
+}
+
+// CRIAR_ESTRELA
+// vértices em volta de um centro, em ângulos crescentes e raios sorteados
+// (com coordenadas inteiras, vários vértices caem alinhados)
+static Poligono* criar_estrela(int n) {
+    Poligono* p = criar_poligono(n);
+    if (p == NULL) return NULL;
+
+    for (int i = 0; i < n; i++) {
+        double ang = 2.0 * 3.14159265358979323846 * i / n;
+        double raio = sortear(50.0, 500.0);
+        poligono_adicionar(p, floor(500.0 + raio * cos(ang)), floor(500.0 + raio * sin(ang)));
+    }
+
+    return p;
+}
+
+// SUBDIVIDIR
+// o mesmo contorno com um vértice no meio de cada aresta (as coordenadas são
+// inteiras, então o meio é exato): passa dos 64 vértices sem mudar a forma
+static Poligono* subdividir(Poligono* p) {
+    int n = poligono_tamanho(p);
+    Poligono* q = criar_poligono(2 * n);
+    if (q == NULL) return NULL;
+
+    for (int i = 0; i < n; i++) {
+        Ponto v1 = poligono_vertice(p, i), v2 = poligono_vertice(p, (i + 1) % n);
+        poligono_adicionar(q, v1.x, v1.y);
+        poligono_adicionar(q, 0.5 * (v1.x + v2.x), 0.5 * (v1.y + v2.y));
+    }
+
+    return q;
+}
+
+// INTERSECTA_LINEAR
+// a resposta de referência: todas as arestas e o raio da ponta a
+static bool intersecta_linear(Poligono* p, Ponto a, Ponto b) {
+    int n = poligono_tamanho(p);
+    for (int i = 0; i < n; i++) {
+        Ponto v1 = poligono_vertice(p, i), v2 = poligono_vertice(p, (i + 1) % n);
+        if (segmentos_intersectam(&a, &b, &v1, &v2)) return true;
+    }
+
+    return poligono_contem_ponto(p, a);
+}
+
+// SORTEAR_CONSULTA
+// mistura segmentos soltos, segmentos e pontos nas bordas das células da grade
+// (a mesma conta que a monta), retas sobre as arestas e pontas nos vértices
+static void sortear_consulta(Poligono* p, int k, Ponto* a, Ponto* b) {
+    double caixa[4];
+    poligono_caixa(p, caixa);
+    int n = poligono_tamanho(p);
+    double w = caixa[2] - caixa[0], h = caixa[3] - caixa[1];
+    double lado = sqrt(w * h / n);
+    int nx = (int) fmin(w / lado, n) + 1, ny = (int) fmin(h / lado, n) + 1;
+
+    double x = sortear(caixa[0] - 20.0, caixa[2] + 20.0), y = sortear(caixa[1] - 20.0, caixa[3] + 20.0);
+    Ponto v = poligono_vertice(p, sortear_inteiro(0, n - 1));
+    Ponto u = poligono_vertice(p, sortear_inteiro(0, n - 1));
+    double borda_x = caixa[0] + sortear_inteiro(0, nx) * (w / nx);
+    double borda_y = caixa[1] + sortear_inteiro(0, ny) * (h / ny);
+
+    switch (k % 8) {
+        case 0: // solto
+            *a = ponto_xy(x, y);
+            *b = ponto_xy(x + sortear(-150.0, 150.0), y + sortear(-150.0, 150.0));
+            break;
+        case 1: // vertical na borda de uma coluna
+            *a = ponto_xy(borda_x, y);
+            *b = ponto_xy(borda_x, y + sortear(-100.0, 100.0));
+            break;
+        case 2: // horizontal na borda de uma linha
+            *a = ponto_xy(x, borda_y);
+            *b = ponto_xy(x + sortear(-100.0, 100.0), borda_y);
+            break;
+        case 3: // ponto num canto de célula
+            *a = *b = ponto_xy(borda_x, borda_y);
+            break;
+        case 4: // horizontal ou vertical passando por um vértice (e sobre as arestas retas dele)
+            if (k % 16 == 4) {
+                *a = ponto_xy(x, v.y);
+                *b = ponto_xy(v.x + sortear(-80.0, 80.0), v.y);
+            } else {
+                *a = ponto_xy(v.x, y);
+                *b = ponto_xy(v.x, v.y + sortear(-80.0, 80.0));
+            }
+            break;
+        case 5: // ponto num vértice
+            *a = *b = v;
+            break;
+        case 6: // de um vértice a outro
+            *a = v;
+            *b = u;
+            break;
+        default: // ponto solto, pelo raio da grade
+            *a = *b = ponto_xy(x, y);
+            break;
+    }
+}
+
+// TESTE_GRADE_CONTRA_LINEAR
+// o polígono grande responde pela grade e a referência percorre as arestas
+static void teste_grade_contra_linear(void) {
+    for (int m = 0; m < N_POLIGONOS; m++) {
+        Poligono* p = (m % 2 == 0) ? criar_dentes(sortear_inteiro(16, 120)) : criar_estrela(sortear_inteiro(64, 400));
+        if (p == NULL || poligono_tamanho(p) < 64) {
+            fprintf(stderr, "FALHOU criar o polígono %d\n", m);
+            falhas++;
+            destruir_poligono(p);
+            continue;
+        }
+
+        for (int k = 0; k < N_CONSULTAS; k++) {
+            Ponto a, b;
+            sortear_consulta(p, k, &a, &b);
+
+            if (poligono_intersecta_segmento(p, a, b) != intersecta_linear(p, a, b)) falhar("grade x arestas", m, a, b);
+            if (poligono_intersecta_segmento(p, b, a) != intersecta_linear(p, b, a)) falhar("grade x arestas (invertido)", m, b, a);
+        }
+
+        destruir_poligono(p);
+    }
+}
+
+// TESTE_SUBDIVIDIDO
+// um polígono pequeno (sem grade) e o mesmo contorno subdividido (com grade)
+// têm que acertar os mesmos segmentos
+static void teste_subdividido(void) {
+    for (int m = 0; m < N_POLIGONOS; m++) {
+        Poligono* p = (m % 2 == 0) ? criar_dentes(sortear_inteiro(9, 15)) : criar_estrela(sortear_inteiro(33, 63));
+        Poligono* q = p ? subdividir(p) : NULL;
+        if (q == NULL || poligono_tamanho(p) >= 64 || poligono_tamanho(q) < 64) {
+            fprintf(stderr, "FALHOU criar o par de polígonos %d\n", m);
+            falhas++;
+            destruir_poligono(p);
+            destruir_poligono(q);
+            continue;
+        }
+
+        for (int k = 0; k < N_CONSULTAS; k++) {
+            Ponto a, b;
+            sortear_consulta(q, k, &a, &b);
+
+            if (poligono_intersecta_segmento(p, a, b) != poligono_intersecta_segmento(q, a, b)) falhar("sem grade x subdividido", m, a, b);
+        }
+
+        destruir_poligono(p);
+        destruir_poligono(q);
+    }
+}
+
+// TESTE_ALTERADO
+// acrescentar um vértice descarta a grade: a consulta seguinte vê o contorno novo
+static void teste_alterado(void) {
+    Poligono* p = criar_estrela(100);
+    if (p == NULL) {
+        falhas++;
+        return;
+    }
+
+    Ponto a = ponto_xy(2000.0, 2000.0), b = ponto_xy(2000.0, 2001.0);
+    if (poligono_intersecta_segmento(p, a, b)) falhar("antes de alterar", 0, a, b);
+
+    poligono_adicionar(p, 2100.0, 2000.5);
+    poligono_adicionar(p, 1900.0, 2000.5);
+    if (!poligono_intersecta_segmento(p, a, b)) falhar("depois de alterar", 0, a, b);
+
+    destruir_poligono(p);
+}
+
+// MAIN
+int main(void) {
+    teste_grade_contra_linear();
+    teste_subdividido();
+    teste_alterado();
+
+    if (falhas > 0) {
+        printf("%d falha(s)\n", falhas);
+        return 1;
+    }
+
+    printf("teste_poligono: ok\n");
+    return 0;
+}
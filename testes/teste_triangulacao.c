@@ -0,0 +1,231 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "../src/triangulacao.h"
+#include "../src/visibilidade.h"
+#include "../src/poligono.h"
+#include "../src/segmento.h"
+#include "../src/geometria.h"
+#include "../src/lista.h"
+
+// ===============================================
+// TESTE DIFERENCIAL DA TRIANGULAÇÃO
+// ----------------------------------------------
+// a triangulação tem que dar o mesmo polígono que
+// a varredura (calcular_visibilidade): os mesmos
+// vértices e a mesma resposta para pontos e
+// linhas sobre os anteparos, que são os casos em
+// que um arredondamento diferente troca o lado.
+// ===============================================
+
+#define CELULAS 6
+#define TAM_CELULA 100.0
+#define ORIGENS 300
+#define TOLERANCIA 1e-9
+
+static unsigned int semente = 12345u;
+static int falhas = 0;
+
+// SORTEAR
+static double sortear(double min, double max) {
+    semente = semente * 1103515245u + 12345u;
+    return min + (max - min) * ((semente >> 8) & 0xFFFF) / 65535.0;
+}
+
+// SORTEAR_INTEIRO
+static int sortear_inteiro(int min, int max) {
+    return min + (int) floor(sortear(0.0, 0.999999) * (max - min + 1));
+}
+
+// ADICIONAR_ANTEPARO
+static void adicionar_anteparo(Lista* anteparos, double x1, double y1, double x2, double y2) {
+    Segmento* s = criar_segmento(lista_tamanho(anteparos) + 1, criar_ponto(x1, y1), criar_ponto(x2, y2), NULL);
+    if (s == NULL) {
+        fprintf(stderr, "erro ao criar o anteparo\n");
+        exit(1);
+    }
+    inserir_fim_lista(anteparos, s);
+}
+
+// MONTAR_MAPA
+// cada célula recebe um retângulo, um "V" com a ponta compartilhada ou uma
+// diagonal, sempre em coordenadas inteiras e sem encostar nas vizinhas
+static Lista* montar_mapa(void) {
+    Lista* anteparos = criar_lista();
+    
+    for (int i = 0; i < CELULAS; i++) {
+        for (int j = 0; j < CELULAS; j++) {
+            double x0 = i * TAM_CELULA + 10, y0 = j * TAM_CELULA + 10;
+            int tipo = sortear_inteiro(0, 3);
+            
+            if (tipo <= 1) {
+                double x1 = x0 + sortear_inteiro(0, 30), y1 = y0 + sortear_inteiro(0, 30);
+                double x2 = x1 + sortear_inteiro(10, 50), y2 = y1 + sortear_inteiro(10, 50);
+                adicionar_anteparo(anteparos, x1, y1, x2, y1);
+                adicionar_anteparo(anteparos, x2, y1, x2, y2);
+                adicionar_anteparo(anteparos, x2, y2, x1, y2);
+                adicionar_anteparo(anteparos, x1, y2, x1, y1);
+            }
+            else if (tipo == 2) {
+                double px = x0 + sortear_inteiro(20, 60), py = y0 + sortear_inteiro(20, 60);
+                adicionar_anteparo(anteparos, x0, y0 + sortear_inteiro(0, 80), px, py);
+                adicionar_anteparo(anteparos, px, py, x0 + 80, y0 + sortear_inteiro(0, 80));
+            }
+            else {
+                adicionar_anteparo(anteparos, x0 + sortear_inteiro(0, 40), y0 + sortear_inteiro(0, 40),
+                                   x0 + sortear_inteiro(40, 80), y0 + sortear_inteiro(40, 80));
+            }
+        }
+    }
+    
+    return anteparos;
+}
+
+// DESTRUIR_MAPA
+static void destruir_mapa(Lista* anteparos) {
+    while (!lista_vazia(anteparos)) {
+        Segmento* s = (Segmento*) remover_inicio_lista(anteparos);
+        destruir_ponto(segmento_get_inicio(s));
+        destruir_ponto(segmento_get_fim(s));
+        destruir_segmento(s);
+    }
+    destruir_lista(anteparos);
+}
+
+// FALHAR
+static void falhar(const char* teste, Ponto origem, const char* detalhe) {
+    if (falhas < 10) fprintf(stderr, "FALHOU %s: origem (%.17g, %.17g) %s\n", teste, origem.x, origem.y, detalhe);
+    falhas++;
+}
+
+// MESMOS_VERTICES
+// os contornos podem começar em vértices diferentes quando um vértice cai bem
+// na direção (1, 0): a comparação é a menos de uma rotação
+static bool mesmos_vertices(Poligono* a, Poligono* b) {
+    int n = poligono_tamanho(a);
+    if (n != poligono_tamanho(b)) return false;
+    if (n == 0) return true;
+    
+    for (int d = 0; d < n; d++) {
+        bool iguais = true;
+        for (int i = 0; iguais && i < n; i++) {
+            Ponto p = poligono_vertice(a, i), q = poligono_vertice(b, (i + d) % n);
+            iguais = fabs(p.x - q.x) <= TOLERANCIA && fabs(p.y - q.y) <= TOLERANCIA;
+        }
+        if (iguais) return true;
+    }
+    
+    return false;
+}
+
+// COMPARAR_SOBRE_ANTEPAROS
+// pontas, meio e quartos de cada anteparo, e trechos dele, nos dois polígonos
+static void comparar_sobre_anteparos(Lista* anteparos, Poligono* pt, Poligono* pv, Ponto origem) {
+    Elemento* elem = get_primeiro_elemento(anteparos);
+    
+    while (elem != NULL) {
+        Segmento* s = (Segmento*) get_elemento(anteparos, elem);
+        Ponto a = *segmento_get_inicio(s), b = *segmento_get_fim(s);
+        
+        for (int k = 0; k <= 4; k++) {
+            Ponto p = ponto_xy(a.x + (b.x - a.x) * k / 4.0, a.y + (b.y - a.y) * k / 4.0);
+            if (poligono_contem_ponto(pt, p) != poligono_contem_ponto(pv, p)) falhar("ponto sobre anteparo", origem, "");
+        }
+        
+        Ponto m = ponto_xy(0.5 * (a.x + b.x), 0.5 * (a.y + b.y));
+        if (poligono_intersecta_segmento(pt, a, b) != poligono_intersecta_segmento(pv, a, b)) falhar("anteparo inteiro", origem, "");
+        if (poligono_intersecta_segmento(pt, a, m) != poligono_intersecta_segmento(pv, a, m)) falhar("meio anteparo", origem, "");
+        
+        elem = get_proximo_elemento(elem);
+    }
+}
+
+// COMPARAR_ORIGEM
+static bool comparar_origem(Triangulacao* t, Lista* anteparos, Ponto origem) {
+    Poligono* pt = triangulacao_visibilidade(t, &origem);
+    if (pt == NULL) return false; // a própria triangulação manda usar a varredura
+    
+    Poligono* pv = calcular_visibilidade(&origem, anteparos, 'q', 10);
+    if (pv == NULL) {
+        falhar("varredura", origem, "sem polígono");
+        destruir_poligono(pt);
+        return false;
+    }
+    
+    // a varredura entrega o polígono simplificado
+    poligono_simplificar(pt, TOLERANCIA);
+    
+    if (!mesmos_vertices(pt, pv)) {
+        char detalhe[64];
+        snprintf(detalhe, sizeof(detalhe), "%d vértices x %d", poligono_tamanho(pt), poligono_tamanho(pv));
+        falhar("vértices", origem, detalhe);
+    }
+    
+    comparar_sobre_anteparos(anteparos, pt, pv, origem);
+    
+    for (int k = 0; k < 200; k++) {
+        Ponto p = ponto_xy(sortear(0.0, CELULAS * TAM_CELULA), sortear(0.0, CELULAS * TAM_CELULA));
+        if (poligono_contem_ponto(pt, p) != poligono_contem_ponto(pv, p)) falhar("ponto solto", origem, "");
+    }
+    
+    destruir_poligono(pt);
+    destruir_poligono(pv);
+    return true;
+}
+
+// TESTE_MAPAS
+// origens soltas e origens na altura ou na coluna de um vértice, que alinham
+// a origem com lados de retângulos
+static void teste_mapas(int n_mapas) {
+    int comparadas = 0;
+    
+    for (int m = 0; m < n_mapas; m++) {
+        Lista* anteparos = montar_mapa();
+        Triangulacao* t = criar_triangulacao(anteparos);
+        if (t == NULL) {
+            fprintf(stderr, "FALHOU criar_triangulacao no mapa %d\n", m);
+            falhas++;
+            destruir_mapa(anteparos);
+            continue;
+        }
+        
+        for (int k = 0; k < ORIGENS; k++) {
+            Ponto origem;
+            if (k % 3 == 0) {
+                origem = ponto_xy(floor(sortear(0.0, CELULAS * TAM_CELULA) * 10.0) / 10.0, floor(sortear(0.0, CELULAS * TAM_CELULA) * 10.0) / 10.0);
+            }
+            else {
+                // a altura (ou a coluna) de uma ponta de anteparo qualquer
+                int alvo = sortear_inteiro(0, lista_tamanho(anteparos) - 1);
+                Elemento* elem = get_primeiro_elemento(anteparos);
+                while (alvo-- > 0) elem = get_proximo_elemento(elem);
+                Ponto p = *segmento_get_inicio((Segmento*) get_elemento(anteparos, elem));
+                
+                double livre = sortear_inteiro(0, CELULAS * 100) + 0.5;
+                origem = (k % 3 == 1) ? ponto_xy(livre * TAM_CELULA / 100.0, p.y) : ponto_xy(p.x, livre * TAM_CELULA / 100.0);
+            }
+            
+            if (comparar_origem(t, anteparos, origem)) comparadas++;
+        }
+        
+        destruir_triangulacao(t);
+        destruir_mapa(anteparos);
+    }
+    
+    printf("teste_mapas: %d origens comparadas\n", comparadas);
+}
+
+// MAIN
+int main(void) {
+    teste_mapas(20);
+    
+    if (falhas > 0) {
+        printf("%d falha(s)\n", falhas);
+        return 1;
+    }
+    
+    printf("teste_triangulacao: ok\n");
+    return 0;
+}